@@ -0,0 +1,150 @@
+/*
+    BezierSampler.cpp
+    Arc length sampling of a cubic bezier segment
+ 
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "BezierSampler.h"
+
+//==============================================================================
+BezierSampler::BezierSampler()
+: length (0.0f), chord (0), chordStart (0.0f)
+{
+}
+
+void BezierSampler::setSegment (Point<float> start, Point<float> exit, Point<float> entry, Point<float> end)
+{
+    path.clear();
+    path.startNewSubPath (start);
+    path.cubicTo (exit, entry, end);
+    
+    // Arrays keep their storage, so reusing a sampler doesn't allocate
+    chords.clearQuick();
+    chordLengths.clearQuick();
+    chordStarts.clearQuick();
+    curvatures.clearQuick();
+    length = 0.0f;
+    
+    PathFlatteningIterator i (path, AffineTransform(), Path::defaultToleranceForMeasurement);
+    while (i.next())
+    {
+        Line<float> line (i.x1, i.y1, i.x2, i.y2);
+        float l = line.getLength();
+        chords.add (line);
+        chordLengths.add (l);
+        chordStarts.add (length);
+        length += l;
+    }
+    
+    // Turn between neighbouring chords over the length around the joint
+    for (auto n = 0; n < chords.size() - 1; ++n)
+    {
+        float l = chordLengths[n] + chordLengths[n + 1];
+        float turn = std::abs (chords.getReference (n).getAngle() - chords.getReference (n + 1).getAngle());
+        if (turn > MathConstants<float>::pi)
+            turn = MathConstants<float>::twoPi - turn;
+        
+        curvatures.add (l > 0.0f ? 2.0f * turn / l : 0.0f);
+    }
+    
+    chord = 0;
+    chordStart = 0.0f;
+}
+
+Point<float> BezierSampler::getPointAlongSegment (float distance)
+{
+    while (chord < chords.size())
+    {
+        float along = distance - chordStart;
+        float l = chordLengths.getUnchecked (chord);
+        
+        if (along <= l)
+            return chords.getReference (chord).getPointAlongLine (along);
+        
+        chordStart += l;
+        ++chord;
+    }
+    
+    return chords.size() ? chords.getLast().getEnd() : Point<float>();
+}
+
+void BezierSampler::getAdaptiveDistances (float tolerance, float minSpacing, float maxSpacing,
+                                          Array<float>& distances) const
+{
+    distances.clearQuick();
+    
+    float d = 0.0f;
+    float spacing = maxSpacing;
+    int joint = 0;
+    
+    for (;;)
+    {
+        // A chord of s across a curvature of k is off by about k * s * s / 8,
+        // so the tightest turn within reach decides how far the next point goes
+        spacing = maxSpacing;
+        for (auto n = joint; n < curvatures.size() && chordStarts[n + 1] <= d + spacing; ++n)
+        {
+            float k = curvatures.getUnchecked (n);
+            if (k > 0.0f)
+                spacing = jmin (spacing, jmax (minSpacing, std::sqrt (8.0f * tolerance / k)));
+        }
+        
+        if (d + spacing >= length)
+            break;
+        
+        d += spacing;
+        distances.add (d);
+        
+        while (joint < curvatures.size() && chordStarts[joint + 1] <= d)
+            ++joint;
+    }
+    
+    // Share the last two gaps out rather than leave a sliver at the end
+    int last = distances.size() - 1;
+    if (last >= 0)
+    {
+        float before = last ? distances[last - 1] : 0.0f;
+        if (length - d < (d - before) / 2.0f)
+            distances.set (last, (before + length) / 2.0f);
+    }
+}
+
+Point<float> BezierSampler::getStartDirection (Point<float> start, Point<float> exit, Point<float> entry, Point<float> end)
+{
+    // A control point sat on the start doesn't say anything, try the next one
+    for (auto p : { exit, entry, end })
+    {
+        Point<float> d = p - start;
+        float l = d.getDistanceFromOrigin();
+        if (l > 0.0f)
+            return d / l;
+    }
+    
+    return {};
+}
+
+Point<float> BezierSampler::getEndDirection (Point<float> start, Point<float> exit, Point<float> entry, Point<float> end)
+{
+    for (auto p : { entry, exit, start })
+    {
+        Point<float> d = end - p;
+        float l = d.getDistanceFromOrigin();
+        if (l > 0.0f)
+            return d / l;
+    }
+    
+    return {};
+}
@@ -0,0 +1,63 @@
+/*
+    BezierSampler.h
+    Arc length sampling of a cubic bezier segment
+ 
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Flattens the segment once (same tolerance and chords as juce::Path uses
+// for getLength and getPointAlongPath) and keeps the chord lengths, so points
+// can then be pulled out in order without walking the curve again.
+class BezierSampler
+{
+public:
+    BezierSampler();
+    
+    void setSegment (Point<float> start, Point<float> exit, Point<float> entry, Point<float> end);
+    
+    float getLength() const { return length; }
+    
+    // Distances have to be increasing between calls, anything past the
+    // end gives the end point
+    Point<float> getPointAlongSegment (float distance);
+    
+    // Distances along the segment to put points at so the straight lines
+    // between them stay within tolerance of the curve. Gaps are kept
+    // between minSpacing and maxSpacing, except the one to the end.
+    void getAdaptiveDistances (float tolerance, float minSpacing, float maxSpacing,
+                               Array<float>& distances) const;
+    
+    // Unit direction a segment leaves its start and arrives at its end,
+    // from the control points so no flattening needed. Zero if it's all
+    // one point.
+    static Point<float> getStartDirection (Point<float> start, Point<float> exit, Point<float> entry, Point<float> end);
+    static Point<float> getEndDirection (Point<float> start, Point<float> exit, Point<float> entry, Point<float> end);
+    
+private:
+    Path path;
+    Array<Line<float>> chords;
+    Array<float> chordLengths;
+    // Where each chord starts along the segment, and how sharply the
+    // segment turns where it ends
+    Array<float> chordStarts;
+    Array<float> curvatures;
+    float length;
+    int chord;
+    float chordStart;
+};
@@ -0,0 +1,98 @@
+/*
+    BlankMove.cpp
+    S-curve profile for blanked moves between paths
+ 
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "BlankMove.h"
+
+//==============================================================================
+BlankMove::BlankMove (float v, float a)
+: maxVelocity (jmax (1.0f, v)), acceleration (jmax (1.0f, a))
+{
+}
+
+void BlankMove::getProfile (float distance, float& velocity, float& rampTime, float& totalTime) const
+{
+    // Sine shaped acceleration peaking at acceleration averages 2/pi of it
+    velocity = maxVelocity;
+    rampTime = MathConstants<float>::halfPi * velocity / acceleration;
+    float rampDistance = velocity * rampTime / 2.0f;
+    
+    if (rampDistance * 2.0f > distance)
+    {
+        // Too short to get up to speed, turn round half way
+        velocity = std::sqrt (distance * acceleration / MathConstants<float>::halfPi);
+        rampTime = MathConstants<float>::halfPi * velocity / acceleration;
+        totalTime = rampTime * 2.0f;
+    }
+    else
+        totalTime = rampTime * 2.0f + (distance - rampDistance * 2.0f) / velocity;
+}
+
+float BlankMove::getMoveLength (Point<int> from, int fromZ, Point<int> to, int toZ)
+{
+    return jmax (from.toFloat().getDistanceFrom (to.toFloat()), (float)std::abs (toZ - fromZ));
+}
+
+int BlankMove::getPointCount (float distance) const
+{
+    if (distance <= 0.0f)
+        return 0;
+    
+    float velocity, rampTime, totalTime;
+    getProfile (distance, velocity, rampTime, totalTime);
+    
+    return jmax (0, (int)std::ceil (totalTime) - 1);
+}
+
+void BlankMove::getFractions (float distance, Array<float>& fractions) const
+{
+    fractions.clearQuick();
+    
+    int count = getPointCount (distance);
+    if (! count)
+        return;
+    
+    float velocity, rampTime, totalTime;
+    getProfile (distance, velocity, rampTime, totalTime);
+    
+    // Distance covered t into a ramp from standing
+    auto ramp = [velocity, rampTime] (float t)
+    {
+        return velocity / 2.0f * (t - rampTime / MathConstants<float>::pi
+                                      * std::sin (MathConstants<float>::pi * t / rampTime));
+    };
+    
+    float rampDistance = velocity * rampTime / 2.0f;
+    
+    // Stretched a little to land on whole points
+    float step = totalTime / (float)(count + 1);
+    for (auto n = 1; n <= count; ++n)
+    {
+        float t = step * (float)n;
+        float d;
+        
+        if (t < rampTime)
+            d = ramp (t);
+        else if (t < totalTime - rampTime)
+            d = rampDistance + velocity * (t - rampTime);
+        else
+            d = distance - ramp (totalTime - t);
+        
+        fractions.add (jlimit (0.0f, 1.0f, d / distance));
+    }
+}
@@ -0,0 +1,58 @@
+/*
+    BlankMove.h
+    S-curve profile for blanked moves between paths
+ 
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// One point per scan period. The scanner speeds up with the acceleration
+// following half a sine wave (so it never goes over acceleration), cruises
+// at maxVelocity if the move is long enough and slows down the same way.
+// That leaves points bunched at the ends of a jump where the galvos need
+// them and spread out in the middle where they don't.
+// Velocity is in sketch units per point, acceleration in units per point
+// per point.
+class BlankMove
+{
+public:
+    BlankMove (float maxVelocity = defaultVelocity, float acceleration = defaultAcceleration);
+    
+    float getMaxVelocity() const { return maxVelocity; }
+    float getAcceleration() const { return acceleration; }
+    
+    // Points the move puts out between its two ends (which belong to the
+    // paths either side of it)
+    int getPointCount (float distance) const;
+    
+    // How far along (0 to 1) each of those points is
+    void getFractions (float distance, Array<float>& fractions) const;
+    
+    // Distance the profile runs over, whichever of XY or Z has further to go
+    static float getMoveLength (Point<int> from, int fromZ, Point<int> to, int toZ);
+    
+    // Cruise is the old fixed blank spacing, the ramps take about 3 points
+    static constexpr float defaultVelocity = 1800.0f;
+    static constexpr float defaultAcceleration = 900.0f;
+    
+private:
+    void getProfile (float distance, float& velocity, float& rampTime, float& totalTime) const;
+    
+    float maxVelocity;
+    float acceleration;
+};
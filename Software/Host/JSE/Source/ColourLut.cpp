@@ -0,0 +1,113 @@
+/*
+    ColourLut.cpp
+    Lookup tables for point colour operations
+ 
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ColourLut.h"
+#include "WorkerPool.h"
+
+// Top byte of an entry says it has been filled in and if it's blanked
+static const uint32 entryValid = 0x01000000;
+static const uint32 entryBlanked = 0x02000000;
+
+//==============================================================================
+ColourLut::ColourLut (const std::function<Colour (const Colour&)>& operation)
+: op (operation)
+{
+}
+
+void ColourLut::apply (Array<Frame::IPoint>& points)
+{
+    // Find the distinct colours, this pass is just a few table probes.
+    // Runs of points mostly share a colour, so the last page is kept handy.
+    Array<uint32> distinct;
+    uint32* page = nullptr;
+    int pageKey = -1;
+    for (auto n = 0; n < points.size(); ++n)
+    {
+        const Frame::IPoint& point = points.getReference (n);
+        if (getPageKey (point) != pageKey)
+        {
+            pageKey = getPageKey (point);
+            auto& p = pages[(uint16)pageKey];
+            if (p == nullptr)
+            {
+                p.reset (new uint32[256]);
+                zeromem (p.get(), sizeof (uint32) * 256);
+            }
+            
+            page = p.get();
+        }
+        
+        uint32& entry = page[point.blue];
+        if (! entry)
+        {
+            entry = entryValid;
+            distinct.add (((uint32)point.red << 16) | ((uint32)point.green << 8) | point.blue);
+        }
+    }
+    
+    // Fill in the table entries we need
+    WorkerPool::forChunks (distinct.size(), 256, [&] (int start, int end)
+    {
+        for (auto n = start; n < end; ++n)
+        {
+            uint32 rgb = distinct[n];
+            Colour c = op (Colour ((uint8)(rgb >> 16), (uint8)(rgb >> 8), (uint8)rgb));
+            uint32 out = ((uint32)c.getRed() << 16) | ((uint32)c.getGreen() << 8) | c.getBlue();
+            
+            // Same blanking rule as the per point code had
+            if (c == Colours::black)
+                out |= entryBlanked;
+            
+            pages.find ((uint16)(rgb >> 8))->second[rgb & 0xff] = out | entryValid;
+        }
+    });
+    
+    // And gather, the map isn't changed from here on
+    Frame::IPoint* data = points.getRawDataPointer();
+    WorkerPool::forChunks (points.size(), 4096, [&] (int start, int end)
+    {
+        const uint32* page = nullptr;
+        int pageKey = -1;
+        for (auto n = start; n < end; ++n)
+        {
+            Frame::IPoint& point = data[n];
+            if (getPageKey (point) != pageKey)
+            {
+                pageKey = getPageKey (point);
+                page = pages.find ((uint16)pageKey)->second.get();
+            }
+            
+            uint32 out = page[point.blue];
+            
+            point.red = (uint8)(out >> 16);
+            point.green = (uint8)(out >> 8);
+            point.blue = (uint8)out;
+            point.status = (out & entryBlanked) ? Frame::BlankedPoint : 0;
+        }
+    });
+}
+
+//==============================================================================
+GradientLut::GradientLut (const ColourGradient& gradient, int entries)
+: scale ((float)(entries - 1))
+{
+    ramp.ensureStorageAllocated (entries);
+    for (auto n = 0; n < entries; ++n)
+        ramp.add (gradient.getColourAtPosition ((double)n / (double)(entries - 1)));
+}
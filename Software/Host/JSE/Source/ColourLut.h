@@ -0,0 +1,69 @@
+/*
+    ColourLut.h
+    Lookup tables for point colour operations
+ 
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <unordered_map>
+#include "Frame.h"
+
+// Direct 24 bit RGB -> RGB table. It is split in 256 entry pages (one per
+// red/green pair) kept in a sparse map, only the pages for colours that are
+// actually used ever get allocated. The output is exactly what the operation
+// gives and every point after that is just a lookup.
+class ColourLut
+{
+public:
+    ColourLut (const std::function<Colour (const Colour&)>& operation);
+    
+    // Run the operation once per distinct colour, then recolor the points.
+    // Points that come out black get blanked, the others unblanked.
+    void apply (Array<Frame::IPoint>& points);
+    
+private:
+    static uint16 getPageKey (const Frame::IPoint& point)
+    {
+        return (uint16)((point.red << 8) | point.green);
+    }
+    
+    std::function<Colour (const Colour&)> op;
+    std::unordered_map<uint16, std::unique_ptr<uint32[]>> pages;
+    
+    JUCE_DECLARE_NON_COPYABLE (ColourLut)
+};
+
+// Colours along a ColourGradient sampled once, positions are 0.0 to 1.0
+class GradientLut
+{
+public:
+    GradientLut (const ColourGradient& gradient, int entries = 4096);
+    
+    const Colour& getColourAtPosition (float position) const
+    {
+        // NaN ends up on the last colour, same as ColourGradient
+        if (position != position)
+            return ramp.getReference (ramp.size() - 1);
+        
+        return ramp.getReference (roundToInt (jlimit (0.0f, 1.0f, position) * scale));
+    }
+    
+private:
+    Array<Colour> ramp;
+    float scale;
+};
@@ -24,48 +24,244 @@
 #include <stdlib.h>
 #include <math.h>
 
-static void FitCurve (Point2 *d, int nPts, double error);
+//==============================================================================
+// Buffers for one fit, kept between fits so they only grow
+class CurveFit::Scratch
+{
+public:
+    std::vector<Point2> points;
+    std::vector<double> u;
+    std::vector<double> uPrime;
+    std::vector<Vector2> A;
+};
+
+typedef Point2 *BezierCurve;
 
-static Anchor* startAnchor;
-static Anchor* endAnchor;
+static double FitCurve (Point2 *d, int nPts, Vector2 tHat1, Vector2 tHat2, double error, CurveFit::Scratch& s, BezierCurve bezCurve);
 
-bool CurveFit::fit (Path& path, float start, float end, Anchor& aStart, Anchor& aEnd)
+//==============================================================================
+CurveFit::CurveFit (const Path& path)
+: length (0.0f), scratch (new Scratch())
 {
-    startAnchor = &aStart;
-    endAnchor = &aEnd;
-    
-    Point<float> p = path.getPointAlongPath (start);
-    startAnchor->setX ((int)p.getX());
-    startAnchor->setY ((int)p.getY());
-    p = path.getPointAlongPath (end);
-    endAnchor->setX ((int)p.getX());
-    endAnchor->setY ((int)p.getY());
+    // Same flattening Path::getLength and getPointAlongPath use
+    PathFlatteningIterator i (path, AffineTransform(), Path::defaultToleranceForMeasurement);
     
-    float length = end - start;
-    if (length < 24.0f)
-    {
-        startAnchor->setExitXDelta (0);
-        startAnchor->setExitYDelta (0);
-        endAnchor->setEntryXDelta (0);
-        endAnchor->setEntryYDelta (0);
-    }
-    else
+    while (i.next())
     {
-        Point2 points[9];
-        float offset = length / 8.0f;
+        Point<float> p1 (i.x1, i.y1);
+        Point<float> p2 (i.x2, i.y2);
         
-        for (auto n = 0; n < 9; ++n)
+        // A new sub path starts without a gap in length
+        if (vertices.isEmpty() || vertices.getLast() != p1)
         {
-            p = path.getPointAlongPath (start + ((float)n * offset));
-            points[n].x = p.getX();
-            points[n].y = p.getY();
+            vertices.add (p1);
+            distances.add (length);
         }
         
-        FitCurve (points, 9, 4.0);
+        length += p1.getDistanceFrom (p2);
+        vertices.add (p2);
+        distances.add (length);
+    }
+}
+
+CurveFit::~CurveFit()
+{
+}
+
+Point<float> CurveFit::getPointAlongPath (float distance) const
+{
+    if (vertices.isEmpty())
+        return Point<float>();
+    
+    if (distance <= 0.0f)
+        return vertices.getFirst();
+    
+    if (distance >= length)
+        return vertices.getLast();
+    
+    // First vertex past distance
+    int n = (int)(std::upper_bound (distances.begin(), distances.end(), distance) - distances.begin());
+    
+    float span = distances[n] - distances[n - 1];
+    if (span <= 0.0f)
+        return vertices[n];
+    
+    return vertices[n - 1] + (vertices[n] - vertices[n - 1]) * ((distance - distances[n - 1]) / span);
+}
+
+bool CurveFit::fit (float start, float end, Anchor& aStart, Anchor& aEnd)
+{
+    Point<float> p = getPointAlongPath (start);
+    aStart.setX ((int)p.getX());
+    aStart.setY ((int)p.getY());
+    p = getPointAlongPath (end);
+    aEnd.setX ((int)p.getX());
+    aEnd.setY ((int)p.getY());
+    
+    float stretch = end - start;
+    if (stretch < 24.0f)
+    {
+        aStart.setExitXDelta (0);
+        aStart.setExitYDelta (0);
+        aEnd.setEntryXDelta (0);
+        aEnd.setEntryYDelta (0);
+        return true;
+    }
+    
+    // Enough samples to catch every bend the flattening found
+    int first = (int)(std::upper_bound (distances.begin(), distances.end(), start) - distances.begin());
+    int last = (int)(std::lower_bound (distances.begin(), distances.end(), end) - distances.begin());
+    int count = jlimit (minSamples, maxSamples, last - first + 2);
+    
+    std::vector<Point2>& points = scratch->points;
+    points.resize ((size_t)count);
+    
+    float offset = stretch / (float)(count - 1);
+    for (auto n = 0; n < count; ++n)
+    {
+        p = getPointAlongPath (start + ((float)n * offset));
+        points[(size_t)n].x = p.getX();
+        points[(size_t)n].y = p.getY();
+    }
+    
+    // Squared error, loosens up on long stretches where a unit or two
+    // doesn't show
+    double error = jmax (4.0, square ((double)stretch / 256.0));
+    
+    // End tangents over an eighth of the stretch whatever the sample count,
+    // the first and last couple of samples alone are too twitchy
+    Point<float> p1 = getPointAlongPath (start + stretch / 8.0f) - getPointAlongPath (start);
+    Point<float> p2 = getPointAlongPath (end - stretch / 8.0f) - getPointAlongPath (end);
+    Vector2 tHat1 = { p1.getX(), p1.getY() };
+    Vector2 tHat2 = { p2.getX(), p2.getY() };
+    
+    Point2 bezCurve[4];
+    FitCurve (points.data(), count, tHat1, tHat2, error, *scratch, bezCurve);
+    
+    aStart.setExitPosition ((int)bezCurve[1].x, (int)bezCurve[1].y);
+    aEnd.setEntryPosition ((int)bezCurve[2].x, (int)bezCurve[2].y);
+    return true;
+}
+
+//==============================================================================
+StrokeFit::StrokeFit (float t, float s)
+: tolerance (t), spacing (s), smoothStart (false), scratch (new CurveFit::Scratch())
+{
+}
+
+StrokeFit::~StrokeFit()
+{
+}
+
+bool StrokeFit::addSample (Point<float> p)
+{
+    if (samples.isEmpty())
+    {
+        samples.add (p);
+        open = Anchor (roundToInt (p.getX()), roundToInt (p.getY()));
+        return false;
     }
+    
+    if (p.getDistanceFrom (samples.getLast()) < spacing)
+        return false;
+    
+    Point<float> previous[4] = { bezier[0], bezier[1], bezier[2], bezier[3] };
+    samples.add (p);
+    if (samples.size() <= maxSamples && fitOpen() <= square ((double)tolerance))
+        return false;
+    
+    // Settle the fit from before this sample and start again from its end
+    for (auto n = 0; n < 4; ++n)
+        bezier[n] = previous[n];
+    
+    settle();
+    samples.removeRange (0, samples.size() - 2);
+    
+    // Carry the tangent on through the new anchor unless that's a corner
+    Point<float> in = bezier[3] - bezier[2];
+    if (in.isOrigin())
+        in = bezier[3] - bezier[0];
+    Point<float> out = p - samples.getFirst();
+    
+    float angle = std::abs (std::atan2 (in.getX() * out.getY() - in.getY() * out.getX(),
+                                        in.getX() * out.getX() + in.getY() * out.getY()));
+    smoothStart = ! in.isOrigin() && radiansToDegrees (angle) < cornerAngle;
+    if (smoothStart)
+        startTangent = in;
+    
+    fitOpen();
     return true;
 }
 
+void StrokeFit::finish()
+{
+    if (samples.size() >= 2)
+    {
+        settle();
+        anchors.add (open);
+    }
+    else if (samples.size() == 1 && anchors.isEmpty())
+        anchors.add (open);
+    
+    samples.clear();
+}
+
+void StrokeFit::getOpenSegment (Path& path) const
+{
+    path.clear();
+    if (anchors.size())
+    {
+        int x1, y1, x2, y2;
+        anchors.getLast().getExitPosition (x1, y1);
+        open.getEntryPosition (x2, y2);
+        path.startNewSubPath ((float)anchors.getLast().getX(), (float)anchors.getLast().getY());
+        path.cubicTo ((float)x1, (float)y1, (float)x2, (float)y2, (float)open.getX(), (float)open.getY());
+    }
+    
+    if (samples.size() < 2)
+        return;
+    
+    if (path.isEmpty())
+        path.startNewSubPath (bezier[0]);
+    path.cubicTo (bezier[1], bezier[2], bezier[3]);
+}
+
+double StrokeFit::fitOpen()
+{
+    int count = samples.size();
+    std::vector<Point2>& points = scratch->points;
+    points.resize ((size_t)count);
+    for (auto n = 0; n < count; ++n)
+    {
+        points[(size_t)n].x = samples.getReference (n).getX();
+        points[(size_t)n].y = samples.getReference (n).getY();
+    }
+    
+    // A few samples in, the last couple are too twitchy on their own
+    int reach = jmin (count - 1, 3);
+    Point<float> t1 = smoothStart ? startTangent : samples[reach] - samples.getFirst();
+    Point<float> t2 = samples[count - 1 - reach] - samples.getLast();
+    Vector2 tHat1 = { t1.getX(), t1.getY() };
+    Vector2 tHat2 = { t2.getX(), t2.getY() };
+    
+    Point2 bezCurve[4];
+    double error = FitCurve (points.data(), count, tHat1, tHat2, square ((double)tolerance), *scratch, bezCurve);
+    
+    for (auto n = 0; n < 4; ++n)
+        bezier[n] = Point<float> ((float)bezCurve[n].x, (float)bezCurve[n].y);
+    
+    return error;
+}
+
+void StrokeFit::settle()
+{
+    open.setExitPosition (roundToInt (bezier[1].getX()), roundToInt (bezier[1].getY()));
+    anchors.add (open);
+    
+    open = Anchor (roundToInt (bezier[3].getX()), roundToInt (bezier[3].getY()));
+    open.setEntryPosition (roundToInt (bezier[2].getX()), roundToInt (bezier[2].getY()));
+}
+
 /*
 An Algorithm for Automatically Fitting Digitized Curves
 by Philip J. Schneider
@@ -75,13 +271,15 @@ from "Graphics Gems", Academic Press, 1990
 /*  fit_cubic.c    */
 /*    Piecewise cubic fitting code    */
 
-
-typedef Point2 *BezierCurve;
+// Changed to NOT break up the fit into multiple segments, just provide the
+// best bit for two control points and say how far off it is. Working space
+// comes from a CurveFit::Scratch instead of malloc, so separate fits can
+// run at once.
 
 /* Forward declarations */
-static void FitCubic(Point2 *d, int first, int last, Vector2 tHat1, Vector2 tHat2, double error);
-static BezierCurve  GenerateBezier(Point2 *d, int first, int last, double *uPrime, Vector2 tHat1, Vector2 tHat2);
-static double *Reparameterize (Point2 *d, int first, int last, double *u, BezierCurve    bezCurve);
+static double FitCubic(Point2 *d, int first, int last, Vector2 tHat1, Vector2 tHat2, double error, CurveFit::Scratch& s, BezierCurve bezCurve);
+static void GenerateBezier(Point2 *d, int first, int last, double *uPrime, Vector2 tHat1, Vector2 tHat2, CurveFit::Scratch& s, BezierCurve bezCurve);
+static void Reparameterize (Point2 *d, int first, int last, double *u, BezierCurve bezCurve, double *uPrime);
 static double NewtonRaphsonRootFind (BezierCurve Q, Point2 P, double u);
 static Point2 BezierII (int degree, Point2 *V, double t);
 static double B0 (double u);
@@ -90,8 +288,7 @@ static double B2 (double u);
 static double B3 (double u);
 static Vector2 ComputeLeftTangent (Point2 *d, int end);
 static Vector2 ComputeRightTangent (Point2 *d, int end);
-// static Vector2 ComputeCenterTangent (Point2 *d, int center);
-static double *ChordLengthParameterize (Point2 *d, int first, int last);
+static void ChordLengthParameterize (Point2 *d, int first, int last, double *u);
 static double ComputeMaxError (Point2 *d, int first, int last, BezierCurve bezCurve, double *u, int *splitPoint);
 static Vector2 V2AddII (Vector2 a, Vector2 b);
 static Vector2 V2ScaleIII (Vector2 v, double s);
@@ -106,32 +303,30 @@ Vector2 *V2Negate(Vector2 *v);
 Vector2 *V2Normalize(Vector2 *v);
 double V2SquaredLength(Vector2 *a);
 
-#define MAXPOINTS    1000        /* The most points you can have */
-
-// This is the callback for the various 'ends' of the potentially
-// recursive fit routine. The routine is modified to NOT break
-// up the fit to multiple segments, just provide the best bit for
-// two control points
-void DrawBezierCurve(int /*n*/, BezierCurve curve, int /*first*/, int /*last*/)
-{
-    startAnchor->setExitPosition ((int)curve[1].x, (int)curve[1].y);
-    endAnchor->setEntryPosition ((int)curve[2].x, (int)curve[2].y);
-}
-
 /*
  *  FitCurve :
  *      Fit a Bezier curve to a set of digitized points
  */
-void FitCurve(
+static double FitCurve(
     Point2    *d,            /*  Array of digitized points    */
     int        nPts,        /*  Number of digitized points    */
-    double    error)        /*  User-defined error squared    */
+    Vector2    tHat1,
+    Vector2    tHat2,    /*  Tangent vectors at endpoints, zero to work them out */
+    double    error,        /*  User-defined error squared    */
+    CurveFit::Scratch& s,
+    BezierCurve bezCurve)   /*  RETURN bezier curve ctl pts    */
 {
-    Vector2    tHat1, tHat2;    /*  Unit tangent vectors at endpoints */
-
-    tHat1 = ComputeLeftTangent(d, 0);
-    tHat2 = ComputeRightTangent(d, nPts - 1);
-    FitCubic(d, 0, nPts - 1, tHat1, tHat2, error);
+    if (V2SquaredLength(&tHat1) == 0.0)
+        tHat1 = ComputeLeftTangent(d, 0);
+    else
+        V2Normalize(&tHat1);
+    
+    if (V2SquaredLength(&tHat2) == 0.0)
+        tHat2 = ComputeRightTangent(d, nPts - 1);
+    else
+        V2Normalize(&tHat2);
+    
+    return FitCubic(d, 0, nPts - 1, tHat1, tHat2, error, s, bezCurve);
 }
 
 
@@ -140,23 +335,21 @@ void FitCurve(
  *  FitCubic :
  *      Fit a Bezier curve to a (sub)set of digitized points
  */
-static void FitCubic(
+static double FitCubic(
     Point2    *d,            /*  Array of digitized points */
     int        first,
     int        last,    /* Indices of first and last pts in region */
     Vector2    tHat1,
     Vector2    tHat2,    /* Unit tangent vectors at endpoints */
-    double    error)        /*  User-defined error squared       */
+    double    error,        /*  User-defined error squared       */
+    CurveFit::Scratch& s,
+    BezierCurve bezCurve) /*Control points of fitted Bezier curve*/
 {
-    BezierCurve    bezCurve; /*Control points of fitted Bezier curve*/
-    double    *u;        /*  Parameter values for point  */
-    double    *uPrime;    /*  Improved parameter values */
     double    maxError;    /*  Maximum fitting error     */
     int        splitPoint;    /*  Point to split point set at     */
     int        nPts;        /*  Number of points in subset  */
     double    iterationError; /*Error below which you try iterating  */
     int        maxIterations = 4; /*  Max times to try iterating  */
-//    Vector2    tHatCenter;       /* Unit tangent vector at splitPoint */
     int        i;
 
     iterationError = error * 4.0;    /* fixed issue 23 */
@@ -166,60 +359,42 @@ static void FitCubic(
     if (nPts == 2) {
         double dist = V2DistanceBetween2Points(&d[last], &d[first]) / 3.0;
 
-        bezCurve = (Point2 *)malloc(4 * sizeof(Point2));
         bezCurve[0] = d[first];
         bezCurve[3] = d[last];
         V2Add(&bezCurve[0], V2Scale(&tHat1, dist), &bezCurve[1]);
         V2Add(&bezCurve[3], V2Scale(&tHat2, dist), &bezCurve[2]);
-        DrawBezierCurve(3, bezCurve, first, last);
-        free((void *)bezCurve);
-        return;
+        return 0.0;
     }
 
+    s.u.resize ((size_t)nPts);
+    s.uPrime.resize ((size_t)nPts);
+
     /*  Parameterize points, and attempt to fit curve */
-    u = ChordLengthParameterize(d, first, last);
-    bezCurve = GenerateBezier(d, first, last, u, tHat1, tHat2);
+    ChordLengthParameterize(d, first, last, s.u.data());
+    GenerateBezier(d, first, last, s.u.data(), tHat1, tHat2, s, bezCurve);
 
     /*  Find max deviation of points to fitted curve */
-    maxError = ComputeMaxError(d, first, last, bezCurve, u, &splitPoint);
-    if (maxError < error) {
-        DrawBezierCurve(3, bezCurve, first, last);
-        free((void *)u);
-        free((void *)bezCurve);
-        return;
-    }
-
+    maxError = ComputeMaxError(d, first, last, bezCurve, s.u.data(), &splitPoint);
+    if (maxError < error)
+        return maxError;
 
     /*  If error not too large, try some reparameterization  */
     /*  and iteration */
     if (maxError < iterationError) {
         for (i = 0; i < maxIterations; i++) {
-            uPrime = Reparameterize(d, first, last, u, bezCurve);
-            free((void *)bezCurve);
-            bezCurve = GenerateBezier(d, first, last, uPrime, tHat1, tHat2);
+            Reparameterize(d, first, last, s.u.data(), bezCurve, s.uPrime.data());
+            GenerateBezier(d, first, last, s.uPrime.data(), tHat1, tHat2, s, bezCurve);
             maxError = ComputeMaxError(d, first, last,
-                       bezCurve, uPrime, &splitPoint);
-            if (maxError < error) {
-            DrawBezierCurve(3, bezCurve, first, last);
-            free((void *)u);
-            free((void *)bezCurve);
-            free((void *)uPrime);
-            return;
+                       bezCurve, s.uPrime.data(), &splitPoint);
+            if (maxError < error)
+                return maxError;
+            s.u.swap (s.uPrime);
         }
-        free((void *)u);
-        u = uPrime;
-    }
     }
 
-    /* Fitting failed -- split at max error point and fit recursively */
+    /* Fitting failed -- would split at max error point and fit recursively */
     // Just send the best fit back...
-    DrawBezierCurve(3, bezCurve, first, last);
-    free((void *)u);
-    free((void *)bezCurve);
-//    tHatCenter = ComputeCenterTangent(d, splitPoint);
-//    FitCubic(d, first, splitPoint, tHat1, tHatCenter, error);
-//    V2Negate(&tHatCenter);
-//    FitCubic(d, splitPoint, last, tHatCenter, tHat2, error);
+    return maxError;
 }
 
 
@@ -228,16 +403,17 @@ static void FitCubic(
  *  Use least-squares method to find Bezier control points for region.
  *
  */
-static BezierCurve  GenerateBezier(
+static void GenerateBezier(
     Point2    *d,            /*  Array of digitized points    */
     int        first,
     int        last,        /*  Indices defining region    */
     double    *uPrime,        /*  Parameter values for region */
     Vector2    tHat1,
-    Vector2    tHat2)    /*  Unit tangents at endpoints    */
+    Vector2    tHat2,    /*  Unit tangents at endpoints    */
+    CurveFit::Scratch& s,
+    BezierCurve bezCurve)    /* RETURN bezier curve ctl pts    */
 {
     int     i;
-    Vector2     A[MAXPOINTS][2];    /* Precomputed rhs for eqn    */
     int     nPts;            /* Number of pts in sub-curve */
     double     C[2][2];            /* Matrix C        */
     double     X[2];            /* Matrix X            */
@@ -247,13 +423,14 @@ static BezierCurve  GenerateBezier(
     double     alpha_l,        /* Alpha values, left and right    */
                alpha_r;
     Vector2     tmp;            /* Utility variable        */
-    BezierCurve    bezCurve;    /* RETURN bezier curve ctl pts    */
     double  segLength;
     double  epsilon;
 
-    bezCurve = (Point2 *)malloc(4 * sizeof(Point2));
     nPts = last - first + 1;
 
+    /* Precomputed rhs for eqn, two per point    */
+    s.A.resize ((size_t)nPts * 2);
+    Vector2* A = s.A.data();
  
     /* Compute the A's    */
     for (i = 0; i < nPts; i++) {
@@ -262,8 +439,8 @@ static BezierCurve  GenerateBezier(
         v2 = tHat2;
         V2Scale(&v1, B1(uPrime[i]));
         V2Scale(&v2, B2(uPrime[i]));
-        A[i][0] = v1;
-        A[i][1] = v2;
+        A[i * 2] = v1;
+        A[i * 2 + 1] = v2;
     }
 
     /* Create the C and X matrices    */
@@ -275,11 +452,10 @@ static BezierCurve  GenerateBezier(
     X[1]    = 0.0;
 
     for (i = 0; i < nPts; i++) {
-        C[0][0] += V2Dot(&A[i][0], &A[i][0]);
-        C[0][1] += V2Dot(&A[i][0], &A[i][1]);
-/*                    C[1][0] += V2Dot(&A[i][0], &A[i][1]);*/
+        C[0][0] += V2Dot(&A[i * 2], &A[i * 2]);
+        C[0][1] += V2Dot(&A[i * 2], &A[i * 2 + 1]);
         C[1][0] = C[0][1];
-        C[1][1] += V2Dot(&A[i][1], &A[i][1]);
+        C[1][1] += V2Dot(&A[i * 2 + 1], &A[i * 2 + 1]);
 
         tmp = V2SubII(d[first + i],
             V2AddII(
@@ -291,8 +467,8 @@ static BezierCurve  GenerateBezier(
                                 V2ScaleIII(d[last], B3(uPrime[i]))))));
     
 
-    X[0] += V2Dot(&A[i][0], &tmp);
-    X[1] += V2Dot(&A[i][1], &tmp);
+    X[0] += V2Dot(&A[i * 2], &tmp);
+    X[1] += V2Dot(&A[i * 2 + 1], &tmp);
     }
 
     /* Compute the determinants of C and X    */
@@ -317,7 +493,7 @@ static BezierCurve  GenerateBezier(
         bezCurve[3] = d[last];
         V2Add(&bezCurve[0], V2Scale(&tHat1, dist), &bezCurve[1]);
         V2Add(&bezCurve[3], V2Scale(&tHat2, dist), &bezCurve[2]);
-        return (bezCurve);
+        return;
     }
 
     /*  First and last control points of the Bezier curve are */
@@ -328,7 +504,6 @@ static BezierCurve  GenerateBezier(
     bezCurve[3] = d[last];
     V2Add(&bezCurve[0], V2Scale(&tHat1, alpha_l), &bezCurve[1]);
     V2Add(&bezCurve[3], V2Scale(&tHat2, alpha_r), &bezCurve[2]);
-    return (bezCurve);
 }
 
 
@@ -338,23 +513,20 @@ static BezierCurve  GenerateBezier(
  *   a better parameterization.
  *
  */
-static double *Reparameterize(
+static void Reparameterize(
     Point2    *d,            /*  Array of digitized points    */
     int        first,
     int        last,        /*  Indices defining region    */
     double    *u,            /*  Current parameter values    */
-    BezierCurve    bezCurve)    /*  Current fitted curve    */
+    BezierCurve    bezCurve,    /*  Current fitted curve    */
+    double    *uPrime)        /*  RETURN new parameter values    */
 {
-    int     nPts = last-first+1;
     int     i;
-    double    *uPrime;        /*  New parameter values    */
 
-    uPrime = (double *)malloc(nPts * sizeof(double));
     for (i = first; i <= last; i++) {
         uPrime[i-first] = NewtonRaphsonRootFind(bezCurve, d[i], u[i-
                     first]);
     }
-    return (uPrime);
 }
 
 
@@ -417,12 +589,9 @@ static Point2 BezierII(
     double     t)       /* Parametric value to find point for    */
 {
     int     i, j;
-    Point2     Q;            /* Point on curve at parameter t    */
-    Point2     *Vtemp;        /* Local copy of control points        */
+    Point2     Vtemp[4];        /* Local copy of control points, cubic at most    */
 
     /* Copy array    */
-    Vtemp = (Point2 *)malloc((unsigned)((degree+1)
-                * sizeof (Point2)));
     for (i = 0; i <= degree; i++) {
         Vtemp[i] = V[i];
     }
@@ -435,9 +604,7 @@ static Point2 BezierII(
         }
     }
 
-    Q = Vtemp[0];
-    free((void *)Vtemp);
-    return Q;
+    return Vtemp[0];
 }
 
 
@@ -472,8 +639,8 @@ static double B3 (double u)
 
 
 /*
- * ComputeLeftTangent, ComputeRightTangent, ComputeCenterTangent :
- *Approximate unit tangents at endpoints and "center" of digitized curve
+ * ComputeLeftTangent, ComputeRightTangent :
+ *Approximate unit tangents at endpoints of digitized curve
  */
 static Vector2 ComputeLeftTangent(
     Point2    *d,            /*  Digitized points*/
@@ -495,36 +662,19 @@ static Vector2 ComputeRightTangent(
     return tHat2;
 }
 
-#if 0
-static Vector2 ComputeCenterTangent(
-    Point2    *d,            /*  Digitized points            */
-    int        center)        /*  Index to point inside region    */
-{
-    Vector2    V1, V2, tHatCenter;
-
-    V1 = V2SubII(d[center-1], d[center]);
-    V2 = V2SubII(d[center], d[center+1]);
-    tHatCenter.x = (V1.x + V2.x)/2.0;
-    tHatCenter.y = (V1.y + V2.y)/2.0;
-    tHatCenter = *V2Normalize(&tHatCenter);
-    return tHatCenter;
-}
-#endif
 
 /*
  *  ChordLengthParameterize :
  *    Assign parameter values to digitized points
  *    using relative distances between points.
  */
-static double *ChordLengthParameterize(
+static void ChordLengthParameterize(
     Point2    *d,            /* Array of digitized points */
     int       first,
-    int       last)          /*  Indices defining region    */
+    int       last,          /*  Indices defining region    */
+    double    *u)            /*  RETURN parameterization    */
 {
     int        i;
-    double    *u;            /*  Parameterization        */
-
-    u = (double *)malloc((unsigned)(last-first+1) * sizeof(double));
 
     u[0] = 0.0;
     for (i = first+1; i <= last; i++) {
@@ -535,8 +685,6 @@ static double *ChordLengthParameterize(
     for (i = first + 1; i <= last; i++) {
         u[i-first] = u[i-first] / u[last-first];
     }
-
-    return(u);
 }
 
 /*
@@ -22,8 +22,90 @@
 #include <JuceHeader.h>
 #include "Anchor.h"
 
+// Fits cubic beziers to stretches of a path. The path gets flattened once
+// into a polyline measured by arc length, so fitting every stretch of it
+// doesn't walk the curves over and over. Everything the fitter needs lives
+// in the object, so each thread can have its own.
 class CurveFit
 {
 public:
-    static bool fit (Path& path, float start, float end, Anchor& aStart, Anchor& aEnd);
+    CurveFit (const Path& path);
+    ~CurveFit();
+    
+    float getLength() const { return length; }
+    Point<float> getPointAlongPath (float distance) const;
+    
+    // Puts aStart and aEnd at the ends of the stretch from start to end and
+    // their handles on the cubic that fits it best
+    bool fit (float start, float end, Anchor& aStart, Anchor& aEnd);
+    
+    // Samples per stretch, more where the flattened path has more vertices
+    // (the bends)
+    static const int minSamples = 9;
+    static const int maxSamples = 64;
+    
+    // The fitter's working space
+    class Scratch;
+    
+private:
+    Array<Point<float>> vertices;
+    Array<float> distances;
+    float length;
+    std::unique_ptr<Scratch> scratch;
+    
+    JUCE_DECLARE_NON_COPYABLE (CurveFit)
+};
+
+//==============================================================================
+// Fits a stroke as the samples come in. The open segment is refitted to
+// its own samples on every new one, at most maxSamples of them so each
+// sample costs the same however long the stroke gets. Once a fit misses by
+// more than tolerance, the last one that didn't is settled and the next
+// segment starts from its end, carrying its tangent on unless the stroke
+// turned a corner there.
+class StrokeFit
+{
+public:
+    // Both in path units, samples closer than spacing to the last one
+    // are dropped
+    StrokeFit (float tolerance, float spacing);
+    ~StrokeFit();
+    
+    // True when it settled more anchors
+    bool addSample (Point<float> p);
+    // Settles the open segment, the end of the stroke is its last anchor
+    void finish();
+    
+    // Anchors are only added once both their handles are settled
+    const Array<Anchor>& getAnchors() const { return anchors; }
+    // Whatever isn't in getAnchors() yet, from the last anchor there to
+    // the newest sample
+    void getOpenSegment (Path& path) const;
+    
+    static const int maxSamples = 32;
+    
+    // Turns sharper than this many degrees make a corner
+    static constexpr float cornerAngle = 60.0f;
+    
+private:
+    // Squared distance of the worst sample
+    double fitOpen();
+    void settle();
+    
+    float tolerance;
+    float spacing;
+    
+    Array<Anchor> anchors;
+    // The open segment's first anchor, its exit handle isn't settled yet
+    Anchor open;
+    Array<Point<float>> samples;
+    Point<float> startTangent;
+    bool smoothStart;
+    
+    // Best fit to all of samples
+    Point<float> bezier[4];
+    
+    std::unique_ptr<CurveFit::Scratch> scratch;
+    
+    JUCE_DECLARE_NON_COPYABLE (StrokeFit)
 };
@@ -29,7 +29,7 @@
 EditProperties::EditProperties (FrameEditor* frame)
 {
     frameEditor = frame;
-    frameEditor->addActionListener (this);
+    frameEditor->addEditorListener (this);
     
     viewButton.reset (new TextButton ("viewButton"));
     viewButton->setButtonText ("Front");
@@ -86,6 +86,7 @@ EditProperties::EditProperties (FrameEditor* frame)
 
 EditProperties::~EditProperties()
 {
+    frameEditor->removeEditorListener (this);
     viewButton = nullptr;
     showAllButton = nullptr;
     showAllIcon = nullptr;
@@ -157,16 +158,18 @@ void EditProperties::updateViewButton()
     }
 }
 
-void EditProperties::actionListenerCallback (const String& message)
+void EditProperties::editorChanged (const EditorChanges& changes)
 {
-    if (message == EditorActions::layerChanged)
+    if (changes.has (EditorActions::layerChanged))
     {
         if (frameEditor->getActiveLayer() != layerTabs->getCurrentTabIndex())
             layerTabs->setCurrentTabIndex (frameEditor->getActiveLayer());
     }
-    else if (message == EditorActions::zoomFactorChanged)
+    
+    if (changes.has (EditorActions::zoomFactorChanged))
         updateZoomButtons();
-    else if (message == EditorActions::viewChanged)
+    
+    if (changes.has (EditorActions::viewChanged))
         updateViewButton();
 }
 
@@ -46,7 +46,7 @@ private:
 //==============================================================================
 class EditProperties  : public Component,
                         public Button::Listener,
-                        public ActionListener
+                        public EditorBus::Listener
 {
 public:
     EditProperties (FrameEditor* frame);
@@ -60,7 +60,7 @@ public:
     void buttonClicked (juce::Button* buttonThatWasClicked) override;
 
     //==============================================================================
-    void actionListenerCallback (const String& message) override;
+    void editorChanged (const EditorChanges& changes) override;
 
 private:
     void updateZoomButtons();
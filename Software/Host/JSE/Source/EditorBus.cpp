@@ -0,0 +1,94 @@
+/*
+    EditorBus.cpp
+    Typed change notifications, coalesced and delivered once per message loop
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "EditorBus.h"
+
+//==============================================================================
+EditorBus::EditorBus (EditorChanges r)
+: requests (r), coalescing (true)
+{
+    resetStats();
+}
+
+EditorBus::~EditorBus()
+{
+    cancelPendingUpdate();
+}
+
+void EditorBus::post (const EditorChanges& changes)
+{
+    if (changes.isEmpty())
+        return;
+    
+    {
+        const ScopedLock l (lock);
+        
+        // Fold into the last lot unless either side is a request
+        if (coalescing && queue.size() && ! changes.has (requests)
+            && ! queue.getReference (queue.size() - 1).has (requests))
+            queue.getReference (queue.size() - 1) |= changes;
+        else
+            queue.add (changes);
+    }
+    
+    ++posts;
+    triggerAsyncUpdate();
+}
+
+//==============================================================================
+void EditorBus::resetStats()
+{
+    posts = 0;
+    deliveries = 0;
+    callbacks = 0;
+    dispatchTime = 0;
+    dispatchMax = 0;
+}
+
+String EditorBus::getReport() const
+{
+    if (! posts.get())
+        return {};
+    
+    return String (posts.get()) + " posts in " + String (deliveries) + " deliveries, "
+           + String (callbacks) + " callbacks, "
+           + String (dispatchTime, 1) + " ms (max " + String (dispatchMax, 1) + ")";
+}
+
+void EditorBus::handleAsyncUpdate()
+{
+    Array<EditorChanges> batch;
+    {
+        const ScopedLock l (lock);
+        batch.swapWith (queue);
+    }
+    
+    // Anything posted from in here goes out next time round
+    for (auto& changes : batch)
+    {
+        double start = Time::getMillisecondCounterHiRes();
+        listeners.call ([&changes] (Listener& l) { l.editorChanged (changes); });
+        double time = Time::getMillisecondCounterHiRes() - start;
+        
+        ++deliveries;
+        callbacks += listeners.size();
+        dispatchTime += time;
+        dispatchMax = jmax (dispatchMax, time);
+    }
+}
@@ -0,0 +1,101 @@
+/*
+    EditorBus.h
+    Typed change notifications, coalesced and delivered once per message loop
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+// A set of changes, one bit each
+class EditorChanges
+{
+public:
+    constexpr EditorChanges() : bits (0) {;}
+    constexpr explicit EditorChanges (uint64 b) : bits (b) {;}
+    
+    // True if any of other's changes are in here
+    bool has (const EditorChanges& other) const { return (bits & other.bits) != 0; }
+    bool isEmpty() const { return bits == 0; }
+    uint64 getBits() const { return bits; }
+    
+    EditorChanges operator| (const EditorChanges& other) const { return EditorChanges (bits | other.bits); }
+    EditorChanges& operator|= (const EditorChanges& other) { bits |= other.bits; return *this; }
+    bool operator== (const EditorChanges& other) const { return bits == other.bits; }
+    bool operator!= (const EditorChanges& other) const { return bits != other.bits; }
+    
+private:
+    uint64 bits;
+};
+
+//==============================================================================
+// Changes posted between two runs of the message loop are merged and each
+// listener gets them in one call. Requests are different, every one has to
+// be acted on, so they go out one per call, in order with the changes
+// around them.
+// post() is fine from any thread, listeners are called on the message
+// thread.
+class EditorBus : private AsyncUpdater
+{
+public:
+    EditorBus (EditorChanges requests);
+    ~EditorBus() override;
+    
+    class Listener
+    {
+    public:
+        virtual ~Listener() {;}
+        virtual void editorChanged (const EditorChanges& changes) = 0;
+    };
+    
+    void addEditorListener (Listener* listener) { listeners.add (listener); }
+    void removeEditorListener (Listener* listener) { listeners.remove (listener); }
+    
+    void post (const EditorChanges& changes);
+    
+    // Off delivers every post on its own, like the strings used to be
+    void setCoalescing (bool coalesce) { coalescing = coalesce; }
+    bool getCoalescing() const { return coalescing; }
+    
+    // Counts since the last resetStats
+    int getPostCount() const { return posts.get(); }
+    int getDeliveryCount() const { return deliveries; }
+    int getCallbackCount() const { return callbacks; }
+    double getDispatchTime() const { return dispatchTime; }
+    double getMaxDispatchTime() const { return dispatchMax; }
+    void resetStats();
+    String getReport() const;
+    
+private:
+    void handleAsyncUpdate() override;
+    
+    EditorChanges requests;
+    std::atomic<bool> coalescing;
+    
+    CriticalSection lock;
+    Array<EditorChanges> queue;
+    ListenerList<Listener> listeners;
+    
+    Atomic<int> posts;
+    int deliveries;
+    int callbacks;
+    double dispatchTime;
+    double dispatchMax;
+    
+    JUCE_DECLARE_NON_COPYABLE (EditorBus)
+};
@@ -17,16 +17,19 @@
     limitations under the License.
 */
 
-#include "ThumbBuilder.h"
 #include "Frame.h"
 
+// Loaders build frames on other threads
+static Atomic<int64> nextThumbKey;
+
 //==============================================================================
 Frame::Frame()
 : imageOpacity (1.0),
   imageScale (1.0),
   imageRotation (0.0),
   imageXoffset (0.0),
-  imageYoffset (0.0)
+  imageYoffset (0.0),
+  thumbKey (++nextThumbKey)
 {
 }
 
@@ -39,11 +42,9 @@ Frame::Frame (const Frame& frame)
     imageYoffset = frame.imageYoffset;
     framePoints = frame.framePoints;
     iPaths = frame.iPaths;
-    thumbNail = frame.thumbNail;
-    imageData = frame.imageData;
-    
-    Image i = ImageFileFormat::loadFrom(imageData.getData(), imageData.getSize());
-    backgroundImage.reset (new Image(i));
+    // The copy is free to go its own way
+    thumbKey = ++nextThumbKey;
+    refImage = frame.refImage;
 }
 
 Frame::~Frame()
@@ -52,9 +53,16 @@ Frame::~Frame()
 
 void Frame::setImageData (const MemoryBlock& data)
 {
-    imageData = data;
-    Image i = ImageFileFormat::loadFrom(imageData.getData(), imageData.getSize());
-    backgroundImage.reset (new Image(i));
+    if (data.getSize())
+        refImage = std::make_shared<RefImage> (data);
+    else
+        refImage = nullptr;
+}
+
+const MemoryBlock& Frame::getImageData()
+{
+    static const MemoryBlock none;
+    return refImage != nullptr ? refImage->getData() : none;
 }
 
 //==============================================================================
@@ -77,8 +85,7 @@ void Frame::replacePoint (uint16 index, const IPoint& newPoint)
     if (index >= framePoints.size())
         return;
     
-    framePoints.remove (index);
-    framePoints.insert (index, newPoint);
+    framePoints.set (index, newPoint);
 }
 
 void Frame::insertPoint (uint16 index, const IPoint& newPoint)
@@ -97,7 +104,7 @@ void Frame::removePoint (uint16 index)
     framePoints.remove (index);
 }
 
-void Frame::buildThumbNail (int width, int height, float lineSize)
+void Frame::invalidateThumbNail()
 {
-    ThumbBuilder::build (this, thumbNail, width, height, lineSize);
+    thumbKey = ++nextThumbKey;
 }
@@ -22,6 +22,7 @@
 #include <JuceHeader.h>
 #include "IPath.h"
 #include "ILDA.h"
+#include "RefImage.h"
 
 // Reference Counted so we can keep frames around for undo and just have them
 // clean up whenever those undo objects are released
@@ -32,9 +33,11 @@ public:
     Frame (const Frame&t);
     ~Frame();
     
-    const Image* getBackgroundImage() { return backgroundImage.get(); }
+    // Decoded the first time it's asked for, nullptr if there isn't one
+    const Image* getBackgroundImage() { return refImage != nullptr ? refImage->getImage() : nullptr; }
+    std::shared_ptr<RefImage> getRefImage() { return refImage; }
     void setImageData (const MemoryBlock& data);
-    const MemoryBlock& getImageData() { return imageData; }
+    const MemoryBlock& getImageData();
     
     float getImageOpacity()             { return imageOpacity; }
     void setImageOpacity (float opacity) { imageOpacity = opacity;}
@@ -74,8 +77,10 @@ public:
     void insertPath (int index, const IPath& p) { iPaths.insert (index, p); }
     void replacePath (int index, const IPath& p) { iPaths.set (index, p); }
     
-    void buildThumbNail (int width = 150, int height = 150, float lineSize = 1.0);
-    const Image& getThumbNail() { return thumbNail; }
+    // Names the frame's thumbnail in the ThumbCache, a new one after
+    // invalidating means the old thumbnail won't be found again
+    int64 getThumbKey() const { return thumbKey; }
+    void invalidateThumbNail();
     
     // Make a counting pointer of our type
     using Ptr = ReferenceCountedObjectPtr<Frame>;
@@ -171,8 +176,8 @@ public:
     }
 
 private:
-    std::unique_ptr<Image> backgroundImage;
-    MemoryBlock imageData;
+    // Shared with copies, it never changes
+    std::shared_ptr<RefImage> refImage;
     float imageOpacity;
     float imageScale;
     float imageRotation;
@@ -182,5 +187,5 @@ private:
     Array<IPoint> framePoints;
     Array<IPath> iPaths;
 
-    Image thumbNail;
+    int64 thumbKey;
 };
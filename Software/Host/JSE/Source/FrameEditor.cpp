@@ -24,16 +24,42 @@
 #include "IldaExporter.h"
 #include "ShortestPath.h"
 #include "CurveFit.h"
+#include "IldaTransforms.h"
+#include "WorkerPool.h"
+#include "BezierSampler.h"
 #include "FrameEditor.h"
 
 #include "FrameUndo.h"      // UndoableTask classes
 
-// !!!! Should probably be a preference
-const int blankPointSpacing = 1800;
+//==============================================================================
+// One evaluation of a live transform, run on a WorkerPool thread
+class PreviewJob
+{
+public:
+    PreviewJob (const FrameEditor::IldaKernel& k, bool c)
+    : kernel (k), constrain (c), clipped (false), done (true)
+    {
+        x = y = z = 0;
+    }
+    
+    void run()
+    {
+        clipped = kernel (points, x, y, z);
+        done.signal();
+    }
+    
+    FrameEditor::IldaKernel kernel;
+    bool constrain;
+    Array<Frame::IPoint> points;
+    int16 x, y, z;
+    bool clipped;
+    WaitableEvent done;
+};
 
 //==============================================================================
 FrameEditor::FrameEditor()
-    : dirtyCounter (0),
+    : EditorBus (EditorActions::requests),
+      dirtyCounter (0),
       scanRate (22000),
       zoomFactor (1.0),
       activeLayer (sketch),
@@ -52,14 +78,25 @@ FrameEditor::FrameEditor()
       refDrawGrid (true),
       refOpacity (1.0),
       frameIndex (0),
-      tranformInProgress (false)
+      tranformInProgress (false),
+      previewCoalescing (true),
+      hasPendingPreview (false),
+      pendingConstrain (false),
+      adaptiveTolerance (0.0f)
 {
     Frames.add (new Frame());
     currentFrame = Frames[frameIndex];    
+    
+    // Safe from the pool thread, post() only queues it
+    thumbCache.onRefreshed = [this] { post (EditorActions::frameThumbsChanged); };
 }
 
 FrameEditor::~FrameEditor()
 {
+    stopTimer();
+    if (previewJob != nullptr)
+        previewJob->done.wait();
+    
     currentFrame = nullptr;
 }
 
@@ -67,7 +104,7 @@ FrameEditor::~FrameEditor()
 void FrameEditor::setDirtyCounter (uint32 count)
 {
     dirtyCounter = count;
-    sendActionMessage (EditorActions::dirtyStatusChanged);
+    post (EditorActions::dirtyStatusChanged);
 }
 
 void FrameEditor::incDirtyCounter()
@@ -76,7 +113,7 @@ void FrameEditor::incDirtyCounter()
 
     if (dirtyCounter == 1)
     {
-        sendActionMessage (EditorActions::dirtyStatusChanged);
+        post (EditorActions::dirtyStatusChanged);
         refreshThumb();
     }
 }
@@ -89,7 +126,7 @@ void FrameEditor::decDirtyCounter()
         
         if (! dirtyCounter)
         {
-            sendActionMessage (EditorActions::dirtyStatusChanged);
+            post (EditorActions::dirtyStatusChanged);
             refreshThumb();
         }
     }
@@ -97,8 +134,8 @@ void FrameEditor::decDirtyCounter()
 
 void FrameEditor::refreshThumb()
 {
-    currentFrame->buildThumbNail();
-    sendActionMessage (EditorActions::frameThumbsChanged);
+    // frameThumbsChanged goes out when it has been built
+    thumbCache.refresh (currentFrame.get());
 }
 
 //==============================================================================
@@ -211,7 +248,7 @@ void FrameEditor::copy()
     
     iPathCopy.clear();
     getSelectedIPaths (iPathCopy);
-    sendActionMessage (EditorActions::selectionCopied);
+    post (EditorActions::selectionCopied);
 }
 
 void FrameEditor::adjustSelection (int offset)
@@ -624,6 +661,62 @@ void FrameEditor::selectImage()
     }
 }
 
+AffineTransform FrameEditor::getImageTransform()
+{
+    const Image* i = getImage();
+    if (i == nullptr)
+        return AffineTransform();
+    
+    auto w = i->getWidth();
+    auto h = i->getHeight();
+    float scale;
+    float iscale = getImageScale();
+    
+    if (w > h)
+        scale = iscale * 65536.0f / w;
+    else
+        scale = iscale * 65536.0f / h;
+
+    float x = 32768.0f - (w * scale / 2) +
+        (getImageXoffset() / 100.0f * 65536.0f);
+    float y = 32768.0f - (h * scale / 2) +
+        (getImageYoffset() / 100.0f * 65536.0f);
+
+    return AffineTransform::rotation (getImageRotation() * MathConstants<float>::pi / 180.0f,
+                                      w / 2.0f,
+                                      h / 2.0f)
+           .followedBy (AffineTransform::scale (scale))
+           .followedBy (AffineTransform::translation (x, y));
+}
+
+void FrameEditor::traceImage (float threshold, float smoothing, float minLength, Array<IPath>& paths)
+{
+    const Image* i = getImage();
+    if (i == nullptr)
+    {
+        imageTracer.clear();
+        paths.clear();
+        return;
+    }
+    
+    imageTracer.setImage (*i, getImageTransform());
+    imageTracer.trace (threshold, smoothing, minLength, sketchToolColor, paths);
+}
+
+void FrameEditor::addTracedPaths (const Array<IPath>& paths)
+{
+    if (! paths.size())
+        return;
+    
+    beginNewTransaction ("Auto Trace");
+    int rangeStart = getIPathCount();
+    int rangeEnd = rangeStart + paths.size();
+    perform (new UndoableAddPaths (this, paths));
+    IPathSelection selection;
+    selection.addRange (Range<uint16> ((uint16)rangeStart, (uint16)rangeEnd));
+    perform (new UndoableSetIPathSelection (this, selection));
+}
+
 void FrameEditor::clearImage()
 {
     if (currentFrame->getBackgroundImage() != nullptr)
@@ -839,7 +932,7 @@ void FrameEditor::setFrameIndex (uint16 index)
 {
     if (getFrameIndex() != index)
     {
-        currentFrame->buildThumbNail();
+        thumbCache.refresh (currentFrame.get());
         
         beginNewTransaction ("Select Frame");
         perform (new UndoableSetIldaSelection (this, SparseSet<uint16>()));
@@ -872,8 +965,8 @@ void FrameEditor::newFrame()
 
 void FrameEditor::dupFrame()
 {
-    // Update the thumbnail before duplicating
-    currentFrame->buildThumbNail();
+    // Pick up any edits in the thumbnail before duplicating
+    thumbCache.refresh (currentFrame.get());
 
     beginNewTransaction ("Duplicate Frame");
     uint16 sel = getFrameIndex() + 1;
@@ -886,7 +979,7 @@ void FrameEditor::moveFrameUp()
     if (getFrameIndex())
     {
         // Update the thumb just in case there are edits
-        currentFrame->buildThumbNail();
+        thumbCache.refresh (currentFrame.get());
         
         beginNewTransaction ("Move Frame Up");
         uint16 sel = getFrameIndex();
@@ -900,7 +993,7 @@ void FrameEditor::moveFrameDown()
     if (getFrameIndex() < (Frames.size() - 1))
     {
         // Update the thumb just in case there are edits
-        currentFrame->buildThumbNail();
+        thumbCache.refresh (currentFrame.get());
 
         beginNewTransaction ("Move Frame Down");
         uint16 sel = getFrameIndex();
@@ -1379,6 +1472,27 @@ int FrameEditor::insertPath (Point<int> firstAnchor)
     return index;
 }
 
+int FrameEditor::insertFreehandPath (const Array<Anchor>& anchors)
+{
+    if (anchors.size() < 2)
+        return -1;
+    
+    IPath path;
+    path.setColor (sketchToolColor);
+    path.setAnchors (anchors);
+    
+    beginNewTransaction ("Freehand Stroke");
+    Array<IPath> array;
+    array.add (path);
+    IPathSelection selection;
+    int index = getIPathCount();
+    selection.addRange (Range<uint16> ((uint16)index, (uint16)index + 1));
+    perform (new UndoableAddPaths (this, array));
+    perform (new UndoableSetIPathSelection (this, selection));
+    
+    return index;
+}
+
 int FrameEditor::insertAnchor (Point<int> location)
 {
     int aIndex = iPathSelection.getAnchor();
@@ -1561,7 +1675,7 @@ bool FrameEditor::isClosedIPath (const IPath &path)
     return false;
 }
 
-void FrameEditor::pointToIPointXYZ (Point<int> a, Frame::IPoint& point, int zStart, int zEnd, float zPercent)
+void FrameEditor::pointToIPointXYZ (View view, Point<int> a, Frame::IPoint& point, int zStart, int zEnd, float zPercent)
 {
     int zDelta = zEnd - zStart;
     int z = zStart + (int)((float)zDelta * zPercent);
@@ -1575,140 +1689,278 @@ void FrameEditor::pointToIPointXYZ (Point<int> a, Frame::IPoint& point, int zSta
     else if (a.getY() > 65535)
         a.setY (65535);
 
-    point.x.w = activeView == Frame::left ? (int16)z : (int16)Frame::toIldaX (a.getX());
-    point.y.w = activeView == Frame::bottom ? (int16)z : (int16)Frame::toIldaY (a.getY());
-    if (activeView == Frame::front)
+    point.x.w = view == Frame::left ? (int16)z : (int16)Frame::toIldaX (a.getX());
+    point.y.w = view == Frame::bottom ? (int16)z : (int16)Frame::toIldaY (a.getY());
+    if (view == Frame::front)
         point.z.w = (int16)z;
-    else if (activeView == Frame::bottom)
+    else if (view == Frame::bottom)
         point.z.w = (int16)Frame::toIldaY (a.getY());
-    else if (activeView == Frame::left)
+    else if (view == Frame::left)
         point.z.w = (int16)Frame::toIldaX (a.getX());
 }
 
-void FrameEditor::anchorToPointXYZ (const Anchor& a, Frame::IPoint& point, int zStart, int zEnd, float zPercent)
+void FrameEditor::anchorToPointXYZ (View view, const Anchor& a, Frame::IPoint& point, int zStart, int zEnd, float zPercent)
 {
-    pointToIPointXYZ (Point<int>(a.getX(), a.getY()), point, zStart, zEnd, zPercent);
+    pointToIPointXYZ (view, Point<int>(a.getX(), a.getY()), point, zStart, zEnd, zPercent);
 }
 
-void FrameEditor::generatePointsFromPaths (const Array<IPath>& paths, Array<Frame::IPoint>& points, bool appendPoints)
+void FrameEditor::generatePointsFromPaths (const SketchRender& render, const Array<IPath>& paths,
+                                          Array<Frame::IPoint>& points, bool appendPoints, Array<int>* runSizes)
 {
     if (! appendPoints)
         points.clear();
     
+    // Once connected the paths don't depend on each other, so each one
+    // renders into its own run and the runs get joined back in order.
+    // Runs for paths that haven't changed come from the cache.
+    Array<Array<Frame::IPoint>> runs;
+    runs.resize (paths.size());
+    
+    SketchCache* cache = render.cache;
+    
+    Array<int> changed;
     for (auto n = 0; n < paths.size(); ++n)
+        if (cache == nullptr || ! cache->find (paths.getReference (n), render.view, render.tolerance, runs.getReference (n)))
+            changed.add (n);
+    
+    WorkerPool::forChunks (changed.size(), 4, [&render, &paths, &runs, &changed, cache] (int start, int end)
     {
-        Anchor lastAnchor;
-        Frame::IPoint point;
-        zerostruct (point);
-        
-        bool closed = isClosedIPath (paths[n]);
-        int endA = paths[n].getAnchorCount() - 1;
-        
-        // Total length of path, zero rendered so far
-        float totalLength = paths[n].getPath().getLength();
-        float rendered = 0.0f;
-        
-        // Z range
-        int startZ = paths[n].getStartZ();
-        int endZ = paths[n].getEndZ();
+        // One sampler per chunk, it keeps its tables between segments
+        BezierSampler segment;
+        for (auto n = start; n < end; ++n)
+        {
+            int p = changed[n];
+            generatePointsFromPath (render, paths.getReference (p), runs.getReference (p), segment);
+            if (cache != nullptr)
+                cache->add (paths.getReference (p), render.view, render.tolerance, runs.getReference (p));
+        }
+    });
+    
+    int total = points.size();
+    for (auto n = 0; n < runs.size(); ++n)
+        total += runs.getReference (n).size();
+    
+    points.ensureStorageAllocated (total);
+    for (auto n = 0; n < runs.size(); ++n)
+        points.addArray (runs.getReference (n));
+    
+    if (runSizes != nullptr)
+    {
+        runSizes->clearQuick();
+        for (auto n = 0; n < runs.size(); ++n)
+            runSizes->add (runs.getReference (n).size());
+    }
+}
+
+// Start, exit control, entry control and end of the segment between two anchors
+static void getSegmentPoints (const Anchor& from, const Anchor& to, Point<float>* p)
+{
+    int x, y;
+    
+    p[0] = Point<float> ((float)from.getX(), (float)from.getY());
+    from.getExitPosition (x, y);
+    p[1] = Point<float> ((float)x, (float)y);
+    to.getEntryPosition (x, y);
+    p[2] = Point<float> ((float)x, (float)y);
+    p[3] = Point<float> ((float)to.getX(), (float)to.getY());
+}
+
+// Extra points an anchor needs for the scanner to get round it. Smooth joins
+// don't need any, corners get at least extraPoints and more the sharper they are.
+static int getCornerDwell (const Anchor& before, const Anchor& at, const Anchor& after, int extraPoints)
+{
+    Point<float> p[4];
+    getSegmentPoints (before, at, p);
+    Point<float> in = BezierSampler::getEndDirection (p[0], p[1], p[2], p[3]);
+    getSegmentPoints (at, after, p);
+    Point<float> out = BezierSampler::getStartDirection (p[0], p[1], p[2], p[3]);
+    
+    if (in.isOrigin() || out.isOrigin())
+        return extraPoints;
+    
+    float turn = radiansToDegrees (std::acos (jlimit (-1.0f, 1.0f, in.getDotProduct (out))));
+    if (turn < 15.0f)
+        return 0;
+    
+    return jmax (extraPoints, roundToInt (turn / 30.0f));
+}
+
+void FrameEditor::generatePointsFromPath (const SketchRender& render, const IPath& path,
+                                          Array<Frame::IPoint>& points, BezierSampler& segment)
+{
+    if (path.isBlankMove())
+    {
+        generateBlankMove (render, path, points);
+        return;
+    }
+    
+    Anchor lastAnchor;
+    Frame::IPoint point;
+    zerostruct (point);
+    
+    bool closed = isClosedIPath (path);
+    int endA = path.getAnchorCount() - 1;
+    
+    // Blanked paths are spaced for the galvos to get across, not for looks
+    float tolerance = render.tolerance;
+    bool adaptive = tolerance > 0.0f && path.getColor() != Colours::black;
+    Array<float> distances;
+    
+    // Total length of path, zero rendered so far
+    float totalLength = path.getPath().getLength();
+    float rendered = 0.0f;
+    
+    // Z range
+    int startZ = path.getStartZ();
+    int endZ = path.getEndZ();
+    
+    for (auto i = 0; i <= endA; ++i)
+    {
+        Colour c = path.getColor();
         
-        for (auto i = 0; i <= endA; ++i)
+        Anchor newAnchor = path.getAnchor (i);
+
+        if (i == 0) // First anchor
+        {
+            anchorToPointXYZ (render.view, newAnchor, point, startZ, endZ, 0.0f);
+            point.red = point.green = point.blue = 0;
+            point.status = Frame::BlankedPoint;
+            
+            for (auto bb = 0; bb < path.getBlankedPointsBeforeStart(); ++bb)
+                points.add (point);
+            
+            point.red = c.getRed();
+            point.green = c.getGreen();
+            point.blue = c.getBlue();
+            point.status = c == Colours::black ? Frame::BlankedPoint : 0;
+            
+            for (auto es = 0; es < path.getExtraPointsAtStart(); ++es)
+                points.add (point);
+            
+            points.add (point);
+            
+            int extra = path.getExtraPointsPerAnchor();
+            if (adaptive && closed && endA > 1)
+                extra = getCornerDwell (path.getAnchor (endA - 1), newAnchor, path.getAnchor (1), extra);
+            
+            for (auto ea = 0; ea < extra; ++ea)
+                points.add (point);
+        }
+        else
         {
-            Colour c = paths[n].getColor();
+            // Put points (if needed) from the last anchor to this one
+            int exitX, exitY;
+            int entryX, entryY;
+
+            lastAnchor.getExitPosition (exitX, exitY);
+            newAnchor.getEntryPosition (entryX, entryY);
+            
+            segment.setSegment (Point<float> ((float)lastAnchor.getX(), (float)lastAnchor.getY()),
+                                Point<float> ((float)exitX, (float)exitY),
+                                Point<float> ((float)entryX, (float)entryY),
+                                Point<float> ((float)newAnchor.getX(), (float)newAnchor.getY()));
             
-            Anchor newAnchor = paths[n].getAnchor (i);
+            float plength = segment.getLength();
+            int density = path.getPointDensity();
 
-            if (i == 0) // First anchor
+            point.red = c.getRed();
+            point.green = c.getGreen();
+            point.blue = c.getBlue();
+            point.status = c == Colours::black ? Frame::BlankedPoint : 0;
+
+            if (adaptive)
             {
-                anchorToPointXYZ (newAnchor, point, startZ, endZ, 0.0f);
-                point.red = point.green = point.blue = 0;
-                point.status = Frame::BlankedPoint;
-                
-                for (auto bb = 0; bb < paths[n].getBlankedPointsBeforeStart(); ++bb)
-                    points.add (point);
-                
-                point.red = c.getRed();
-                point.green = c.getGreen();
-                point.blue = c.getBlue();
-                point.status = c == Colours::black ? Frame::BlankedPoint : 0;
-                
-                for (auto es = 0; es < paths[n].getExtraPointsAtStart(); ++es)
-                    points.add (point);
-                
-                points.add (point);
-                for (auto ea = 0; ea < paths[n].getExtraPointsPerAnchor(); ++ea)
+                // Spacing follows the curve, from a quarter of the density
+                // on tight bends to four times it on straight runs
+                segment.getAdaptiveDistances (tolerance, jmax (1.0f, density / 4.0f), density * 4.0f, distances);
+                for (auto distance : distances)
+                {
+                    Point<float>p = segment.getPointAlongSegment (distance);
+                    pointToIPointXYZ (render.view, p.toInt(), point, startZ, endZ,
+                                      (distance + rendered) / totalLength);
                     points.add (point);
+                }
             }
-            else
+            // At least one point required?
+            else if (plength > (float)density)
             {
-                // Put points (if needed) from the last anchor to this one
-                Path path;
-                path.startNewSubPath ((float)lastAnchor.getX(), (float)lastAnchor.getY());
-
-                int exitX, exitY;
-                int entryX, entryY;
-
-                lastAnchor.getExitPosition (exitX, exitY);
-                newAnchor.getEntryPosition (entryX, entryY);
-                        
-                path.cubicTo((float)exitX, (float)exitY, (float)entryX, (float)entryY, (float)newAnchor.getX(), (float)newAnchor.getY());
-                
-                float plength = path.getLength();
-                int density = paths[n].getPointDensity();
-
-                point.red = c.getRed();
-                point.green = c.getGreen();
-                point.blue = c.getBlue();
-                point.status = c == Colours::black ? Frame::BlankedPoint : 0;
-
-                // At least one point required?
-                if (plength > (float)density)
+                int len = (int)plength;
+                int pcount = len / density;
+                pcount--;   // Don't duplicate anchor
+                int offset = (len % density) / 2;
+                if (offset)
                 {
-                    int len = (int)plength;
-                    int pcount = len / density;
-                    pcount--;   // Don't duplicate anchor
-                    int offset = (len % density) / 2;
-                    if (offset)
-                    {
-                        pcount++;
-                        offset = (density / 2) - offset;
-                    }
-                    
-                    for (auto a = 1; a <= pcount; a++)
-                    {
-                        int distance = a * density - offset;
-                        Point<float>p = path.getPointAlongPath ((float)distance);
-                        pointToIPointXYZ (p.toInt(), point, startZ, endZ,
-                                          (distance + rendered) / totalLength);
-                        points.add (point);
-                    }
+                    pcount++;
+                    offset = (density / 2) - offset;
                 }
                 
-                rendered += plength;
-                
-                // Convert coordinates
-                anchorToPointXYZ (newAnchor, point, startZ, endZ, rendered / totalLength);
-                points.add (point);
-                if (i != endA || (! closed))
+                for (auto a = 1; a <= pcount; a++)
                 {
-                    for (auto ea = 0; ea < paths[n].getExtraPointsPerAnchor(); ++ea)
-                        points.add (point);
+                    int distance = a * density - offset;
+                    Point<float>p = segment.getPointAlongSegment ((float)distance);
+                    pointToIPointXYZ (render.view, p.toInt(), point, startZ, endZ,
+                                      (distance + rendered) / totalLength);
+                    points.add (point);
                 }
             }
             
-            lastAnchor = newAnchor;
-        }
-        
-        anchorToPointXYZ (lastAnchor, point, startZ, endZ, 1.0f);
-        for (auto ee = 0; ee < paths[n].getExtraPointsAtEnd(); ++ee)
+            rendered += plength;
+            
+            // Convert coordinates
+            anchorToPointXYZ (render.view, newAnchor, point, startZ, endZ, rendered / totalLength);
             points.add (point);
+            if (i != endA || (! closed))
+            {
+                int extra = path.getExtraPointsPerAnchor();
+                if (adaptive && i != endA)
+                    extra = getCornerDwell (lastAnchor, newAnchor, path.getAnchor (i + 1), extra);
+                
+                for (auto ea = 0; ea < extra; ++ea)
+                    points.add (point);
+            }
+        }
         
-        point.red = point.green = point.blue = 0;
-        point.status = Frame::BlankedPoint;
-        
-        for (auto ab = 0; ab < paths[n].getBlankedPointsAfterEnd(); ++ab)
-            points.add (point);
+        lastAnchor = newAnchor;
     }
+    
+    anchorToPointXYZ (render.view, lastAnchor, point, startZ, endZ, 1.0f);
+    for (auto ee = 0; ee < path.getExtraPointsAtEnd(); ++ee)
+        points.add (point);
+    
+    point.red = point.green = point.blue = 0;
+    point.status = Frame::BlankedPoint;
+    
+    for (auto ab = 0; ab < path.getBlankedPointsAfterEnd(); ++ab)
+        points.add (point);
+}
+
+// Blanked jump from the end of one path to the start of the next
+static IPath makeBlankMove (const IPath& from, const IPath& to)
+{
+    const Anchor& a = from.getAnchor (from.getAnchorCount() - 1);
+    const Anchor& b = to.getAnchor (0);
+    
+    IPath blankPath;
+    blankPath.setColor (Colours::black);
+    blankPath.setBlankMove (true);
+    blankPath.setBlankedPointsBeforeStart (0);
+    blankPath.setBlankedPointsAfterEnd (0);
+    // Same spot with only Z to move still gets two anchors, the profile
+    // runs over the Z gap instead
+    blankPath.addAnchor (Anchor (a.getX(), a.getY()));
+    blankPath.addAnchor (Anchor (b.getX(), b.getY()));
+    blankPath.setStartZ (from.getEndZ());
+    blankPath.setEndZ (to.getStartZ());
+    return blankPath;
+}
+
+static bool needsBlankMove (const IPath& from, const IPath& to)
+{
+    const Anchor& a = from.getAnchor (from.getAnchorCount() - 1);
+    const Anchor& b = to.getAnchor (0);
+    
+    return a.getX() != b.getX() || a.getY() != b.getY()
+        || from.getEndZ() != to.getStartZ();
 }
 
 void FrameEditor::connectIPaths (const Array<IPath>& src, Array<IPath>& dst)
@@ -1717,100 +1969,43 @@ void FrameEditor::connectIPaths (const Array<IPath>& src, Array<IPath>& dst)
     if (! src.size())
         return;
     
-    IPath lastPath;
-    IPath newPath;
-    
     // Build connecting blanked paths
     for (auto n = 0; n < src.size(); ++n)
     {
-        newPath = src[n];
-        if (n != 0)
-        {
-            Anchor lastA = lastPath.getAnchor (lastPath.getAnchorCount() -1);
-            Anchor newA = newPath.getAnchor (0);
-            
-            if (lastA.getX() != newA.getX() || lastA.getY() != newA.getY())
-            {
-                IPath blankPath;
-                blankPath.setColor (Colours::black);
-                blankPath.setPointDensity (blankPointSpacing);
-                blankPath.setBlankedPointsBeforeStart (0);
-                blankPath.setBlankedPointsAfterEnd (0);
-                blankPath.addAnchor (Anchor (lastA.getX(), lastA.getY()));
-                blankPath.addAnchor (Anchor (newA.getX(), newA.getY()));
-                blankPath.setStartZ (lastPath.getEndZ());
-                blankPath.setEndZ (newPath.getStartZ());
-                dst.add (blankPath);
-            }
-            else if (lastPath.getEndZ() != newPath.getStartZ())
-            {
-                // Handle overlapped points with diferent Z's differently
-                // Just insert anchors based on the Z gap
-                // But we have to zig zag them so that we have a distance to spread
-                // out Z on
-                IPath blankPath;
-                blankPath.setColor (Colours::black);
-                blankPath.setPointDensity (blankPointSpacing);
-                blankPath.setBlankedPointsBeforeStart (0);
-                blankPath.setBlankedPointsAfterEnd (0);
-                blankPath.addAnchor (Anchor (lastA.getX(), lastA.getY()));
-                int zcnt = abs (lastPath.getEndZ() - newPath.getStartZ()) / blankPointSpacing;
-                for (auto i = 0; i < zcnt; ++i)
-                {
-                    if (n & i)
-                        blankPath.addAnchor (Anchor (lastA.getX() -2, lastA.getY() -2));
-                    else
-                        blankPath.addAnchor (Anchor (lastA.getX() +2, lastA.getY() +2));
-                }
-                blankPath.addAnchor (Anchor (newA.getX(), newA.getY()));
-                blankPath.setStartZ (lastPath.getEndZ());
-                blankPath.setEndZ (newPath.getStartZ());
-                dst.add (blankPath);
-            }
-        }
-        dst.add (newPath);
-        lastPath = newPath;
-    }
-    
-    Anchor startA = dst[0].getAnchor (0);
-    Anchor endA = dst[dst.size() - 1].getAnchor (dst[dst.size() - 1].getAnchorCount() - 1);
-    if (startA.getX() != endA.getX() || startA.getY() != endA.getY())
-    {
-        IPath returnPath;
-        returnPath.setColor (Colours::black);
-        returnPath.setPointDensity (blankPointSpacing);
-        returnPath.setBlankedPointsBeforeStart (0);
-        returnPath.setBlankedPointsAfterEnd (0);
-        returnPath.addAnchor (Anchor (endA.getX(), endA.getY()));
-        returnPath.addAnchor (Anchor (startA.getX(), startA.getY()));
-        returnPath.setStartZ (dst[dst.size() - 1].getEndZ());
-        returnPath.setEndZ (dst[0].getStartZ());
-        dst.add (returnPath);
-    }
-    else if (dst[0].getStartZ() != dst[dst.size() -1].getEndZ())
-    {
-        // Handle overlapped points with diferent Z's differently
-        // Just insert anchors based on the Z gap
-        // But we have to zig zag them so that we have a distance to spread
-        // out Z on
-        IPath returnPath;
-        returnPath.setColor (Colours::black);
-        returnPath.setPointDensity (blankPointSpacing);
-        returnPath.setBlankedPointsBeforeStart (0);
-        returnPath.setBlankedPointsAfterEnd (0);
-        returnPath.addAnchor (Anchor (endA.getX(), endA.getY()));
-        int zcnt = abs (dst[dst.size() - 1].getEndZ() - dst[0].getStartZ()) / blankPointSpacing;
-        for (auto n = 0; n < zcnt; ++n)
-        {
-            if (n & 1)
-                returnPath.addAnchor (Anchor (endA.getX() -2, endA.getY() -2));
-            else
-                returnPath.addAnchor (Anchor (endA.getX() +2, endA.getY() +2));
-        }
-        returnPath.addAnchor (Anchor (startA.getX(), startA.getY()));
-        returnPath.setStartZ (dst[dst.size() - 1].getEndZ());
-        returnPath.setEndZ (dst[0].getStartZ());
-        dst.add (returnPath);
+        if (n != 0 && needsBlankMove (src.getReference (n - 1), src.getReference (n)))
+            dst.add (makeBlankMove (src.getReference (n - 1), src.getReference (n)));
+        
+        dst.add (src.getReference (n));
+    }
+    
+    // And back to the start
+    if (needsBlankMove (src.getLast(), src.getFirst()))
+        dst.add (makeBlankMove (src.getLast(), src.getFirst()));
+}
+
+void FrameEditor::generateBlankMove (const SketchRender& render, const IPath& path, Array<Frame::IPoint>& points)
+{
+    const Anchor& a = path.getAnchor (0);
+    const Anchor& b = path.getAnchor (path.getAnchorCount() - 1);
+    Point<float> start ((float)a.getX(), (float)a.getY());
+    Point<float> end ((float)b.getX(), (float)b.getY());
+    
+    float distance = BlankMove::getMoveLength (start.toInt(), path.getStartZ(),
+                                               end.toInt(), path.getEndZ());
+    
+    Array<float> fractions;
+    render.blankMove.getFractions (distance, fractions);
+    
+    Frame::IPoint point;
+    zerostruct (point);
+    point.status = Frame::BlankedPoint;
+    
+    // Only the points in between, the ends belong to the paths either side
+    for (auto f : fractions)
+    {
+        Point<float> p = start + (end - start) * f;
+        pointToIPointXYZ (render.view, p.roundToInt(), point, path.getStartZ(), path.getEndZ(), f);
+        points.add (point);
     }
 }
 
@@ -1822,14 +2017,84 @@ void FrameEditor::renderSketch (bool shortestPath, bool updateSketch)
     Array<Frame::IPoint> points;
     Array<IPath> sorted;
     Array<IPath> paths;
+    SketchRender render = getSketchRender();
+    BlankPointCost cost (render.blankMove);
+    int saved = 0;
 
     if (shortestPath)
-        ShortestPath::find (currentFrame->getIPaths(), sorted);
+    {
+        ShortestPath::find (currentFrame->getIPaths(), sorted, cost);
+        saved = ShortestPath::getTourCost (currentFrame->getIPaths(), cost)
+                - ShortestPath::getTourCost (sorted, cost);
+    }
     else
         sorted = currentFrame->getIPaths();
     
     connectIPaths (sorted, paths);
-    generatePointsFromPaths (paths, points);
+    sketchCache.resetStats();
+    Array<int> runSizes;
+    generatePointsFromPaths (render, paths, points, false, &runSizes);
+    
+    renderReport = "Frame " + String (frameIndex + 1) + ": "
+                   + String (points.size()) + " points";
+    if (shortestPath && points.size())
+    {
+        renderReport << ", " << saved << " blanked points saved ("
+                     << String ((float)scanRate / (float)(points.size() + saved), 1) << " to "
+                     << String ((float)scanRate / (float)points.size(), 1) << " fps)";
+    }
+    
+    renderReport << "\n" << sketchCache.getHits() << " of " << paths.size() << " paths reused";
+    
+    // Where adaptive spacing put the points, per path in scan order,
+    // straight from the runs that were just rendered
+    renderPathReport.clear();
+    if (adaptiveTolerance > 0.0f)
+    {
+        int pathTotal = 0;
+        int moveTotal = 0;
+        int pathNumber = 0;
+        for (auto n = 0; n < paths.size(); ++n)
+        {
+            if (paths.getReference (n).isBlankMove())
+            {
+                moveTotal += runSizes[n];
+                continue;
+            }
+            
+            pathTotal += runSizes[n];
+            renderPathReport << "Path " << ++pathNumber << ": " << runSizes[n] << " points\n";
+        }
+        
+        renderReport << "\nAdaptive spacing: " << pathTotal << " path, "
+                     << moveTotal << " blank move points";
+    }
+    
+    lastOperationName = "Render Sketch Layer";
+    // Kept with today's settings and no cache, it runs on worker threads
+    // and may outlive anything the editor has now
+    render.cache = nullptr;
+    lastOperation = [render, shortestPath, updateSketch] (Array<Frame::IPoint>& framePoints,
+                                                          Array<IPath>& framePaths)
+    {
+        if (! framePaths.size())
+            return false;
+        
+        Array<IPath> frameSorted;
+        Array<IPath> frameConnected;
+        
+        if (shortestPath)
+            ShortestPath::find (framePaths, frameSorted, BlankPointCost (render.blankMove));
+        else
+            frameSorted = framePaths;
+        
+        connectIPaths (frameSorted, frameConnected);
+        generatePointsFromPaths (render, frameConnected, framePoints);
+        if (updateSketch)
+            framePaths.swapWith (frameConnected);
+        
+        return true;
+    };
     
     beginNewTransaction ("Render Sketch Layer");
     if (updateSketch)
@@ -2330,589 +2595,233 @@ void FrameEditor::startTransform (const String& name)
     }
     
     transformName = name;
+    transformOperation = nullptr;
     transformUsed = false;
     tranformInProgress = true;
-    sendActionMessage (EditorActions::transformStarted);
+    post (EditorActions::transformStarted);
 }
 
-bool FrameEditor::scaleIldaSelected (float xScale,
-                                     float yScale,
-                                     float zScale,
-                                     bool centerOnSelection,
-                                     bool constrain)
+bool FrameEditor::transformIldaSelected (const IldaKernel& kernel, bool constrain)
 {
-    Array<Frame::IPoint> points = transformPoints;
-    if (! points.size())
+    if (! transformPoints.size())
         return false;
-  
-    int xOffset = 0;
-    int yOffset = 0;
-    int zOffset = 0;
-    
-    if (centerOnSelection)
-    {
-        xOffset = transformCenterX;
-        yOffset = transformCenterY;
-        zOffset = transformCenterZ;
-    }
-    
-    bool clipped = false;
     
-    for (auto n = 0; n < points.size(); ++n)
+    if (previewCoalescing)
     {
-        Frame::IPoint& point = points.getReference (n);
-
-        int x = point.x.w;
-        x -= xOffset;
-        x = (int)((float)x * xScale + 0.5f);
-        x += xOffset;
-        if (Frame::clipIlda (x))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.x.w = (int16)x;
+        // Only the latest request matters, it gets evaluated as soon as the
+        // pool is free and published on the next display frame. Clipping
+        // isn't known yet, publishPreview drops clipped results, so true
+        // here only means the request was taken.
+        pendingKernel = kernel;
+        pendingConstrain = constrain;
+        hasPendingPreview = true;
         
-        int y = point.y.w;
-        y -= yOffset;
-        y = (int)((float)y * yScale + 0.5f);
-        y += yOffset;
-        if (Frame::clipIlda (y))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.y.w = (int16)y;
+        if (previewJob == nullptr)
+            startPreviewJob();
         
-        int z = point.z.w;
-        z -= zOffset;
-        z = (int)((float)z * zScale + 0.5f);
-        z += zOffset;
-        if (Frame::clipIlda (z))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.z.w = (int16)z;
+        if (! isTimerRunning())
+            startTimerHz (60);
+        
+        return true;
     }
     
-    if (constrain && clipped)
-        return false;
+    PreviewJob job (kernel, constrain);
+    job.points = transformPoints;
+    job.x = transformCenterX;
+    job.y = transformCenterY;
+    job.z = transformCenterZ;
+    job.run();
+    return publishPreview (job);
+}
 
-    transformUsed = true;
-    _setIldaPoints (ildaSelection, points);
-    return true;
+void FrameEditor::setPreviewCoalescing (bool coalesce)
+{
+    flushPreview();
+    previewCoalescing = coalesce;
 }
 
-static void Multiply3by3(double in1[3][3], double in2[3][3], double out[3][3])
+void FrameEditor::startPreviewJob()
 {
-    for (int col = 0 ; col < 3; ++col)
-    {
-        for (int row = 0; row < 3; ++row)
-        {
-            double d = 0;
-            d += in1[row][0] * in2[0][col];
-            d += in1[row][1] * in2[1][col];
-            d += in1[row][2] * in2[2][col];
-            out[row][col] = d;
-        }
-    }
-}
-
-bool FrameEditor::rotateIldaSelected (float xAngle,
-                                      float yAngle,
-                                      float zAngle,
-                                      bool centerOnSelection,
-                                      bool constrain)
-{
-    Array<Frame::IPoint> points = transformPoints;
-    if (! points.size())
-        return false;
-  
-    int xOffset = 0;
-    int yOffset = 0;
-    int zOffset = 0;
-    
-    if (centerOnSelection)
-    {
-        xOffset = transformCenterX;
-        yOffset = transformCenterY;
-        zOffset = transformCenterZ;
-    }
-    
-    bool clipped = false;
-    
-    // Build our rotation matrices
-    double rx[3][3] = {{1, 0, 0},
-                       {0, 1, 0},
-                       {0, 0, 1}};
-    double ry[3][3] = {{1, 0, 0},
-                       {0, 1, 0},
-                       {0, 0, 1}};
-    double rz[3][3] = {{1, 0, 0},
-                       {0, 1, 0},
-                       {0, 0, 1}};
-
-    double rotX = xAngle < 0 ? 360.0 + xAngle : xAngle;
-    double rotY = yAngle < 0 ? 360.0 + yAngle : yAngle;
-    double rotZ = zAngle < 0 ? 360.0 + zAngle : zAngle;
+    previewJob = std::make_shared<PreviewJob> (pendingKernel, pendingConstrain);
+    previewJob->points = transformPoints;
+    previewJob->x = transformCenterX;
+    previewJob->y = transformCenterY;
+    previewJob->z = transformCenterZ;
+    hasPendingPreview = false;
     
-    // Clip X rotation
-    if (rotX > 359.9)
-        rotX = 0.0;
-
-    // Get sin and cos
-    const double pi = MathConstants<double>::pi;
-    double sin = ::sin (rotX * pi / 180.0);
-    double cos = ::cos (rotX * pi / 180.0);
-
-    rx[1][1] = cos;
-    rx[2][2] = cos;
-    rx[1][2] = sin;
-    rx[2][1] = 0 - sin;
-
-    // Repeat for Y
-    if (rotY > 359.9)
-        rotY = 0.0;
-
-    sin = ::sin (rotY * pi / 180.0);
-    cos = ::cos (rotY * pi / 180.0);
-
-    ry[0][0] = cos;
-    ry[2][2] = cos;
-    ry[2][0] = sin;
-    ry[0][2] = 0 - sin;
-
-    // And Z
-    if (rotZ > 359.9)
-        rotZ = 0.0;
-
-    sin = ::sin (rotZ * pi / 180.0);
-    cos = ::cos (rotZ * pi / 180.0);
-
-    rz[0][0] = cos;
-    rz[1][1] = cos;
-    rz[0][1] = 0 - sin;
-    rz[1][0] = sin;
-
-    double out1[3][3];
-    Multiply3by3(rx, ry, out1);
-    double out2[3][3];
-    Multiply3by3(out1, rz, out2);
-
-    for (auto n = 0; n < points.size(); ++n)
-    {
-        double d;
-        double dx, dy, dz;
-        
-        Frame::IPoint& point = points.getReference (n);
-
-        dx = point.x.w - xOffset;
-        dy = point.y.w - yOffset;
-        dz = point.z.w - zOffset;
-        
-        d = dx * out2[0][0] + dy * out2[1][0] + dz * out2[2][0];
-        int x = (int)d;
-        x += xOffset;
-        if (Frame::clipIlda (x))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.x.w = (int16)x;
-       
-        d = dx * out2[0][1] + dy * out2[1][1] + dz * out2[2][1];
-        int y = (int)d;
-        y += yOffset;
-        if (Frame::clipIlda (y))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.y.w = (int16)y;
-
-        d = dx * out2[0][2] + dy * out2[1][2] + dz * out2[2][2];
-        int z = (int)d;
-        z += zOffset;
-        if (Frame::clipIlda (z))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.z.w = (int16)z;
-    }
-    
-    if (constrain && clipped)
-        return false;
-
-    transformUsed = true;
-    _setIldaPoints (ildaSelection, points);
-    return true;
+    std::shared_ptr<PreviewJob> job = previewJob;
+    workerPool->addJob ([job] { job->run(); });
 }
 
-bool FrameEditor::shearIldaSelected (float xShear,
-                                     float yShear,
-                                     bool centerOnSelection,
-                                     bool constrain)
+bool FrameEditor::publishPreview (PreviewJob& job)
 {
-    Array<Frame::IPoint> points = transformPoints;
-    if (! points.size())
+    if (job.constrain && job.clipped)
         return false;
-  
-    int xOffset = 0;
-    int yOffset = 0;
     
-    if (centerOnSelection)
+    // Same kernel again for frame batches, there the whole
+    // frame is the selection
+    IldaKernel kernel = job.kernel;
+    bool constrain = job.constrain;
+    transformOperation = [kernel, constrain] (Array<Frame::IPoint>& framePoints, Array<IPath>&)
     {
-        xOffset = transformCenterX;
-        yOffset = transformCenterY;
-    }
-    
-    AffineTransform matrix = AffineTransform::shear (xShear, yShear);
-    bool clipped = false;
-
-    for (auto n = 0; n < points.size(); ++n)
-    {
-        Frame::IPoint& point = points.getReference (n);
-
-        int x = activeView == Frame::left ? point.z.w : point.x.w;
-        x -= xOffset;
-        int y = activeView == Frame::bottom ? point.z.w : point.y.w;
-        y -= yOffset;
-
-        matrix.transformPoint(x,y);
+        if (! framePoints.size())
+            return false;
         
-        x += xOffset;
-        y += yOffset;
+        int16 x, y, z;
+        IldaTransforms::getCenter (framePoints, x, y, z);
         
-        if (Frame::clipIlda (x))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        if (activeView == Frame::left)
-            point.z.w = (int16)x;
-        else
-            point.x.w = (int16)x;
+        Array<Frame::IPoint> result = framePoints;
+        if (kernel (result, x, y, z) && constrain)
+            return false;
         
-        if (Frame::clipIlda (y))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        if (activeView == Frame::bottom)
-            point.z.w = (int16)y;
-        else
-            point.y.w = (int16)y;        
-    }
-    
-    if (constrain && clipped)
-        return false;
+        framePoints.swapWith (result);
+        return true;
+    };
 
     transformUsed = true;
-    _setIldaPoints (ildaSelection, points);
+    _setIldaPoints (ildaSelection, job.points);
     return true;
 }
 
-bool FrameEditor::translateIldaSelected (int xOffset,
-                                         int yOffset,
-                                         int zOffset,
-                                         bool constrain)
+void FrameEditor::timerCallback()
 {
-    Array<Frame::IPoint> points = transformPoints;
-    if (! points.size())
-        return false;
-
-    bool clipped = false;
-    
-    for (auto n = 0; n < points.size(); ++n)
+    if (previewJob != nullptr && previewJob->done.wait (0))
     {
-        Frame::IPoint& point = points.getReference (n);
-
-        int x = point.x.w;
-        x += xOffset;
-        if (Frame::clipIlda (x))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.x.w = (int16)x;
+        publishPreview (*previewJob);
+        previewJob = nullptr;
         
-        int y = point.y.w;
-        y += yOffset;
-        if (Frame::clipIlda (y))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.y.w = (int16)y;
-        
-        int z = point.z.w;
-        z += zOffset;
-        if (Frame::clipIlda (z))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.z.w = (int16)z;
+        if (hasPendingPreview)
+            startPreviewJob();
     }
     
-    if (constrain && clipped)
-        return false;
-
-    transformUsed = true;
-    _setIldaPoints (ildaSelection, points);
-    return true;
+    if (previewJob == nullptr && ! hasPendingPreview)
+        stopTimer();
 }
 
-bool FrameEditor::barberPoleIldaSelected (float radius,
-                                          float skew,
-                                          float zAngle,
-                                          bool centerOnSelection,
-                                          bool constrain)
+void FrameEditor::flushPreview()
 {
-    Array<Frame::IPoint> points = transformPoints;
-    if (! points.size())
-        return false;
-
-    int xOffset = 0;
-    int yOffset = 0;
+    stopTimer();
     
-    if (centerOnSelection)
+    if (previewJob != nullptr)
     {
-        xOffset = transformCenterX;
-        yOffset = transformCenterY;
+        previewJob->done.wait();
+        if (! hasPendingPreview)
+            publishPreview (*previewJob);
+        previewJob = nullptr;
     }
-
-    double rz[3][3] = {{1, 0, 0},
-                       {0, 1, 0},
-                       {0, 0, 1}};
-
-    double rotZ = zAngle < 0 ? 360.0 + zAngle : zAngle;
     
-    // Clip X rotation
-    if (rotZ > 359.9)
-        rotZ = 0.0;
-
-    // Get sin and cos
-    const double pi = MathConstants<double>::pi;
-    double sin = ::sin (rotZ * pi / 180.0);
-    double cos = ::cos (rotZ * pi / 180.0);
-
-    rz[0][0] = cos;
-    rz[2][2] = cos;
-    rz[2][0] = sin;
-    rz[0][2] = 0 - sin;
-
-    AffineTransform matrix = AffineTransform::shear (0, skew);
-
-    double rad = (double)radius;
-    double theta = 1.0 / rad; // (2.0 * pi) / (2.0 * pi * rad);
-    bool clipped = false;
-    
-    for (auto n = 0; n < points.size(); ++n)
+    if (hasPendingPreview)
     {
-        Frame::IPoint& point = points.getReference (n);
-
-        // fetch next point
-        int x = point.x.w;
-        x -= xOffset;
-        int y = point.y.w;
-        y -= yOffset;
-
-        // skew
-        matrix.transformPoint(x,y);
-                
-        // wrap
-        double dx = 0 - ::cos ((double)x * theta) * rad;
-        double dy = (double)y;
-        double dz = ::sin ((double)x * theta) * rad;
-
-        // rotate
-        double d;
-        d = dx * rz[0][0] + dy * rz[1][0] + dz * rz[2][0];
-        x = (int)d;
-        x += xOffset;
-        if (Frame::clipIlda (x))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.x.w = (int16)x;
-
-        d = dx * rz[0][1] + dy * rz[1][1] + dz * rz[2][1];
-        y = (int)d;
-        y += yOffset;
-        if (Frame::clipIlda (y))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.y.w = (int16)y;
-
-        d = dx * rz[0][2] + dy * rz[1][2] + dz * rz[2][2];
-        int z = (int)d;
-        if (Frame::clipIlda (z))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.z.w = (int16)z;
+        hasPendingPreview = false;
+        
+        PreviewJob job (pendingKernel, pendingConstrain);
+        job.points = transformPoints;
+        job.x = transformCenterX;
+        job.y = transformCenterY;
+        job.z = transformCenterZ;
+        job.run();
+        publishPreview (job);
     }
-    
-    if (constrain && clipped)
-        return false;
-
-    transformUsed = true;
-    _setIldaPoints (ildaSelection, points);
-    return true;
 }
 
-bool FrameEditor::bulgeIldaSelected (float radius,
-                                     float gain,
+bool FrameEditor::scaleIldaSelected (float xScale,
+                                     float yScale,
+                                     float zScale,
                                      bool centerOnSelection,
                                      bool constrain)
 {
-    Array<Frame::IPoint> points = transformPoints;
-    if (! points.size())
-        return false;
-
-    int xOffset = 0;
-    int yOffset = 0;
-    
-    if (centerOnSelection)
-    {
-        xOffset = transformCenterX;
-        yOffset = transformCenterY;
-    }
-
-    double dgain = gain;
-    
-    bool clipped = false;
-    
-    for (auto n = 0; n < points.size(); ++n)
+    return transformIldaSelected ([=] (Array<Frame::IPoint>& points, int16 x, int16 y, int16 z)
     {
-        Frame::IPoint& point = points.getReference (n);
-
-        // fetch next point
-        int x = point.x.w;
-        x -= xOffset;
-        int y = point.y.w;
-        y -= yOffset;
-
-        double dx = x;
-        double dy = y;
-        
-        // Distance
-        double r = ::sqrt ((dx * dx) + (dy * dy));
-        // Angle
-        double a = atan2 (dy, dx);
+        if (! centerOnSelection)
+            x = y = z = 0;
         
-        double pow = 1.0 + (double)radius; // 0.01 to 1.99
-        double rn = ::pow (r, pow);
-        double d;
-        
-        d = cos(a) * rn;    // adjusted X
-        d *= dgain;
-        x = (int)d;
-        x += xOffset;
-        if (Frame::clipIlda (x))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.x.w = (int16)x;
-
-        d = sin(a) * rn;    // Adjusted Y
-        d *= dgain;
-        y = (int)d;
-        y += yOffset;
-        if (Frame::clipIlda (y))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.y.w = (int16)y;
-    }
-    
-    if (constrain && clipped)
-        return false;
-
-    transformUsed = true;
-    _setIldaPoints (ildaSelection, points);
-    return true;
+        return IldaTransforms::scale (points, x, y, z, xScale, yScale, zScale);
+    }, constrain);
 }
 
-bool FrameEditor::spiralIldaSelected (float angle,
-                                      int eSize,
+bool FrameEditor::rotateIldaSelected (float xAngle,
+                                      float yAngle,
+                                      float zAngle,
                                       bool centerOnSelection,
                                       bool constrain)
 {
-    Array<Frame::IPoint> points = transformPoints;
-    if (! points.size())
-        return false;
-
-    int xOffset = 0;
-    int yOffset = 0;
-    
-    if (centerOnSelection)
+    return transformIldaSelected ([=] (Array<Frame::IPoint>& points, int16 x, int16 y, int16 z)
     {
-        xOffset = transformCenterX;
-        yOffset = transformCenterY;
-    }
-    
-    double a = (double)angle;
-    double b = (double)eSize;
-    b *= b;
-    
-    bool clipped = false;
+        if (! centerOnSelection)
+            x = y = z = 0;
+        
+        return IldaTransforms::rotate (points, x, y, z, xAngle, yAngle, zAngle);
+    }, constrain);
+}
+
+bool FrameEditor::shearIldaSelected (float xShear,
+                                     float yShear,
+                                     bool centerOnSelection,
+                                     bool constrain)
+{
+    View view = activeView;
     
-    for (auto n = 0; n < points.size(); ++n)
+    return transformIldaSelected ([=] (Array<Frame::IPoint>& points, int16 x, int16 y, int16)
     {
-        Frame::IPoint& point = points.getReference (n);
-        double dx = point.x.w - xOffset;
-        double dy = point.y.w - yOffset;
-        double dist = (dx * dx + dy * dy) / b;
-        double edist = ::exp (-dist);
-        double rad = a * edist;
-        double d;
-        
-        d = cos(rad) * dx + sin(rad) * dy;
-        int x = (int)d;
-        x += xOffset;
-        if (Frame::clipIlda (x))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.x.w = (int16)x;
-
-        d = -sin(rad) * dx + cos(rad) * dy;
-        int y = (int)d;
-        y += yOffset;
-        if (Frame::clipIlda (y))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.y.w = (int16)y;
+        if (! centerOnSelection)
+            x = y = 0;
         
-        double es = (double)eSize;
-        es = (edist * es);
-        double ez = (double)point.z.w;
-        ez -= (es / 2.0);
-        int z = (int)ez;
-        Frame::clipIlda (z);
+        return IldaTransforms::shear (points, view, x, y, xShear, yShear);
+    }, constrain);
+}
+
+bool FrameEditor::translateIldaSelected (int xOffset,
+                                         int yOffset,
+                                         int zOffset,
+                                         bool constrain)
+{
+    return transformIldaSelected ([=] (Array<Frame::IPoint>& points, int16, int16, int16)
+    {
+        return IldaTransforms::translate (points, xOffset, yOffset, zOffset);
+    }, constrain);
+}
+
+bool FrameEditor::barberPoleIldaSelected (float radius,
+                                          float skew,
+                                          float zAngle,
+                                          bool centerOnSelection,
+                                          bool constrain)
+{
+    return transformIldaSelected ([=] (Array<Frame::IPoint>& points, int16 x, int16 y, int16)
+    {
+        if (! centerOnSelection)
+            x = y = 0;
         
-        point.z.w = (int16)z;
-    }
+        return IldaTransforms::barberPole (points, x, y, radius, skew, zAngle);
+    }, constrain);
+}
 
-    if (constrain && clipped)
-        return false;
+bool FrameEditor::bulgeIldaSelected (float radius,
+                                     float gain,
+                                     bool centerOnSelection,
+                                     bool constrain)
+{
+    return transformIldaSelected ([=] (Array<Frame::IPoint>& points, int16 x, int16 y, int16)
+    {
+        if (! centerOnSelection)
+            x = y = 0;
+        
+        return IldaTransforms::bulge (points, x, y, radius, gain);
+    }, constrain);
+}
 
-    transformUsed = true;
-    _setIldaPoints (ildaSelection, points);
-    return true;
+bool FrameEditor::spiralIldaSelected (float angle,
+                                      int eSize,
+                                      bool centerOnSelection,
+                                      bool constrain)
+{
+    return transformIldaSelected ([=] (Array<Frame::IPoint>& points, int16 x, int16 y, int16)
+    {
+        if (! centerOnSelection)
+            x = y = 0;
+        
+        return IldaTransforms::spiral (points, x, y, angle, eSize);
+    }, constrain);
 }
 
 bool FrameEditor::sphereIldaSelected (double xScale,
@@ -2921,70 +2830,13 @@ bool FrameEditor::sphereIldaSelected (double xScale,
                                       bool centerOnSelection,
                                       bool constrain)
 {
-    Array<Frame::IPoint> points = transformPoints;
-    if (! points.size())
-        return false;
-
-    int xOffset = 0;
-    int yOffset = 0;
-    
-    if (centerOnSelection)
-    {
-        xOffset = transformCenterX;
-        yOffset = transformCenterY;
-    }
-    
-    const double pi = MathConstants<double>::pi;
-    double xrad = (2.0 * pi) / 65536.0;
-    double yrad = pi / 65536.0;
-    double r = 65536.0 / (2.0 * pi);
-    r *= rScale;
-    
-    bool clipped = false;
-
-    for (auto n = 0; n < points.size(); ++n)
+    return transformIldaSelected ([=] (Array<Frame::IPoint>& points, int16 x, int16 y, int16)
     {
-        Frame::IPoint& point = points.getReference (n);
-        double dx = point.x.w - xOffset;
-        double dy = point.y.w - yOffset;
-        double d;
-        
-        d = r * ::sin (dx * xScale * xrad) * ::sin ((32767.0 - (dy * yScale)) * yrad);
-        int x = (int)d;
-        x += xOffset;
-        if (Frame::clipIlda (x))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.x.w = (int16)x;
-
-        d = r * ::cos ((32767.0 - (dy * yScale)) * yrad);
-        int y = (int)d;
-        y += yOffset;
-        if (Frame::clipIlda (y))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.y.w = (int16)y;
+        if (! centerOnSelection)
+            x = y = 0;
         
-        d = r * ::sin ((32767.0 - (dy * yScale)) * yrad) * ::cos (dx * xScale * xrad);
-        int z = (int)d;
-        if (Frame::clipIlda (z))
-        {
-            Frame::blankPoint (point);
-            clipped = true;
-        }
-        point.z.w = (int16)z;
-    }
-    
-    if (constrain && clipped)
-        return false;
-
-    transformUsed = true;
-    _setIldaPoints (ildaSelection, points);
-    return true;
+        return IldaTransforms::sphere (points, x, y, xScale, yScale, rScale);
+    }, constrain);
 }
 
 bool FrameEditor::gradientIldaSelected (const Colour& color1,
@@ -2995,124 +2847,35 @@ bool FrameEditor::gradientIldaSelected (const Colour& color1,
                                         bool centerOnSelection,
                                         const Colour& color3)
 {
-    Array<Frame::IPoint> points = transformPoints;
-    if (! points.size())
-        return false;
-
-    // We work this one in component space, since nothing is moving
-    int xOffset = 32768;
-    int yOffset = 32768;
-    
-    if (centerOnSelection)
-        getComponentCenterOfIldaSelection (xOffset, yOffset);
-
-    Point<float> center = Point<float> ((float)xOffset, (float)yOffset);
-    
-    float flength = length * 32768.0f / 100.0f;
-    double rot = angle < 0 ? 360.0 + angle : angle;
-    
-    // Clip rotation
-    if (rot > 359.9)
-        rot = 0.0;
-
-    // Convert to radians
-    const double pi = MathConstants<double>::pi;
-    float ang = (float)(rot * pi / 180.0);
-
-    // Build our line
-    Line<float> l1 = Line<float>::fromStartAndAngle (center, flength, ang);
-    Line<float> l2 = Line<float>::fromStartAndAngle (center, -flength, ang);
-    Line<float> line = Line<float>(l1.getEnd(), l2.getEnd());
-
-    // Make a color gradient
-    ColourGradient cg;
-    if (radial)
-        cg = ColourGradient(color1, 32768.0f, 32768.0f, color2, 32768.0f, 32768.0f - flength, true);
-    else
-        cg = ColourGradient (color1, line.getStartX(), line.getStartY(), color2, line.getEndX(), line.getEndY(), false);
-    
-    if (color3.isOpaque())
-        cg.addColour (0.5, color3);
+    View view = activeView;
     
-    // Walk the selected points
-    for (auto n = 0; n < points.size(); ++n)
+    // We work this one in component space, since nothing is moving
+    return transformIldaSelected ([=] (Array<Frame::IPoint>& points, int16 x, int16 y, int16 z)
     {
-        Frame::IPoint& point = points.getReference (n);
-
-        int x = Frame::getCompXInt (point, activeView);
-        int y = Frame::getCompYInt (point, activeView);
-                
-        float proportion = 0.0;
+        int xCenter = 32768;
+        int yCenter = 32768;
         
-        if (radial)
+        if (centerOnSelection)
         {
-            Line<float> l(center.getX(), center.getY(), (float)x, (float)y);
-            proportion = flength / l.getLength();
+            xCenter = Frame::toCompX (view == Frame::left ? z : x);
+            yCenter = Frame::toCompY (view == Frame::bottom ? z : y);
         }
-        else
-            proportion = line.findNearestProportionalPositionTo (Point<float> ((float)x, (float)y));
 
-        if (proportion < 0.0f)
-            proportion = 0.0f;
-        else if (proportion > 1.0f)
-            proportion = 1.0f;
-        
-        Colour c = cg.getColourAtPosition ((double)proportion);
-        point.red = c.getRed();
-        point.green = c.getGreen();
-        point.blue = c.getBlue();
-        
-        if (c == Colours::black)
-            point.status = Frame::BlankedPoint;
-        else
-            point.status = 0;
-    }
-    
-    transformUsed = true;
-    _setIldaPoints (ildaSelection, points);
-    return true;
+        IldaTransforms::gradient (points, view, xCenter, yCenter,
+                                  color1, color2, angle, length, radial, color3);
+        return false;
+    });
 }
 
 bool FrameEditor::adjustHueIldaSelected (float hshift,
                                          float saturation,
                                          float brightness)
 {
-    Array<Frame::IPoint> points = transformPoints;
-    if (! points.size())
-        return false;
-
-    for (auto n = 0; n < points.size(); ++n)
+    return transformIldaSelected ([=] (Array<Frame::IPoint>& points, int16, int16, int16)
     {
-        Frame::IPoint& point = points.getReference (n);
-
-        Colour c = Colour (point.red, point.green, point.blue).withRotatedHue (hshift);
-        float sat = c.getSaturation() + saturation;
-        if (sat < 0.0f)
-            sat = 0.0f;
-        else if (sat > 1.0f)
-            sat = 1.0f;
-        c = c.withSaturation (sat);
-        
-        float b = c.getBrightness() + brightness;
-        if (b < 0.0f)
-            b = 0.0f;
-        else if (b > 1.0f)
-            b = 1.0f;
-        c = c.withBrightness (b);
-        
-        point.red = c.getRed();
-        point.green = c.getGreen();
-        point.blue = c.getBlue();
-        
-        if (c == Colours::black)
-            point.status = Frame::BlankedPoint;
-        else
-            point.status = 0;
-    }
-    
-    transformUsed = true;
-    _setIldaPoints (ildaSelection, points);
-    return true;
+        IldaTransforms::adjustHue (points, hshift, saturation, brightness);
+        return false;
+    });
 }
 
 bool FrameEditor::scaleSketchSelected (float xScale, float yScale, bool centerOnSelected, bool constrain)
@@ -3290,6 +3053,44 @@ bool FrameEditor::rotateSketchSelected (float zAngle, bool centerOnSelection, bo
     return true;
 }
 
+// Paths don't share anything while they're fitted, so they're spread over
+// the WorkerPool. Safe to call from any thread.
+static void reAnchorPaths (Array<IPath>& paths, int anchors, int pointsPer)
+{
+    WorkerPool::forChunks (paths.size(), 4, [&paths, anchors, pointsPer] (int start, int end)
+    {
+        Array<Anchor> newAnchors;
+        
+        for (auto n = start; n < end; ++n)
+        {
+            IPath* p = &paths.getReference (n);
+            
+            p->setExtraPointsPerAnchor ((uint16)(pointsPer - 1));
+            
+            if (p->getAnchorCount() != 1)
+            {
+                CurveFit fitter (p->getPath());
+                float length = fitter.getLength();
+                if (length > 64.0f)
+                {
+                    newAnchors.clearQuick();
+                    for (auto i = 0; i < anchors; ++i)
+                        newAnchors.add (Anchor());
+                    
+                    float offset = length / (float)(anchors - 1);
+                    
+                    for (auto i = 0; i < (anchors -1); ++i)
+                    {
+                        fitter.fit ((float)i * offset, (float)i * offset + offset, newAnchors.getReference (i), newAnchors.getReference (i + 1));
+                    }
+                    
+                    p->setAnchors (newAnchors);
+                }
+            }
+        }
+    });
+}
+
 bool FrameEditor::reAnchorSketchSelected (int anchors, int pointsPer)
 {
     if (anchors < 2)
@@ -3299,35 +3100,17 @@ bool FrameEditor::reAnchorSketchSelected (int anchors, int pointsPer)
     if (! paths.size())
         return false;
 
-    for (auto n = 0; n < paths.size(); ++n)
+    reAnchorPaths (paths, anchors, pointsPer);
+    
+    // Same again for frame batches, on every path in the frame
+    transformOperation = [anchors, pointsPer] (Array<Frame::IPoint>&, Array<IPath>& framePaths)
     {
-        IPath* p = &paths.getReference (n);
-        
-        p->setExtraPointsPerAnchor ((uint16)(pointsPer - 1));
+        if (! framePaths.size())
+            return false;
         
-        if (p->getAnchorCount() != 1)
-        {
-            Path path = p->getPath();
-            float length = path.getLength();
-            if (length > 64.0f)
-            {
-                p->clearAllAnchors();
-                Array<Anchor> newAnchors;
-                for (auto i = 0; i < anchors; ++i)
-                    newAnchors.add (Anchor());
-                
-                float offset = length / (float)(anchors - 1);
-                
-                for (auto i = 0; i < (anchors -1); ++i)
-                {
-                    CurveFit::fit (path, (float)i * offset, (float)i * offset + offset, newAnchors.getReference (i), newAnchors.getReference (i + 1));
-                }
-                
-                for (auto i = 0; i < newAnchors.size(); ++i)
-                    p->addAnchor (newAnchors[i]);
-            }
-        }
-    }
+        reAnchorPaths (framePaths, anchors, pointsPer);
+        return true;
+    };
 
     transformUsed = true;
     _setPaths (iPathSelection, paths);
@@ -3488,6 +3271,9 @@ void FrameEditor::endTransform()
 {
     if (activeLayer == ilda)
     {
+        // Get the last preview in first
+        flushPreview();
+        
         // Already Transformed! So grab!
         Array<Frame::IPoint> points;
         getIldaSelectedPoints(points);
@@ -3505,6 +3291,9 @@ void FrameEditor::endTransform()
             perform (new UndoableSetIldaPoints (this, ildaSelection, points));
 
             refreshThumb();
+            
+            lastOperation = transformOperation;
+            lastOperationName = transformName;
         }
     }
     else
@@ -3523,11 +3312,275 @@ void FrameEditor::endTransform()
         {
             beginNewTransaction (transformName);
             perform (new UndoableSetPaths (this, iPathSelection, paths));
+            
+            // Only some sketch transforms can be repeated on whole frames
+            if (transformOperation != nullptr)
+            {
+                lastOperation = transformOperation;
+                lastOperationName = transformName;
+            }
         }
     }
  
     transformUsed = false;
-    sendActionMessage (EditorActions::transformEnded);
+    post (EditorActions::transformEnded);
+}
+
+//==========================================================================================
+// Runs a FrameOperation over copies of frame data, frames are spread
+// over the WorkerPool and checked for a cancel between each one
+class FrameBatch : public ThreadWithProgressWindow
+{
+public:
+    FrameBatch (const String& name,
+                Array<FrameData>& frameData,
+                const FrameEditor::FrameOperation& operation)
+    : ThreadWithProgressWindow (name, true, true),
+      data (frameData),
+      op (operation)
+    {
+        changed.insertMultiple (0, false, data.size());
+    }
+    
+    void run() override
+    {
+        Atomic<int> done;
+        FrameData* frames = data.getRawDataPointer();
+        bool* results = changed.getRawDataPointer();
+        Thread::ThreadID caller = Thread::getCurrentThreadId();
+        
+        WorkerPool::forChunks (data.size(), 1, [&] (int start, int end)
+        {
+            for (auto n = start; n < end; ++n)
+            {
+                if (threadShouldExit())
+                    return;
+                
+                results[n] = op (frames[n].points, frames[n].paths);
+                
+                // Progress is a plain double, so only this thread sets it
+                int count = ++done;
+                if (Thread::getCurrentThreadId() == caller)
+                    setProgress ((double)count / (double)data.size());
+            }
+        });
+    }
+    
+    bool wasChanged (int index) { return changed[index]; }
+    
+private:
+    Array<FrameData>& data;
+    const FrameEditor::FrameOperation& op;
+    Array<bool> changed;
+};
+
+void FrameEditor::applyLastOperationToFrames()
+{
+    if (lastOperation == nullptr)
+        return;
+    
+    AlertWindow w ("Apply to Frames",
+                   "Apply \"" + lastOperationName + "\" to each whole frame in this range:",
+                   AlertWindow::NoIcon);
+    
+    w.addTextEditor ("first", String (jmin (frameIndex + 2, (int)getFrameCount())), "First Frame:");
+    w.addTextEditor ("last", String (getFrameCount()), "Last Frame:");
+    w.addButton ("Apply", 1, KeyPress (KeyPress::returnKey));
+    w.addButton ("Cancel", 0, KeyPress (KeyPress::escapeKey));
+    
+    if (w.runModalLoop() != 1)
+        return;
+    
+    int first = jlimit (1, (int)getFrameCount(), w.getTextEditorContents ("first").getIntValue());
+    int last = jlimit (1, (int)getFrameCount(), w.getTextEditorContents ("last").getIntValue());
+    
+    SparseSet<uint16> frames;
+    frames.addRange (Range<uint16> ((uint16)(jmin (first, last) - 1), (uint16)jmax (first, last)));
+    
+    applyToFrames (frames, lastOperationName, lastOperation);
+}
+
+bool FrameEditor::applyToFrames (const SparseSet<uint16>& frames,
+                                 const String& name,
+                                 const FrameOperation& op)
+{
+    Array<FrameData> data;
+    
+    for (auto n = 0; n < frames.getNumRanges(); ++n)
+    {
+        Range<uint16> r = frames.getRange (n);
+        
+        for (auto i = r.getStart(); i < r.getEnd() && i < getFrameCount(); ++i)
+        {
+            FrameData d;
+            d.index = i;
+            d.points = Frames[i]->getPoints();
+            d.paths = Frames[i]->getIPaths();
+            data.add (d);
+        }
+    }
+    
+    if (data.isEmpty())
+        return false;
+    
+    // Nothing changes if the user cancels
+    FrameBatch batch (name, data, op);
+    if (! batch.runThread())
+        return false;
+    
+    Array<FrameData> changed;
+    for (auto n = 0; n < data.size(); ++n)
+        if (batch.wasChanged (n))
+            changed.add (data[n]);
+    
+    if (changed.size() != data.size())
+        AlertWindow::showMessageBox (AlertWindow::InfoIcon, name,
+                                     String (data.size() - changed.size()) + " of " +
+                                     String (data.size()) + " frames were left unchanged.");
+    
+    if (changed.isEmpty())
+        return false;
+    
+    // One undo step for the lot
+    beginNewTransaction (name);
+    perform (new UndoableSetIldaSelection (this, SparseSet<uint16>()));
+    perform (new UndoableSetIPathSelection (this, IPathSelection()));
+    perform (new UndoableSetFrameData (this, changed));
+    return true;
+}
+
+//==========================================================================================
+// Renders the sketch layer of every frame. Each frame gets its path order
+// on its own (spread over the WorkerPool), then one pass over the lot picks
+// where each frame's loop starts so it's a short jump from where the frame
+// before it ended.
+class AnimationRender : public ThreadWithProgressWindow
+{
+public:
+    AnimationRender (FrameEditor* editor, Array<FrameData>& frameData, bool shortest)
+    : ThreadWithProgressWindow ("Render Animation", true, true),
+      render (editor->getSketchRender()),
+      data (frameData),
+      shortestPath (shortest),
+      jumpsBefore (0),
+      jumpsAfter (0),
+      blanksSaved (0)
+    {
+    }
+    
+    void run() override
+    {
+        // Progress is a plain double, so only this thread sets it
+        Atomic<int> done;
+        Thread::ThreadID caller = Thread::getCurrentThreadId();
+        Array<Array<IPath>> tours;
+        tours.resize (data.size());
+        BlankPointCost cost (render.blankMove);
+        
+        WorkerPool::forChunks (data.size(), 1, [&] (int start, int end)
+        {
+            for (auto n = start; n < end; ++n)
+            {
+                if (threadShouldExit())
+                    return;
+                
+                if (shortestPath)
+                    ShortestPath::find (data.getReference (n).paths, tours.getReference (n), cost,
+                                        250.0, [this] { return threadShouldExit(); });
+                else
+                    tours.getReference (n) = data.getReference (n).paths;
+                
+                int count = ++done;
+                if (Thread::getCurrentThreadId() == caller)
+                    setProgress ((double)count / (double)(data.size() * 2));
+            }
+        });
+        
+        if (threadShouldExit())
+            return;
+        
+        // Stitch the frames together
+        setStatusMessage ("Joining frames...");
+        Array<int> starts;
+        starts.insertMultiple (0, 0, tours.size());
+        
+        MoveLengthCost length;
+        jumpsBefore = ShortestPath::getBoundaryCost (tours, starts, length);
+        int blanksBefore = ShortestPath::getBoundaryCost (tours, starts, cost);
+        jumpsAfter = ShortestPath::chooseStarts (tours, starts, length);
+        blanksSaved = blanksBefore - ShortestPath::getBoundaryCost (tours, starts, cost);
+        
+        setStatusMessage (String());
+        WorkerPool::forChunks (data.size(), 1, [&] (int start, int end)
+        {
+            Array<IPath> ordered;
+            Array<IPath> connected;
+            
+            for (auto n = start; n < end; ++n)
+            {
+                if (threadShouldExit())
+                    return;
+                
+                if (tours.getReference (n).size())
+                {
+                    ShortestPath::startTourAt (tours.getReference (n), starts[n], ordered);
+                    FrameEditor::connectIPaths (ordered, connected);
+                    FrameEditor::generatePointsFromPaths (render, connected, data.getReference (n).points);
+                }
+                
+                int count = ++done;
+                if (Thread::getCurrentThreadId() == caller)
+                    setProgress ((double)count / (double)(data.size() * 2));
+            }
+        });
+    }
+    
+    int getJumpsBefore() { return jumpsBefore; }
+    int getJumpsAfter() { return jumpsAfter; }
+    int getBlanksSaved() { return blanksSaved; }
+    
+private:
+    FrameEditor::SketchRender render;
+    Array<FrameData>& data;
+    bool shortestPath;
+    int jumpsBefore;
+    int jumpsAfter;
+    int blanksSaved;
+};
+
+void FrameEditor::renderAnimation (bool shortestPath)
+{
+    Array<FrameData> data;
+    for (uint16 n = 0; n < getFrameCount(); ++n)
+    {
+        FrameData d;
+        d.index = n;
+        d.points = Frames[n]->getPoints();
+        d.paths = Frames[n]->getIPaths();
+        data.add (d);
+    }
+    
+    // Nothing changes if the user cancels
+    AnimationRender render (this, data, shortestPath);
+    if (! render.runThread())
+        return;
+    
+    Array<FrameData> changed;
+    for (auto n = 0; n < data.size(); ++n)
+        if (data.getReference (n).paths.size())
+            changed.add (data[n]);
+    
+    if (changed.isEmpty())
+        return;
+    
+    renderReport = "Animation: " + String (changed.size()) + " frames, jumps between frames "
+                   + String (render.getJumpsBefore()) + " to " + String (render.getJumpsAfter())
+                   + " (" + String (render.getBlanksSaved()) + " blanked points saved)";
+    renderPathReport.clear();
+    
+    beginNewTransaction ("Render Animation");
+    perform (new UndoableSetIldaSelection (this, SparseSet<uint16>()));
+    perform (new UndoableSetFrameData (this, changed));
 }
 
 void FrameEditor::setIldaSelectedX (int16 newX)
@@ -3662,7 +3715,7 @@ void FrameEditor::_setActiveLayer (Layer layer)
     if (layer != activeLayer)
     {
         activeLayer = layer;
-        sendActionMessage (EditorActions::layerChanged);
+        post (EditorActions::layerChanged);
         refreshThumb();
     }
 }
@@ -3672,7 +3725,7 @@ void FrameEditor::_setActiveView (View view)
     if (view != activeView)
     {
         activeView = view;
-        sendActionMessage (EditorActions::viewChanged);
+        post (EditorActions::viewChanged);
         refreshThumb();
     }
 }
@@ -3685,7 +3738,16 @@ void FrameEditor::_setZoomFactor (float zoom)
     if (zoom != zoomFactor)
     {
         zoomFactor = zoom;
-        sendActionMessage (EditorActions::zoomFactorChanged);
+        post (EditorActions::zoomFactorChanged);
+    }
+}
+
+void FrameEditor::_setScanRate (uint32 rate)
+{
+    if (rate && rate != scanRate)
+    {
+        scanRate = rate;
+        post (EditorActions::scanRateChanged);
     }
 }
 
@@ -3694,7 +3756,7 @@ void FrameEditor::_setActiveIldaTool (IldaTool tool)
     if (activeIldaTool != tool)
     {
         activeIldaTool = tool;
-        sendActionMessage (EditorActions::ildaToolChanged);
+        post (EditorActions::ildaToolChanged);
 
         refreshThumb();
     }
@@ -3707,7 +3769,7 @@ void FrameEditor::_setPointToolColor (const Colour& color)
         pointToolColor = color;
         if (color != Colours::black)
             lastVisiblePointToolColor = color;
-        sendActionMessage (EditorActions::ildaPointToolColorChanged);
+        post (EditorActions::ildaPointToolColorChanged);
     }
 }
 
@@ -3716,7 +3778,7 @@ void FrameEditor::_setActiveSketchTool (SketchTool tool)
     if (activeSketchTool != tool)
     {
         activeSketchTool = tool;
-        sendActionMessage (EditorActions::sketchToolChanged);
+        post (EditorActions::sketchToolChanged);
 
         refreshThumb();
     }
@@ -3729,7 +3791,7 @@ void FrameEditor::_setSketchToolColor (const Colour& color)
         sketchToolColor = color;
         if (color != Colours::black)
             lastVisibleSketchToolColor = color;
-        sendActionMessage (EditorActions::sketchToolColorChanged);
+        post (EditorActions::sketchToolColorChanged);
     }
 }
 
@@ -3738,7 +3800,7 @@ void FrameEditor::_setSketchVisible (bool visible)
     if (visible != sketchVisible)
     {
         sketchVisible = visible;
-        sendActionMessage (EditorActions::sketchVisibilityChanged);
+        post (EditorActions::sketchVisibilityChanged);
     }
 }
 
@@ -3747,7 +3809,7 @@ void FrameEditor::_setIldaVisible (bool visible)
     if (visible != ildaVisible)
     {
         ildaVisible = visible;
-        sendActionMessage (EditorActions::ildaVisibilityChanged);
+        post (EditorActions::ildaVisibilityChanged);
     }
 }
 
@@ -3756,14 +3818,14 @@ void FrameEditor::_setRefVisible (bool visible)
     if (visible != refVisible)
     {
         refVisible = visible;
-        sendActionMessage (EditorActions::refVisibilityChanged);
+        post (EditorActions::refVisibilityChanged);
     }
 }
 
 bool FrameEditor::_setImageData (const MemoryBlock& file)
 {
     currentFrame->setImageData (file);
-    sendActionMessage (EditorActions::backgroundImageChanged);
+    post (EditorActions::backgroundImageChanged);
     return true;
 }
 
@@ -3777,7 +3839,7 @@ void FrameEditor::_setImageOpacity (float opacity)
     if (opacity != refOpacity)
     {
         currentFrame->setImageOpacity (opacity);
-        sendActionMessage (EditorActions::refOpacityChanged);
+        post (EditorActions::refOpacityChanged);
     }
 }
 
@@ -3791,7 +3853,7 @@ void FrameEditor::_setImageScale (float scale)
     if (scale != currentFrame->getImageScale())
     {
         currentFrame->setImageScale (scale);
-        sendActionMessage (EditorActions::backgroundImageAdjusted);
+        post (EditorActions::backgroundImageAdjusted);
     }
 }
 
@@ -3805,7 +3867,7 @@ void FrameEditor::_setImageRotation (float rot)
     if (rot != currentFrame->getImageRotation())
     {
         currentFrame->setImageRotation (rot);
-        sendActionMessage (EditorActions::backgroundImageAdjusted);
+        post (EditorActions::backgroundImageAdjusted);
     }
 }
 
@@ -3819,7 +3881,7 @@ void FrameEditor::_setImageXoffset (float off)
     if (off != currentFrame->getImageXoffset())
     {
         currentFrame->setImageXoffset (off);
-        sendActionMessage (EditorActions::backgroundImageAdjusted);
+        post (EditorActions::backgroundImageAdjusted);
     }
 }
 
@@ -3833,14 +3895,14 @@ void FrameEditor::_setImageYoffset (float off)
     if (off != currentFrame->getImageYoffset())
     {
         currentFrame->setImageYoffset (off);
-        sendActionMessage (EditorActions::backgroundImageAdjusted);
+        post (EditorActions::backgroundImageAdjusted);
     }
 }
 
 void FrameEditor::_setFrames (const ReferenceCountedArray<Frame> frames)
 {
     Frames = frames;
-    sendActionMessage (EditorActions::framesChanged);
+    post (EditorActions::framesChanged);
 }
 
 void FrameEditor::_setFrameIndex (uint16 index)
@@ -3851,7 +3913,7 @@ void FrameEditor::_setFrameIndex (uint16 index)
     currentFrame = Frames[index];
     frameIndex = index;
     
-    sendActionMessage (EditorActions::frameIndexChanged);
+    post (EditorActions::frameIndexChanged);
 }
 
 void FrameEditor::_deleteFrame (uint16 index)
@@ -3860,7 +3922,7 @@ void FrameEditor::_deleteFrame (uint16 index)
     {
         Frames.remove (index);
         currentFrame = Frames[frameIndex];
-        sendActionMessage (EditorActions::framesChanged);
+        post (EditorActions::framesChanged);
     }
 }
 
@@ -3870,14 +3932,14 @@ void FrameEditor::_insertFrame (uint16 index, Frame::Ptr frame)
     {
         Frames.insert(index, frame);
         currentFrame = Frames[frameIndex];
-        sendActionMessage (EditorActions::framesChanged);
+        post (EditorActions::framesChanged);
     }
 }
 
 void FrameEditor::_newFrame()
 {
     Frames.insert (getFrameIndex() + 1, new Frame());
-    sendActionMessage (EditorActions::framesChanged);
+    post (EditorActions::framesChanged);
 }
 
 void FrameEditor::_dupFrame()
@@ -3885,7 +3947,7 @@ void FrameEditor::_dupFrame()
     Frame::Ptr oldFrame = getFrame();
     Frame::Ptr newFrame = new Frame (*oldFrame.get());
     Frames.insert (getFrameIndex() + 1, newFrame);
-    sendActionMessage (EditorActions::framesChanged);
+    post (EditorActions::framesChanged);
 }
 
 void FrameEditor::_swapFrames (uint16 index1, uint16 index2)
@@ -3897,7 +3959,7 @@ void FrameEditor::_swapFrames (uint16 index1, uint16 index2)
         // We could be whacking out the current index pointer
         // So reset active data just in case
         currentFrame = Frames[getFrameIndex()];
-        sendActionMessage (EditorActions::framesChanged);
+        post (EditorActions::framesChanged);
     }
 }
 
@@ -3906,7 +3968,7 @@ void FrameEditor::_setIldaShowBlanked (bool show)
     if (getIldaShowBlanked() != show)
     {
         ildaShowBlanked = show;
-        sendActionMessage (EditorActions::frameIndexChanged);
+        post (EditorActions::frameIndexChanged);
     }
 }
 
@@ -3915,7 +3977,7 @@ void FrameEditor::_setIldaDrawLines (bool draw)
     if (getIldaDrawLines() != draw)
     {
         ildaDrawLines = draw;
-        sendActionMessage (EditorActions::ildaDrawLinesChanged);
+        post (EditorActions::ildaDrawLinesChanged);
     }
 }
 
@@ -3924,7 +3986,7 @@ void FrameEditor::_setDrawGrid (bool draw)
     if (getRefDrawGrid() != draw)
     {
         refDrawGrid = draw;
-        sendActionMessage (EditorActions::refDrawGridChanged);
+        post (EditorActions::refDrawGridChanged);
     }
 }
 
@@ -3939,7 +4001,7 @@ void FrameEditor::_setIldaSelection (const SparseSet<uint16>& selection)
     if (selection != ildaSelection)
     {
         ildaSelection = selection;
-        sendActionMessage (EditorActions::ildaSelectionChanged);
+        post (EditorActions::ildaSelectionChanged);
     }
 }
 
@@ -3959,7 +4021,7 @@ void FrameEditor::_setIldaPoints (const SparseSet<uint16>& selection,
             currentFrame->replacePoint (r.getStart() + i, points[pindex++]);
     }
     
-    sendActionMessage (EditorActions::ildaPointsChanged);
+    post (EditorActions::ildaPointsChanged);
 }
 
 void FrameEditor::_insertPoint (uint16 index, const Frame::IPoint& point)
@@ -3967,14 +4029,14 @@ void FrameEditor::_insertPoint (uint16 index, const Frame::IPoint& point)
     if (index <= currentFrame->getPointCount())
     {
         currentFrame->insertPoint (index, point);
-        sendActionMessage (EditorActions::ildaPointsChanged);
+        post (EditorActions::ildaPointsChanged);
     }
 }
 
 void FrameEditor::_setPoints (const Array<Frame::IPoint>& points)
 {
     currentFrame->setPoints (points);
-    sendActionMessage (EditorActions::ildaPointsChanged);
+    post (EditorActions::ildaPointsChanged);
 }
 
 void FrameEditor::_deletePoint (uint16 index)
@@ -3982,8 +4044,29 @@ void FrameEditor::_deletePoint (uint16 index)
     if (index < currentFrame->getPointCount())
     {
         currentFrame->removePoint (index);
-        sendActionMessage (EditorActions::ildaPointsChanged);
+        post (EditorActions::ildaPointsChanged);
+    }
+}
+
+void FrameEditor::_setFrameData (const Array<FrameData>& data)
+{
+    for (auto n = 0; n < data.size(); ++n)
+    {
+        const FrameData& d = data.getReference (n);
+        if (d.index < getFrameCount())
+        {
+            Frames[d.index]->setPoints (d.points);
+            Frames[d.index]->setIPaths (d.paths);
+        }
     }
+    
+    // Only the ones somebody has looked at get built again
+    for (auto n = 0; n < data.size(); ++n)
+        if (data[n].index < getFrameCount())
+            thumbCache.refresh (Frames[data[n].index].get());
+    
+    post (EditorActions::ildaPointsChanged);
+    post (EditorActions::iPathsChanged);
 }
 
 void FrameEditor::_setIPathSelection (const IPathSelection& selection)
@@ -3997,7 +4080,7 @@ void FrameEditor::_setIPathSelection (const IPathSelection& selection)
     if (selection != iPathSelection)
     {
         iPathSelection = selection;
-        sendActionMessage (EditorActions::iPathSelectionChanged);
+        post (EditorActions::iPathSelectionChanged);
     }
 }
 
@@ -4006,7 +4089,7 @@ void FrameEditor::_deletePath (int index)
     if ((index >= 0) && (index < getIPathCount()))
     {
         currentFrame->deletePath (index);
-        sendActionMessage (EditorActions::iPathsChanged);
+        post (EditorActions::iPathsChanged);
     }
 }
 
@@ -4015,7 +4098,7 @@ void FrameEditor::_insertPath (int index, IPath& path)
     if ((index >= 0) && (index <= getIPathCount()))
     {
         currentFrame->insertPath (index, path);
-        sendActionMessage (EditorActions::iPathsChanged);
+        post (EditorActions::iPathsChanged);
     }
 }
 
@@ -4031,13 +4114,13 @@ void FrameEditor::_setPaths (const IPathSelection& selection,
             currentFrame->replacePath (i, paths.getReference (pindex++));
     }
     
-    sendActionMessage (EditorActions::iPathsChanged);
+    post (EditorActions::iPathsChanged);
 }
 
 void FrameEditor::_setIPaths (const Array<IPath>& paths)
 {
     currentFrame->setIPaths (paths);
-    sendActionMessage (EditorActions::iPathsChanged);
+    post (EditorActions::iPathsChanged);
 }
 
 void FrameEditor::_deleteAnchor (int pindex, int aindex)
@@ -4045,7 +4128,7 @@ void FrameEditor::_deleteAnchor (int pindex, int aindex)
     IPath path = currentFrame->getIPath (pindex);
     path.removeAnchor (aindex);
     currentFrame->replacePath (pindex, path);
-    sendActionMessage (EditorActions::iPathsChanged);
+    post (EditorActions::iPathsChanged);
 }
 
 void FrameEditor::_insertAnchor (int pindex, int aindex, const Anchor& a)
@@ -4053,5 +4136,5 @@ void FrameEditor::_insertAnchor (int pindex, int aindex, const Anchor& a)
     IPath path = currentFrame->getIPath (pindex);
     path.insertAnchor (aindex, a);
     currentFrame->replacePath (pindex, path);
-    sendActionMessage (EditorActions::iPathsChanged);
+    post (EditorActions::iPathsChanged);
 }
@@ -22,51 +22,69 @@
 #include <JuceHeader.h>
 #include "Frame.h"
 #include "IPath.h"
+#include "SketchCache.h"
+#include "ThumbCache.h"
+#include "BlankMove.h"
+#include "ImageTracer.h"
+#include "EditorBus.h"
 
 #define MIN_ZOOM (1.0f)
 #define MAX_ZOOM (16.0f)
 
 //==============================================================================
-// Keep the broadcast messages short and unique
+// One bit each, see EditorBus
 namespace EditorActions
 {
-    const String dirtyStatusChanged         ("DSC");
-    const String selectionCopied            ("SCP");
-    const String layerChanged               ("LC");
-    const String viewChanged                ("VC");
-    const String zoomFactorChanged          ("ZFC");
-    const String sketchVisibilityChanged    ("SVC");
-    const String ildaVisibilityChanged      ("IVC");
-    const String refVisibilityChanged       ("RVC");
-    const String backgroundImageChanged     ("BIC");
-    const String refOpacityChanged          ("ROC");
-    const String refDrawGridChanged         ("RGC");
-    const String backgroundImageAdjusted    ("BIA");
-    const String framesChanged              ("FC");
-    const String frameThumbsChanged         ("FTC");
-    const String frameIndexChanged          ("FIC");
-    const String ildaShowBlankChanged       ("SBC");
-    const String ildaDrawLinesChanged       ("DLC");
-    const String ildaSelectionChanged       ("ISC");
-    const String ildaPointsChanged          ("IPC");
-    const String ildaToolChanged            ("ITC");
-    const String ildaPointToolColorChanged  ("PTC");
-    const String sketchToolChanged          ("STC");
-    const String sketchToolColorChanged     ("SCC");
-    const String iPathsChanged              ("PAC");
-    const String iPathSelectionChanged      ("PSC");
-    const String cancelRequest              ("CR");
-    const String deleteRequest              ("DR");
-    const String upRequest                  ("UPR");
-    const String downRequest                ("DNR");
-    const String leftRequest                ("LER");
-    const String rightRequest               ("RIR");
-    const String smallUpRequest             ("uPR");
-    const String smallDownRequest           ("dNR");
-    const String smallLeftRequest           ("lER");
-    const String smallRightRequest          ("rIR");
-    const String transformStarted           ("TS");
-    const String transformEnded             ("TE");
+    const EditorChanges dirtyStatusChanged         (1ULL << 0);
+    const EditorChanges selectionCopied            (1ULL << 1);
+    const EditorChanges layerChanged               (1ULL << 2);
+    const EditorChanges viewChanged                (1ULL << 3);
+    const EditorChanges zoomFactorChanged          (1ULL << 4);
+    const EditorChanges scanRateChanged            (1ULL << 5);
+    const EditorChanges sketchVisibilityChanged    (1ULL << 6);
+    const EditorChanges ildaVisibilityChanged      (1ULL << 7);
+    const EditorChanges refVisibilityChanged       (1ULL << 8);
+    const EditorChanges backgroundImageChanged     (1ULL << 9);
+    const EditorChanges refOpacityChanged          (1ULL << 10);
+    const EditorChanges refDrawGridChanged         (1ULL << 11);
+    const EditorChanges backgroundImageAdjusted    (1ULL << 12);
+    const EditorChanges framesChanged              (1ULL << 13);
+    const EditorChanges frameThumbsChanged         (1ULL << 14);
+    const EditorChanges frameIndexChanged          (1ULL << 15);
+    const EditorChanges ildaShowBlankChanged       (1ULL << 16);
+    const EditorChanges ildaDrawLinesChanged       (1ULL << 17);
+    const EditorChanges ildaSelectionChanged       (1ULL << 18);
+    const EditorChanges ildaPointsChanged          (1ULL << 19);
+    const EditorChanges ildaToolChanged            (1ULL << 20);
+    const EditorChanges ildaPointToolColorChanged  (1ULL << 21);
+    const EditorChanges sketchToolChanged          (1ULL << 22);
+    const EditorChanges sketchToolColorChanged     (1ULL << 23);
+    const EditorChanges iPathsChanged              (1ULL << 24);
+    const EditorChanges iPathSelectionChanged      (1ULL << 25);
+    const EditorChanges cancelRequest              (1ULL << 26);
+    const EditorChanges deleteRequest              (1ULL << 27);
+    const EditorChanges upRequest                  (1ULL << 28);
+    const EditorChanges downRequest                (1ULL << 29);
+    const EditorChanges leftRequest                (1ULL << 30);
+    const EditorChanges rightRequest               (1ULL << 31);
+    const EditorChanges smallUpRequest             (1ULL << 32);
+    const EditorChanges smallDownRequest           (1ULL << 33);
+    const EditorChanges smallLeftRequest           (1ULL << 34);
+    const EditorChanges smallRightRequest          (1ULL << 35);
+    const EditorChanges transformStarted           (1ULL << 36);
+    const EditorChanges transformEnded             (1ULL << 37);
+
+    // Every one of these is acted on, so they never get merged
+    const EditorChanges requests = cancelRequest |
+                                   deleteRequest |
+                                   upRequest |
+                                   downRequest |
+                                   leftRequest |
+                                   rightRequest |
+                                   smallUpRequest |
+                                   smallDownRequest |
+                                   smallLeftRequest |
+                                   smallRightRequest;
 }
 
 
@@ -108,9 +126,24 @@ private:
     int control;
 };
 
+// Points and paths of one frame, batch operations work on copies of these
+class FrameData
+{
+public:
+    FrameData() : index (0) {;}
+    
+    uint16 index;
+    Array<Frame::IPoint> points;
+    Array<IPath> paths;
+};
+
+class PreviewJob;
+class BezierSampler;
+
 //==============================================================================
-class FrameEditor  : public ActionBroadcaster,
-                     public UndoManager
+class FrameEditor  : public EditorBus,
+                     public UndoManager,
+                     private Timer
 {
 public:
     FrameEditor();
@@ -138,9 +171,19 @@ public:
         sketchCenterRectTool,
         sketchEllipseTool,
         sketchCenterEllipseTool,
-        sketchPenTool
+        sketchPenTool,
+        sketchFreehandTool
     } SketchTool;
     
+    // Batch operations change a frame's points and/or paths in place and
+    // return false to leave that frame as it was. They get called from
+    // worker threads, so they must not touch the editor's state.
+    typedef std::function<bool (Array<Frame::IPoint>& points, Array<IPath>& paths)> FrameOperation;
+    
+    // ILDA kernels get the points to change and the center of
+    // the points they came from, returns true if anything clipped
+    typedef std::function<bool (Array<Frame::IPoint>& points, int16 x, int16 y, int16 z)> IldaKernel;
+    
     // Dirty/Clean mechanism
     uint32 getDirtyCounter() { return dirtyCounter; }
     void setDirtyCounter (uint32 count);
@@ -159,29 +202,44 @@ public:
     void copy();
     void adjustSelection (int offset);
     
+    // Everything rendering sketch paths depends on. Renders work from a
+    // copy, so batch operations and worker threads never read the editor.
+    struct SketchRender
+    {
+        View view;
+        float tolerance;
+        BlankMove blankMove;
+        SketchCache* cache;     // nullptr renders without caching
+    };
+    SketchRender getSketchRender() { return { activeView, adaptiveTolerance, blankMove, &sketchCache }; }
+    
     // Sketch helpers
-    void connectIPaths (const Array<IPath>& src, Array<IPath>& dst);
-    bool isClosedIPath (const IPath& path);
-    void pointToIPointXYZ (Point<int> a, Frame::IPoint& point, int zStart = 0, int zEnd = 0, float zPercent = 0.0f);
-    void anchorToPointXYZ (const Anchor& a, Frame::IPoint& point, int zStart = 0, int zEnd = 0, float zPercent = 0.0f);
-    void generatePointsFromPaths (const Array<IPath>& paths, Array<Frame::IPoint>& points, bool appendPoints = false);
+    static void connectIPaths (const Array<IPath>& src, Array<IPath>& dst);
+    static void generateBlankMove (const SketchRender& render, const IPath& path, Array<Frame::IPoint>& points);
+    static bool isClosedIPath (const IPath& path);
+    static void pointToIPointXYZ (View view, Point<int> a, Frame::IPoint& point, int zStart = 0, int zEnd = 0, float zPercent = 0.0f);
+    static void anchorToPointXYZ (View view, const Anchor& a, Frame::IPoint& point, int zStart = 0, int zEnd = 0, float zPercent = 0.0f);
+    static void generatePointsFromPaths (const SketchRender& render, const Array<IPath>& paths, Array<Frame::IPoint>& points,
+                                         bool appendPoints = false, Array<int>* runSizes = nullptr);
+    static void generatePointsFromPath (const SketchRender& render, const IPath& path,
+                                        Array<Frame::IPoint>& points, BezierSampler& segment);
 
 
     // Tool helpers
     void cancelRequest()
     {
-        sendActionMessage (EditorActions::cancelRequest);
+        post (EditorActions::cancelRequest);
         refreshThumb();
     }
-    void deleteRequest()    { sendActionMessage (EditorActions::deleteRequest); }
-    void upRequest()        { sendActionMessage (EditorActions::upRequest); }
-    void downRequest()      { sendActionMessage (EditorActions::downRequest); }
-    void leftRequest()      { sendActionMessage (EditorActions::leftRequest); }
-    void rightRequest()     { sendActionMessage (EditorActions::rightRequest); }
-    void smallUpRequest()   { sendActionMessage (EditorActions::smallUpRequest); }
-    void smallDownRequest() { sendActionMessage (EditorActions::smallDownRequest); }
-    void smallLeftRequest() { sendActionMessage (EditorActions::smallLeftRequest); }
-    void smallRightRequest(){ sendActionMessage (EditorActions::smallRightRequest); }
+    void deleteRequest()    { post (EditorActions::deleteRequest); }
+    void upRequest()        { post (EditorActions::upRequest); }
+    void downRequest()      { post (EditorActions::downRequest); }
+    void leftRequest()      { post (EditorActions::leftRequest); }
+    void rightRequest()     { post (EditorActions::rightRequest); }
+    void smallUpRequest()   { post (EditorActions::smallUpRequest); }
+    void smallDownRequest() { post (EditorActions::smallDownRequest); }
+    void smallLeftRequest() { post (EditorActions::smallLeftRequest); }
+    void smallRightRequest(){ post (EditorActions::smallRightRequest); }
     bool hasSelection();
     bool hasMovableSelection();
     void toggleBlanking();
@@ -206,12 +264,15 @@ public:
     const MemoryBlock& getImageData() {return currentFrame->getImageData(); }
     
     const Image* getImage() { return currentFrame->getBackgroundImage(); }
+    std::shared_ptr<RefImage> getRefImage() { return currentFrame->getRefImage(); }
     bool getRefDrawGrid() { return refDrawGrid; }
     float getImageOpacity() { return currentFrame->getImageOpacity(); }
     float getImageScale() { return currentFrame->getImageScale(); }
     float getImageRotation() { return currentFrame->getImageRotation(); }
     float getImageXoffset() { return currentFrame->getImageXoffset(); }
     float getImageYoffset() { return currentFrame->getImageYoffset(); }
+    // Image pixels to sketch space, as the working area draws it
+    AffineTransform getImageTransform();
     
     const ReferenceCountedArray<Frame>& getFrames() { return Frames; }
     uint16 getFrameCount() { return (uint16)Frames.size(); }
@@ -236,8 +297,13 @@ public:
     void getIldaSelectedPoints (Array<Frame::IPoint>& points);
     void getIldaPoints (const SparseSet<uint16>& selection, Array<Frame::IPoint>& points);
 
-    const Image& getCurrentThumbNail() { return currentFrame->getThumbNail(); }
-    const Image& getThumbNail (uint16 index) { return Frames[index]->getThumbNail(); }
+    Image getCurrentThumbNail() { return thumbCache.get (currentFrame.get()); }
+    Image getThumbNail (uint16 index) { return thumbCache.get (Frames[index].get()); }
+    // What's cached right now, without building anything
+    Image peekThumbNail (uint16 index) { return thumbCache.peek (Frames[index].get()); }
+    // Gets the thumbnail ready in the background for a row about to show
+    void prefetchThumbNail (uint16 index) { thumbCache.prefetch (Frames[index].get()); }
+    ThumbCache& getThumbCache() { return thumbCache; }
     
     int getIPathCount() { return currentFrame->getIPathCount(); }
     const IPath getIPath (int index) { return currentFrame->getIPath (index); }
@@ -254,7 +320,16 @@ public:
     void startTransform (const String& name);
     bool isTransforming() { return tranformInProgress; }
     
+    // When on, live transform updates are coalesced and published at most
+    // once per display frame, otherwise every update is applied directly
+    bool getPreviewCoalescing() { return previewCoalescing; }
+    void setPreviewCoalescing (bool coalesce);
+    
     // ILDA Transforms
+    // These return false when constrain is set and the result clips. With
+    // preview coalescing on that isn't known until the coalesced job runs,
+    // so they return true once the request is queued and a clipped result
+    // is just never published.
     bool scaleIldaSelected (float xScale, float yScale, float zScale, bool centerOnSelection, bool constrain = true);
     bool rotateIldaSelected (float xAngle, float yAngle, float zAngle, bool centerOnSelection, bool constrain = true);
     bool shearIldaSelected (float shearX, float shearY, bool centerOnSelection, bool constrain = true);
@@ -274,6 +349,12 @@ public:
     bool translateSketchSelected (int xOffset, int yOffset, bool constrain = true);
     void endTransform();
 
+    // Frame batches
+    bool canApplyToFrames() { return lastOperation != nullptr; }
+    const String& getLastOperationName() { return lastOperationName; }
+    void applyLastOperationToFrames();
+    bool applyToFrames (const SparseSet<uint16>& frames, const String& name, const FrameOperation& op);
+
     // Non transform (atomic) undoable operations
     void setActiveLayer (Layer layer);
     void setActiveView (View view);
@@ -350,6 +431,7 @@ public:
     int insertEllipsePath (const Rectangle<int>& rect);
     int insertRectPath (const Rectangle<int>& rect);
     int insertPath (Point<int> firstAnchor);
+    int insertFreehandPath (const Array<Anchor>& anchors);
     int insertAnchor (Point<int> location);
     void insertControls (Point<int> location);
     void forceAnchorCurved();
@@ -358,7 +440,28 @@ public:
     void selectExit();
     void zeroExitControl();
     bool moveSketchSelected (int xOffset, int yOffset, bool constrain = true);
+    // With shortestPath the paths are ordered for the fewest blanked points
     void renderSketch (bool shortestPath, bool updateSketch = false);
+    // Every frame, with each one starting near where the one before ended
+    void renderAnimation (bool shortestPath);
+    const String& getRenderReport() { return renderReport; }
+    const String& getRenderPathReport() { return renderPathReport; }
+    
+    // Above zero, lit paths get points spaced by curvature so the lines
+    // between them stay within this distance of the curve, and corner
+    // dwell by how sharp each anchor is. Zero is plain point density.
+    float getAdaptiveTolerance() { return adaptiveTolerance; }
+    void setAdaptiveTolerance (float tolerance) { adaptiveTolerance = jmax (0.0f, tolerance); }
+    
+    // Outlines of the current frame's reference image, paths is left empty
+    // if there isn't one. addTracedPaths puts them in the sketch.
+    void traceImage (float threshold, float smoothing, float minLength, Array<IPath>& paths);
+    void addTracedPaths (const Array<IPath>& paths);
+    const ImageTracer& getImageTracer() { return imageTracer; }
+    
+    // Speed profile for the blanked jumps between paths
+    const BlankMove& getBlankMove() { return blankMove; }
+    void setBlankMove (const BlankMove& move) { blankMove = move; }
     void pathToPointsSketchSelected ();
 
     
@@ -377,6 +480,7 @@ public:
     // Destructive Version (invoked by UndoManager)
     void _setLoadedFile (const File& file) { loadedFile = file; }
     void _setZoomFactor (float zoom);
+    void _setScanRate (uint32 rate);
     void _setActiveLayer (Layer layer);
     void _setActiveView (View view);
     void _setSketchVisible (bool visible);
@@ -416,6 +520,8 @@ public:
     void _setIldaPoints (const SparseSet<uint16>& selection,
                          const Array<Frame::IPoint>& points);
 
+    void _setFrameData (const Array<FrameData>& data);
+
     void _setIPathSelection (const IPathSelection& selection);
     void _deletePath (int index);
     void _insertPath (int index, IPath& path);
@@ -425,6 +531,14 @@ public:
     void _insertAnchor (int pindex, int aindex, const Anchor& a);
     
 private:
+    bool transformIldaSelected (const IldaKernel& kernel, bool constrain = true);
+    
+    // Live preview pipeline
+    void timerCallback() override;
+    void startPreviewJob();
+    bool publishPreview (PreviewJob& job);
+    void flushPreview();
+
     File loadedFile;
     uint32 dirtyCounter;
     uint32 scanRate;
@@ -461,10 +575,33 @@ private:
     int transformSketchCenterX;
     int transformSketchCenterY;
     String transformName;
+    FrameOperation transformOperation;
+    
+    bool previewCoalescing;
+    bool hasPendingPreview;
+    IldaKernel pendingKernel;
+    bool pendingConstrain;
+    std::shared_ptr<PreviewJob> previewJob;
+    
+    FrameOperation lastOperation;
+    String lastOperationName;
     
     IPathSelection iPathSelection;
     Array<IPath> iPathCopy;
     
+    // Rendered runs of sketch paths, so a render only redoes what changed
+    SketchCache sketchCache;
+    // Frame list thumbnails, only for the rows that get looked at
+    ThumbCache thumbCache;
+    String renderReport;
+    String renderPathReport;
+    float adaptiveTolerance;
+    BlankMove blankMove;
+    ImageTracer imageTracer;
+    
+    // Keeps the WorkerPool threads alive while we're around
+    SharedResourcePointer<ThreadPool> workerPool;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameEditor)
 };
 
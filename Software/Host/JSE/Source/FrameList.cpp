@@ -24,7 +24,7 @@
 FrameList::FrameList (FrameEditor* frame)
 {
     frameEditor = frame;
-    frameEditor->addActionListener (this);
+    frameEditor->addEditorListener (this);
     
     addButton.reset (new TextButton ("addButton"));
     addAndMakeVisible (addButton.get());
@@ -77,6 +77,7 @@ FrameList::FrameList (FrameEditor* frame)
 
 FrameList::~FrameList()
 {
+    frameEditor->removeEditorListener (this);
     frameList = nullptr;
     dupButton = nullptr;
     dupIcon = nullptr;
@@ -127,7 +128,19 @@ void FrameList::paintListBoxItem (int rowNumber,
 
     g.fillAll (getLookAndFeel().findColour (ListBox::backgroundColourId));
     
-    g.drawImage (frameEditor->getThumbNail ((uint16)rowNumber),
+    // Rows just off the ends of the list are built in the background so
+    // scrolling doesn't have to wait on them
+    for (auto n = rowNumber - prefetchRows; n <= rowNumber + prefetchRows; ++n)
+        if (n >= 0 && n < frameEditor->getFrameCount() && n != rowNumber)
+            frameEditor->prefetchThumbNail ((uint16)n);
+
+    Image thumb = frameEditor->getThumbNail ((uint16)rowNumber);
+    drawnThumbs.set (rowNumber, thumb);
+    // Don't hang on to the ones scrolled away past the cache's budget
+    if (drawnThumbs.size() > 2 * prefetchRows + 16)
+        repaintChangedThumbs();
+    
+    g.drawImage (thumb,
                  Rectangle<float>::leftTopRightBottom (0, 0, (float)width, (float)height),
                  0);
     
@@ -167,19 +180,46 @@ void FrameList::buttonClicked (juce::Button* buttonThatWasClicked)
 }
 
 //==============================================================================
-void FrameList::actionListenerCallback (const String& message)
+void FrameList::editorChanged (const EditorChanges& changes)
 {
-    if (message == EditorActions::framesChanged ||
-        message == EditorActions::frameThumbsChanged)
+    if (changes.has (EditorActions::framesChanged))
     {
+        drawnThumbs.clear();
         frameList->updateContent();
         frameList->repaint();
-        refresh();
     }
-    if (message == EditorActions::frameIndexChanged)
+    else if (changes.has (EditorActions::frameThumbsChanged))
+        repaintChangedThumbs();
+    
+    if (changes.has (EditorActions::framesChanged | EditorActions::frameIndexChanged))
         refresh();
 }
 
+//==============================================================================
+void FrameList::repaintChangedThumbs()
+{
+    auto* viewport = frameList->getViewport();
+    int rowHeight = frameList->getRowHeight();
+    int first = viewport->getViewPositionY() / rowHeight;
+    int last = jmin (frameEditor->getFrameCount() - 1,
+                     (viewport->getViewPositionY() + viewport->getViewHeight() - 1) / rowHeight);
+    
+    // Only rows on show whose thumbnail isn't the one they were drawn with,
+    // and forget the rest
+    HashMap<int, Image> onShow;
+    for (auto row = first; row <= last; ++row)
+    {
+        if (! drawnThumbs.contains (row))
+            continue;
+        
+        onShow.set (row, drawnThumbs[row]);
+        if (frameEditor->peekThumbNail ((uint16)row) != drawnThumbs[row])
+            frameList->repaintRow (row);
+    }
+    
+    drawnThumbs.swapWith (onShow);
+}
+
 //==============================================================================
 void FrameList::refresh()
 {
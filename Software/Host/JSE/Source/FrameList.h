@@ -28,7 +28,7 @@
 class FrameList  : public Component,
                    public ListBoxModel,
                    public Button::Listener,
-                   public ActionListener
+                   public EditorBus::Listener
 {
 public:
     FrameList (FrameEditor* frame);
@@ -52,10 +52,14 @@ public:
     void buttonClicked (juce::Button* buttonThatWasClicked) override;
 
     //==============================================================================
-    void actionListenerCallback (const String& message) override;
+    void editorChanged (const EditorChanges& changes) override;
 
 private:
     void refresh();
+    void repaintChangedThumbs();
+    
+    // Thumbnails prefetched either side of a row being painted
+    static const int prefetchRows = 4;
     
     FrameEditor* frameEditor;
     
@@ -69,5 +73,8 @@ private:
     std::unique_ptr<DrawableButton> downButton;
     std::unique_ptr<ListBox> frameList;
     
+    // The thumbnail each row was last painted with
+    HashMap<int, Image> drawnThumbs;
+    
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FrameList)
 };
@@ -0,0 +1,207 @@
+/*
+    FramePlayer.cpp
+    Plays the frames back as an animation at a steady rate
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "FramePlayer.h"
+
+// The timer thread checks the clock this often
+static const int tickMs = 1;
+
+// Frames never go by faster than this, however few points they have
+static const double minDuration = 1000.0 / 120.0;
+
+//==============================================================================
+FramePlayer::FramePlayer (FrameEditor* editor)
+: frameEditor (editor),
+  playing (false),
+  looping (true),
+  frameRate (0),
+  frameIndex (0),
+  shownDue (0),
+  nextDue (-1.0)
+{
+    resetStats();
+}
+
+FramePlayer::~FramePlayer()
+{
+    stopTimer();
+    cancelPendingUpdate();
+}
+
+//==============================================================================
+void FramePlayer::play()
+{
+    if (playing || ! frameEditor->getFrameCount())
+        return;
+    
+    playing = true;
+    frameIndex = jlimit (0, frameEditor->getFrameCount() - 1, frameIndex);
+    resetStats();
+    startClock();
+    startTimer (tickMs);
+}
+
+void FramePlayer::stop()
+{
+    if (! playing)
+        return;
+    
+    playing = false;
+    nextDue = -1.0;
+    stopTimer();
+    cancelPendingUpdate();
+    
+    if (onStopped != nullptr)
+        onStopped();
+}
+
+void FramePlayer::setFrameIndex (int index)
+{
+    frameIndex = jlimit (0, jmax (0, frameEditor->getFrameCount() - 1), index);
+    
+    if (playing)
+        startClock();
+}
+
+void FramePlayer::resetStats()
+{
+    framesShown = 0;
+    droppedFrames = 0;
+    jitterTotal = 0;
+    jitterMax = 0;
+    statsStart = Time::getMillisecondCounterHiRes();
+}
+
+double FramePlayer::getShownRate() const
+{
+    double elapsed = Time::getMillisecondCounterHiRes() - statsStart;
+    return elapsed > 0 ? framesShown * 1000.0 / elapsed : 0.0;
+}
+
+//==============================================================================
+double FramePlayer::getDuration (int index)
+{
+    if (frameRate > 0)
+        return 1000.0 / frameRate;
+    
+    // As long as one pass of the scanner takes
+    int points = frameEditor->getFrame ((uint16)index)->getPointCount();
+    return jmax (minDuration, points * 1000.0 / jmax ((uint32)1, frameEditor->getScanRate()));
+}
+
+int FramePlayer::getNextIndex (int index)
+{
+    if (index + 1 < frameEditor->getFrameCount())
+        return index + 1;
+    
+    return looping ? 0 : -1;
+}
+
+void FramePlayer::prefetch()
+{
+    int index = frameIndex;
+    for (auto n = 0; n < prefetchFrames; ++n)
+    {
+        index = getNextIndex (index);
+        if (index < 0 || index == frameIndex)
+            break;
+        
+        frameEditor->prefetchThumbNail ((uint16)index);
+    }
+}
+
+void FramePlayer::startClock()
+{
+    // The frame we're on counts as shown right now
+    shownDue = Time::getMillisecondCounterHiRes();
+    nextDue = shownDue + getDuration (frameIndex);
+    prefetch();
+    
+    if (onFrame != nullptr)
+        onFrame (frameIndex);
+}
+
+//==============================================================================
+void FramePlayer::hiResTimerCallback()
+{
+    double due = nextDue;
+    
+    // Only the once, the message thread sets the next one. If it just
+    // did, leave it for the next tick.
+    if (due >= 0 && Time::getMillisecondCounterHiRes() >= due
+        && nextDue.compare_exchange_strong (due, -1.0))
+        triggerAsyncUpdate();
+}
+
+void FramePlayer::handleAsyncUpdate()
+{
+    if (! playing)
+        return;
+    
+    // Frames may have come or gone underneath us
+    if (! frameEditor->getFrameCount())
+    {
+        stop();
+        return;
+    }
+    
+    frameIndex = jmin (frameIndex, frameEditor->getFrameCount() - 1);
+    
+    double now = Time::getMillisecondCounterHiRes();
+    double due = shownDue + getDuration (frameIndex);
+    int index = getNextIndex (frameIndex);
+    
+    // Skip the ones that are already over
+    int skipped = 0;
+    while (index >= 0 && now >= due + getDuration (index))
+    {
+        due += getDuration (index);
+        index = getNextIndex (index);
+        
+        // Hopelessly behind, start again from here
+        if (++skipped >= frameEditor->getFrameCount())
+        {
+            due = now;
+            break;
+        }
+    }
+    
+    droppedFrames += skipped;
+    
+    if (index < 0)
+    {
+        stop();
+        return;
+    }
+    
+    frameIndex = index;
+    shownDue = due;
+    
+    double jitter = std::abs (now - due);
+    jitterTotal += jitter;
+    jitterMax = jmax (jitterMax, jitter);
+    ++framesShown;
+    
+    if (onFrame != nullptr)
+        onFrame (frameIndex);
+    
+    prefetch();
+    
+    nextDue = jmax (shownDue + getDuration (frameIndex), now);
+}
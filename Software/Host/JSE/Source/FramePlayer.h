@@ -0,0 +1,99 @@
+/*
+    FramePlayer.h
+    Plays the frames back as an animation at a steady rate
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FrameEditor.h"
+
+// A high resolution timer thread watches the clock and wakes the message
+// thread when the next frame is due, where it's handed to onFrame. Frames
+// that were already over by then are skipped and counted as dropped.
+// The next few frames' thumbnails are built ahead on the ThreadPool so
+// showing one is just a cache hit.
+// Everything but the timer runs on the message thread.
+class FramePlayer : private HighResolutionTimer,
+                    private AsyncUpdater
+{
+public:
+    FramePlayer (FrameEditor* editor);
+    ~FramePlayer() override;
+    
+    // Starts from the frame at getFrameIndex()
+    void play();
+    void stop();
+    bool isPlaying() const { return playing; }
+    
+    // Scrubbing while playing carries on from there
+    void setFrameIndex (int index);
+    int getFrameIndex() const { return frameIndex; }
+    
+    void setLooping (bool loop) { looping = loop; }
+    bool isLooping() const { return looping; }
+    // Zero gives each frame as long as the scanner takes to draw it once
+    void setFrameRate (double fps) { frameRate = jmax (0.0, fps); }
+    double getFrameRate() const { return frameRate; }
+    
+    // Called with each frame as it's due
+    std::function<void (int index)> onFrame;
+    // Called when playback stops, asked to or by running off the end
+    std::function<void()> onStopped;
+    
+    // Counts since play() or resetStats
+    int getFramesShown() const { return framesShown; }
+    int getDroppedFrames() const { return droppedFrames; }
+    // How far off the due time frames were shown, in ms
+    double getMeanJitter() const { return framesShown ? jitterTotal / framesShown : 0.0; }
+    double getMaxJitter() const { return jitterMax; }
+    // Frames shown per second
+    double getShownRate() const;
+    void resetStats();
+    
+    // Thumbnails built ahead of the one showing
+    static const int prefetchFrames = 8;
+    
+private:
+    void hiResTimerCallback() override;
+    void handleAsyncUpdate() override;
+    
+    double getDuration (int index);
+    int getNextIndex (int index);
+    void prefetch();
+    void startClock();
+    
+    FrameEditor* frameEditor;
+    
+    bool playing;
+    bool looping;
+    double frameRate;
+    int frameIndex;
+    // When the frame showing was due
+    double shownDue;
+    
+    // Read by the timer thread, < 0 when nothing's waiting
+    std::atomic<double> nextDue;
+    
+    int framesShown;
+    int droppedFrames;
+    double jitterTotal;
+    double jitterMax;
+    double statsStart;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FramePlayer)
+};
@@ -842,6 +842,42 @@ private:
     FrameEditor* frameEditor;
 };
 
+class UndoableSetFrameData : public UndoableAction
+{
+public:
+    UndoableSetFrameData (FrameEditor* editor,
+                          const Array<FrameData>& data)
+    : newData (data), frameEditor (editor) {;}
+    
+    bool perform() override
+    {
+        frameEditor->incDirtyCounter();
+        oldData.clear();
+        for (auto n = 0; n < newData.size(); ++n)
+        {
+            FrameData d;
+            d.index = newData[n].index;
+            d.points = frameEditor->getFrame (d.index)->getPoints();
+            d.paths = frameEditor->getFrame (d.index)->getIPaths();
+            oldData.add (d);
+        }
+        frameEditor->_setFrameData (newData);
+        return true;
+    }
+    
+    bool undo() override
+    {
+        frameEditor->_setFrameData (oldData);
+        frameEditor->decDirtyCounter();
+        return true;
+    }
+    
+private:
+    Array<FrameData> oldData;
+    Array<FrameData> newData;
+    FrameEditor* frameEditor;
+};
+
 class UndoableSwapFrames : public UndoableAction
 {
 public:
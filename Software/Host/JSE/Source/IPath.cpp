@@ -23,39 +23,70 @@
 
 void IPath::addAnchor (const Anchor& a)
 {
+    // Drawing adds to the end a lot, so keep a built path going
+    if (! cache.dirty.load (std::memory_order_relaxed))
+    {
+        if (anchors.size())
+            addSegment (cache.path, anchors.getLast(), a);
+        else
+            cache.path.startNewSubPath ((float)a.getX(), (float)a.getY());
+    }
+    
     anchors.add (a);
-    buildPath();
 }
 
 void IPath::insertAnchor (int index, const Anchor& a)
 {
     anchors.insert (index, a);
-    buildPath();
+    cache.dirty = true;
 }
 
 void IPath::removeAnchor (int index)
 {
     anchors.remove (index);
-    buildPath();
+    cache.dirty = true;
 }
 
 void IPath::setAnchor (int index, const Anchor& a)
 {
     anchors.set (index, a);
-    buildPath();
+    cache.dirty = true;
 }
 
 void IPath::clearAllAnchors()
 {
     anchors.clear();
-    buildPath();
+    cache.path.clear();
+    cache.dirty = false;
+}
+
+void IPath::setAnchors (const Array<Anchor>& newAnchors)
+{
+    anchors = newAnchors;
+    cache.dirty = true;
+}
+
+const Path& IPath::getPath() const
+{
+    if (cache.dirty.load (std::memory_order_acquire))
+    {
+        const SpinLock::ScopedLockType lock (cache.lock);
+        if (cache.dirty.load (std::memory_order_relaxed))
+        {
+            buildPath();
+            cache.dirty.store (false, std::memory_order_release);
+        }
+    }
+    
+    return cache.path;
 }
 
 IPath IPath::reversed()
 {
     IPath ipath = *this;
     
-    ipath.clearAllAnchors();
+    Array<Anchor> reversedAnchors;
+    reversedAnchors.ensureStorageAllocated (anchors.size());
     
     for (auto n = anchors.size(); n > 0; --n)
     {
@@ -68,9 +99,11 @@ IPath IPath::reversed()
         a.setEntryPosition (exX, exY);
         a.setExitPosition (enX, enY);
         
-        ipath.addAnchor (a);
+        reversedAnchors.add (a);
     }
     
+    ipath.setAnchors (reversedAnchors);
+    
     ipath.setExtraPointsAtStart (extraPointsAtEnd);
     ipath.setExtraPointsAtEnd (extraPointsAtStart);
     ipath.setStartZ (endZ);
@@ -79,34 +112,35 @@ IPath IPath::reversed()
     return ipath;
 }
 
-void IPath::buildPath()
+void IPath::buildPath() const
 {
+    Path& path = cache.path;
     path.clear();
     
     if (anchors.size())
     {
-        Anchor last = getAnchor (0);
-        path.startNewSubPath ((float)last.getX(), (float)last.getY());
+        path.preallocateSpace (anchors.size() * 7 + 1);
+        path.startNewSubPath ((float)anchors.getReference (0).getX(),
+                              (float)anchors.getReference (0).getY());
         
         for (auto i = 1; i < anchors.size(); ++i)
-        {
-            Anchor next = getAnchor (i);
-
-            if (last.getExitXDelta() == 0 && last.getExitYDelta() == 0 &&
-                next.getEntryXDelta() == 0 && next.getEntryYDelta() == 0)
-                path.lineTo ((float)next.getX(), (float)next.getY());
-            else
-            {
-                int exitX, exitY;
-                int entryX, entryY;
-
-                last.getExitPosition (exitX, exitY);
-                next.getEntryPosition (entryX, entryY);
-                
-                path.cubicTo((float)exitX, (float)exitY, (float)entryX, (float)entryY, (float)next.getX(), (float)next.getY());
-            }
-            
-            last = next;
-        }
+            addSegment (path, anchors.getReference (i - 1), anchors.getReference (i));
+    }
+}
+
+void IPath::addSegment (Path& path, const Anchor& last, const Anchor& next)
+{
+    if (last.getExitXDelta() == 0 && last.getExitYDelta() == 0 &&
+        next.getEntryXDelta() == 0 && next.getEntryYDelta() == 0)
+        path.lineTo ((float)next.getX(), (float)next.getY());
+    else
+    {
+        int exitX, exitY;
+        int entryX, entryY;
+
+        last.getExitPosition (exitX, exitY);
+        next.getEntryPosition (entryX, entryY);
+        
+        path.cubicTo((float)exitX, (float)exitY, (float)entryX, (float)entryY, (float)next.getX(), (float)next.getY());
     }
 }
@@ -29,7 +29,8 @@ public:
         : color (c), startZ (0), endZ (0),
           pointDensity (1200), extraPointsPerAnchor(0),
           extraPointsAtStart (0), extraPointsAtEnd (0),
-          blankedPointsBeforeStart (3), blankedPointsAfterEnd (3) {;}
+          blankedPointsBeforeStart (3), blankedPointsAfterEnd (3),
+          blankMove (false) {;}
     ~IPath() {;}
     
     int getAnchorCount() const { return anchors.size(); }
@@ -41,7 +42,11 @@ public:
     void setAnchor (int index, const Anchor& a);
     void clearAllAnchors();
     
-    const Colour& getColor() { return color; }
+    // Replace every anchor at once, use this rather than a run of addAnchor
+    const Array<Anchor>& getAnchors() const { return anchors; }
+    void setAnchors (const Array<Anchor>& newAnchors);
+    
+    const Colour& getColor() const { return color; }
     void setColor (Colour c) { color = c; }
     
     uint16 getExtraPointsAtStart () const { return extraPointsAtStart; }
@@ -60,13 +65,42 @@ public:
     void setBlankedPointsBeforeStart (uint16 p) { blankedPointsBeforeStart = p; }
     uint16 getBlankedPointsAfterEnd() const { return blankedPointsAfterEnd; }
     void setBlankedPointsAfterEnd (uint16 p) { blankedPointsAfterEnd = p; }
+    
+    // Blanked jump connectIPaths put in, rendered from the frame editor's
+    // BlankMove profile between the first and last anchors
+    bool isBlankMove() const { return blankMove; }
+    void setBlankMove (bool b) { blankMove = b; }
 
-    const Path& getPath() const { return path; }
+    // Built on first use after the anchors change. Several threads may
+    // ask for the path of the same IPath at once.
+    const Path& getPath() const;
     
     IPath reversed();
 
 private:
-    void buildPath();
+    void buildPath() const;
+    static void addSegment (Path& p, const Anchor& last, const Anchor& next);
+    
+    // Only the path of a clean cache is copied, so copying never reads
+    // a path that another thread could be building
+    class PathCache
+    {
+    public:
+        PathCache() : dirty (false) {;}
+        PathCache (const PathCache& other) { *this = other; }
+        
+        PathCache& operator= (const PathCache& other)
+        {
+            bool d = other.dirty.load (std::memory_order_acquire);
+            path = d ? Path() : other.path;
+            dirty.store (d, std::memory_order_relaxed);
+            return *this;
+        }
+        
+        Path path;
+        std::atomic<bool> dirty;
+        SpinLock lock;
+    };
     
     Array<Anchor> anchors;
     Colour color;
@@ -78,6 +112,7 @@ private:
     uint16 extraPointsAtEnd;
     uint16 blankedPointsBeforeStart;
     uint16 blankedPointsAfterEnd;
+    bool blankMove;
     
-    Path path;
+    mutable PathCache cache;
 };
@@ -181,7 +181,6 @@ bool IldaLoader::load (ReferenceCountedArray<Frame>& frameArray, File& file)
         // Don't store palettes!
         if (header.format != 2)
         {
-            frame->buildThumbNail();
             frameArray.add (frame);
         }
     }
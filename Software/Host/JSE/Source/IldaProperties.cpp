@@ -25,7 +25,7 @@ IldaProperties::IldaProperties (FrameEditor* editor)
     : selectionColour (Colours::transparentBlack)
 {
     frameEditor = editor;
-    frameEditor->addActionListener (this);
+    frameEditor->addEditorListener (this);
     
     layerVisible.reset (new juce::ToggleButton ("layerVisible"));
     addAndMakeVisible (layerVisible.get());
@@ -440,6 +440,7 @@ IldaProperties::IldaProperties (FrameEditor* editor)
 
 IldaProperties::~IldaProperties()
 {
+    frameEditor->removeEditorListener (this);
     layerVisible = nullptr;
     drawLines = nullptr;
     showBlanking = nullptr;
@@ -601,28 +602,34 @@ void IldaProperties::buttonClicked (juce::Button* buttonThatWasClicked)
 
 //==============================================================================
 
-void IldaProperties::actionListenerCallback (const String& message)
+void IldaProperties::editorChanged (const EditorChanges& changes)
 {
-    if (message == EditorActions::ildaVisibilityChanged)
-        layerVisible->setToggleState (frameEditor->getIldaVisible(), dontSendNotification);
-    else if (message == EditorActions::ildaShowBlankChanged)
-        showBlanking->setToggleState (frameEditor->getIldaShowBlanked(), dontSendNotification);
-    else if (message == EditorActions::ildaDrawLinesChanged)
-        drawLines->setToggleState (frameEditor->getIldaDrawLines(), dontSendNotification);
-    else if (message == EditorActions::frameIndexChanged)
+    // Covers all the changes
+    if (changes.has (EditorActions::frameIndexChanged))
         refresh();
-    else if (message == EditorActions::ildaSelectionChanged)
-        updateSelection();
-    else if (message == EditorActions::ildaPointsChanged)
+    else
     {
-        updatePointDisplay();
-        updateSelection();
+        if (changes.has (EditorActions::ildaVisibilityChanged))
+            layerVisible->setToggleState (frameEditor->getIldaVisible(), dontSendNotification);
+        
+        if (changes.has (EditorActions::ildaShowBlankChanged))
+            showBlanking->setToggleState (frameEditor->getIldaShowBlanked(), dontSendNotification);
+        
+        if (changes.has (EditorActions::ildaDrawLinesChanged))
+            drawLines->setToggleState (frameEditor->getIldaDrawLines(), dontSendNotification);
+        
+        if (changes.has (EditorActions::ildaPointsChanged | EditorActions::scanRateChanged))
+            updatePointDisplay();
+        
+        if (changes.has (EditorActions::ildaPointsChanged | EditorActions::ildaSelectionChanged))
+            updateSelection();
+        
+        if (changes.has (EditorActions::ildaToolChanged | EditorActions::ildaPointToolColorChanged))
+            updateTools();
     }
-    else if (message == EditorActions::ildaToolChanged)
-        updateTools();
-    else if (message == EditorActions::ildaPointToolColorChanged)
-        updateTools();
-    else if (message == EditorActions::cancelRequest)
+    
+    // Requests always come on their own
+    if (changes.has (EditorActions::cancelRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::ilda)
         {
@@ -630,14 +637,14 @@ void IldaProperties::actionListenerCallback (const String& message)
                 frameEditor->setIldaSelection (SparseSet<uint16>());
         }
     }
-    else if (message == EditorActions::deleteRequest)
+    else if (changes.has (EditorActions::deleteRequest))
     {
         // Note, WorkingArea manages PointTool Response
         if (frameEditor->getActiveLayer() == FrameEditor::ilda &&
             frameEditor->getActiveIldaTool() == FrameEditor::selectTool)
             frameEditor->deletePoints();
     }
-    else if (message == EditorActions::upRequest)
+    else if (changes.has (EditorActions::upRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::ilda)
         {
@@ -647,7 +654,7 @@ void IldaProperties::actionListenerCallback (const String& message)
                 frameEditor->moveIldaSelected (0, 256, 0);
         }
     }
-    else if (message == EditorActions::downRequest)
+    else if (changes.has (EditorActions::downRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::ilda)
         {
@@ -657,7 +664,7 @@ void IldaProperties::actionListenerCallback (const String& message)
                 frameEditor->moveIldaSelected (0, -256, 0);
         }
     }
-    else if (message == EditorActions::leftRequest)
+    else if (changes.has (EditorActions::leftRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::ilda)
         {
@@ -667,7 +674,7 @@ void IldaProperties::actionListenerCallback (const String& message)
                 frameEditor->moveIldaSelected (-256, 0, 0);
         }
     }
-    else if (message == EditorActions::rightRequest)
+    else if (changes.has (EditorActions::rightRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::ilda)
         {
@@ -677,7 +684,7 @@ void IldaProperties::actionListenerCallback (const String& message)
                 frameEditor->moveIldaSelected (256, 0, 0);
         }
     }
-    else if (message == EditorActions::smallUpRequest)
+    else if (changes.has (EditorActions::smallUpRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::ilda)
         {
@@ -687,7 +694,7 @@ void IldaProperties::actionListenerCallback (const String& message)
                 frameEditor->moveIldaSelected (0, 16, 0);
         }
     }
-    else if (message == EditorActions::smallDownRequest)
+    else if (changes.has (EditorActions::smallDownRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::ilda)
         {
@@ -697,7 +704,7 @@ void IldaProperties::actionListenerCallback (const String& message)
                 frameEditor->moveIldaSelected (0, -16, 0);
         }
     }
-    else if (message == EditorActions::smallLeftRequest)
+    else if (changes.has (EditorActions::smallLeftRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::ilda)
         {
@@ -707,7 +714,7 @@ void IldaProperties::actionListenerCallback (const String& message)
                 frameEditor->moveIldaSelected (-16, 0, 0);
         }
     }
-    else if (message == EditorActions::smallRightRequest)
+    else if (changes.has (EditorActions::smallRightRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::ilda)
         {
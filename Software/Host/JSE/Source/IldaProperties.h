@@ -40,7 +40,7 @@
 class IldaProperties  : public Component,
                         public Button::Listener,
                         public TextEditor::Listener,
-                        public ActionListener,
+                        public EditorBus::Listener,
                         public ChangeListener
 {
 public:
@@ -55,7 +55,7 @@ public:
     void buttonClicked (juce::Button* buttonThatWasClicked) override;
 
     //==============================================================================
-    void actionListenerCallback (const String& message) override;
+    void editorChanged (const EditorChanges& changes) override;
 
     //==============================================================================
     void changeListenerCallback (ChangeBroadcaster* source) override;
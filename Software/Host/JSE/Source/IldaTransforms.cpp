@@ -0,0 +1,740 @@
+/*
+    IldaTransforms.cpp
+    Per-point ILDA transform kernels
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "IldaTransforms.h"
+#include "WorkerPool.h"
+#include "ColourLut.h"
+
+// The math below is kept exactly as the old single threaded loops had it
+// (same libm calls, same order, same casts) so results are bit identical.
+// Only loop invariants have been hoisted out.
+
+//==============================================================================
+void IldaTransforms::getCenter (const Array<Frame::IPoint>& points, int16& x, int16& y, int16& z)
+{
+    if (points.isEmpty())
+    {
+        x = y = z = 0;
+        return;
+    }
+
+    int minx, maxx, miny, maxy, minz, maxz;
+    minx = maxx = points.getReference (0).x.w;
+    miny = maxy = points.getReference (0).y.w;
+    minz = maxz = points.getReference (0).z.w;
+
+    for (auto n = 1; n < points.size(); ++n)
+    {
+        const Frame::IPoint& point = points.getReference (n);
+
+        if (point.x.w < minx)
+            minx = point.x.w;
+        else if (point.x.w > maxx)
+            maxx = point.x.w;
+
+        if (point.y.w < miny)
+            miny = point.y.w;
+        else if (point.y.w > maxy)
+            maxy = point.y.w;
+
+        if (point.z.w < minz)
+            minz = point.z.w;
+        else if (point.z.w > maxz)
+            maxz = point.z.w;
+    }
+
+    x = (int16)((minx + maxx) / 2);
+    y = (int16)((miny + maxy) / 2);
+    z = (int16)((minz + maxz) / 2);
+}
+
+//==============================================================================
+bool IldaTransforms::scale (Array<Frame::IPoint>& points,
+                            int xOffset, int yOffset, int zOffset,
+                            float xScale, float yScale, float zScale)
+{
+    Atomic<int> clipped;
+    Frame::IPoint* data = points.getRawDataPointer();
+
+    WorkerPool::forChunks (points.size(), minChunkSize, [&] (int start, int end)
+    {
+        bool chunkClipped = false;
+
+        for (auto n = start; n < end; ++n)
+        {
+            Frame::IPoint& point = data[n];
+
+            int x = point.x.w;
+            x -= xOffset;
+            x = (int)((float)x * xScale + 0.5f);
+            x += xOffset;
+            if (Frame::clipIlda (x))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.x.w = (int16)x;
+
+            int y = point.y.w;
+            y -= yOffset;
+            y = (int)((float)y * yScale + 0.5f);
+            y += yOffset;
+            if (Frame::clipIlda (y))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.y.w = (int16)y;
+
+            int z = point.z.w;
+            z -= zOffset;
+            z = (int)((float)z * zScale + 0.5f);
+            z += zOffset;
+            if (Frame::clipIlda (z))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.z.w = (int16)z;
+        }
+
+        if (chunkClipped)
+            clipped = 1;
+    });
+
+    return clipped.get() != 0;
+}
+
+static void Multiply3by3(double in1[3][3], double in2[3][3], double out[3][3])
+{
+    for (int col = 0 ; col < 3; ++col)
+    {
+        for (int row = 0; row < 3; ++row)
+        {
+            double d = 0;
+            d += in1[row][0] * in2[0][col];
+            d += in1[row][1] * in2[1][col];
+            d += in1[row][2] * in2[2][col];
+            out[row][col] = d;
+        }
+    }
+}
+
+bool IldaTransforms::rotate (Array<Frame::IPoint>& points,
+                             int xOffset, int yOffset, int zOffset,
+                             float xAngle, float yAngle, float zAngle)
+{
+    // Build our rotation matrices
+    double rx[3][3] = {{1, 0, 0},
+                       {0, 1, 0},
+                       {0, 0, 1}};
+    double ry[3][3] = {{1, 0, 0},
+                       {0, 1, 0},
+                       {0, 0, 1}};
+    double rz[3][3] = {{1, 0, 0},
+                       {0, 1, 0},
+                       {0, 0, 1}};
+
+    double rotX = xAngle < 0 ? 360.0 + xAngle : xAngle;
+    double rotY = yAngle < 0 ? 360.0 + yAngle : yAngle;
+    double rotZ = zAngle < 0 ? 360.0 + zAngle : zAngle;
+
+    // Clip X rotation
+    if (rotX > 359.9)
+        rotX = 0.0;
+
+    // Get sin and cos
+    const double pi = MathConstants<double>::pi;
+    double sin = ::sin (rotX * pi / 180.0);
+    double cos = ::cos (rotX * pi / 180.0);
+
+    rx[1][1] = cos;
+    rx[2][2] = cos;
+    rx[1][2] = sin;
+    rx[2][1] = 0 - sin;
+
+    // Repeat for Y
+    if (rotY > 359.9)
+        rotY = 0.0;
+
+    sin = ::sin (rotY * pi / 180.0);
+    cos = ::cos (rotY * pi / 180.0);
+
+    ry[0][0] = cos;
+    ry[2][2] = cos;
+    ry[2][0] = sin;
+    ry[0][2] = 0 - sin;
+
+    // And Z
+    if (rotZ > 359.9)
+        rotZ = 0.0;
+
+    sin = ::sin (rotZ * pi / 180.0);
+    cos = ::cos (rotZ * pi / 180.0);
+
+    rz[0][0] = cos;
+    rz[1][1] = cos;
+    rz[0][1] = 0 - sin;
+    rz[1][0] = sin;
+
+    double out1[3][3];
+    Multiply3by3(rx, ry, out1);
+    double out2[3][3];
+    Multiply3by3(out1, rz, out2);
+
+    Atomic<int> clipped;
+    Frame::IPoint* data = points.getRawDataPointer();
+
+    WorkerPool::forChunks (points.size(), minChunkSize, [&] (int start, int end)
+    {
+        bool chunkClipped = false;
+
+        for (auto n = start; n < end; ++n)
+        {
+            double d;
+            double dx, dy, dz;
+
+            Frame::IPoint& point = data[n];
+
+            dx = point.x.w - xOffset;
+            dy = point.y.w - yOffset;
+            dz = point.z.w - zOffset;
+
+            d = dx * out2[0][0] + dy * out2[1][0] + dz * out2[2][0];
+            int x = (int)d;
+            x += xOffset;
+            if (Frame::clipIlda (x))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.x.w = (int16)x;
+
+            d = dx * out2[0][1] + dy * out2[1][1] + dz * out2[2][1];
+            int y = (int)d;
+            y += yOffset;
+            if (Frame::clipIlda (y))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.y.w = (int16)y;
+
+            d = dx * out2[0][2] + dy * out2[1][2] + dz * out2[2][2];
+            int z = (int)d;
+            z += zOffset;
+            if (Frame::clipIlda (z))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.z.w = (int16)z;
+        }
+
+        if (chunkClipped)
+            clipped = 1;
+    });
+
+    return clipped.get() != 0;
+}
+
+bool IldaTransforms::shear (Array<Frame::IPoint>& points,
+                            Frame::ViewAngle view,
+                            int xOffset, int yOffset,
+                            float xShear, float yShear)
+{
+    AffineTransform matrix = AffineTransform::shear (xShear, yShear);
+    Atomic<int> clipped;
+    Frame::IPoint* data = points.getRawDataPointer();
+
+    WorkerPool::forChunks (points.size(), minChunkSize, [&] (int start, int end)
+    {
+        bool chunkClipped = false;
+
+        for (auto n = start; n < end; ++n)
+        {
+            Frame::IPoint& point = data[n];
+
+            int x = view == Frame::left ? point.z.w : point.x.w;
+            x -= xOffset;
+            int y = view == Frame::bottom ? point.z.w : point.y.w;
+            y -= yOffset;
+
+            matrix.transformPoint(x,y);
+
+            x += xOffset;
+            y += yOffset;
+
+            if (Frame::clipIlda (x))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            if (view == Frame::left)
+                point.z.w = (int16)x;
+            else
+                point.x.w = (int16)x;
+
+            if (Frame::clipIlda (y))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            if (view == Frame::bottom)
+                point.z.w = (int16)y;
+            else
+                point.y.w = (int16)y;
+        }
+
+        if (chunkClipped)
+            clipped = 1;
+    });
+
+    return clipped.get() != 0;
+}
+
+bool IldaTransforms::translate (Array<Frame::IPoint>& points,
+                                int xOffset, int yOffset, int zOffset)
+{
+    Atomic<int> clipped;
+    Frame::IPoint* data = points.getRawDataPointer();
+
+    WorkerPool::forChunks (points.size(), minChunkSize, [&] (int start, int end)
+    {
+        bool chunkClipped = false;
+
+        for (auto n = start; n < end; ++n)
+        {
+            Frame::IPoint& point = data[n];
+
+            int x = point.x.w;
+            x += xOffset;
+            if (Frame::clipIlda (x))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.x.w = (int16)x;
+
+            int y = point.y.w;
+            y += yOffset;
+            if (Frame::clipIlda (y))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.y.w = (int16)y;
+
+            int z = point.z.w;
+            z += zOffset;
+            if (Frame::clipIlda (z))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.z.w = (int16)z;
+        }
+
+        if (chunkClipped)
+            clipped = 1;
+    });
+
+    return clipped.get() != 0;
+}
+
+//==============================================================================
+bool IldaTransforms::barberPole (Array<Frame::IPoint>& points,
+                                 int xOffset, int yOffset,
+                                 float radius, float skew, float zAngle)
+{
+    double rz[3][3] = {{1, 0, 0},
+                       {0, 1, 0},
+                       {0, 0, 1}};
+
+    double rotZ = zAngle < 0 ? 360.0 + zAngle : zAngle;
+
+    // Clip X rotation
+    if (rotZ > 359.9)
+        rotZ = 0.0;
+
+    // Get sin and cos
+    const double pi = MathConstants<double>::pi;
+    double sin = ::sin (rotZ * pi / 180.0);
+    double cos = ::cos (rotZ * pi / 180.0);
+
+    rz[0][0] = cos;
+    rz[2][2] = cos;
+    rz[2][0] = sin;
+    rz[0][2] = 0 - sin;
+
+    AffineTransform matrix = AffineTransform::shear (0, skew);
+
+    double rad = (double)radius;
+    double theta = 1.0 / rad; // (2.0 * pi) / (2.0 * pi * rad);
+    Atomic<int> clipped;
+    Frame::IPoint* data = points.getRawDataPointer();
+
+    WorkerPool::forChunks (points.size(), minChunkSize, [&] (int start, int end)
+    {
+        bool chunkClipped = false;
+
+        for (auto n = start; n < end; ++n)
+        {
+            Frame::IPoint& point = data[n];
+
+            // fetch next point
+            int x = point.x.w;
+            x -= xOffset;
+            int y = point.y.w;
+            y -= yOffset;
+
+            // skew
+            matrix.transformPoint(x,y);
+
+            // wrap
+            double dx = 0 - ::cos ((double)x * theta) * rad;
+            double dy = (double)y;
+            double dz = ::sin ((double)x * theta) * rad;
+
+            // rotate
+            double d;
+            d = dx * rz[0][0] + dy * rz[1][0] + dz * rz[2][0];
+            x = (int)d;
+            x += xOffset;
+            if (Frame::clipIlda (x))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.x.w = (int16)x;
+
+            d = dx * rz[0][1] + dy * rz[1][1] + dz * rz[2][1];
+            y = (int)d;
+            y += yOffset;
+            if (Frame::clipIlda (y))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.y.w = (int16)y;
+
+            d = dx * rz[0][2] + dy * rz[1][2] + dz * rz[2][2];
+            int z = (int)d;
+            if (Frame::clipIlda (z))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.z.w = (int16)z;
+        }
+
+        if (chunkClipped)
+            clipped = 1;
+    });
+
+    return clipped.get() != 0;
+}
+
+bool IldaTransforms::bulge (Array<Frame::IPoint>& points,
+                            int xOffset, int yOffset,
+                            float radius, float gain)
+{
+    double dgain = gain;
+    double pow = 1.0 + (double)radius; // 0.01 to 1.99
+    Atomic<int> clipped;
+    Frame::IPoint* data = points.getRawDataPointer();
+
+    WorkerPool::forChunks (points.size(), minChunkSize, [&] (int start, int end)
+    {
+        bool chunkClipped = false;
+
+        for (auto n = start; n < end; ++n)
+        {
+            Frame::IPoint& point = data[n];
+
+            // fetch next point
+            int x = point.x.w;
+            x -= xOffset;
+            int y = point.y.w;
+            y -= yOffset;
+
+            double dx = x;
+            double dy = y;
+
+            // Distance
+            double r = ::sqrt ((dx * dx) + (dy * dy));
+            // Angle
+            double a = atan2 (dy, dx);
+
+            double rn = ::pow (r, pow);
+            double d;
+
+            d = cos(a) * rn;    // adjusted X
+            d *= dgain;
+            x = (int)d;
+            x += xOffset;
+            if (Frame::clipIlda (x))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.x.w = (int16)x;
+
+            d = sin(a) * rn;    // Adjusted Y
+            d *= dgain;
+            y = (int)d;
+            y += yOffset;
+            if (Frame::clipIlda (y))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.y.w = (int16)y;
+        }
+
+        if (chunkClipped)
+            clipped = 1;
+    });
+
+    return clipped.get() != 0;
+}
+
+bool IldaTransforms::spiral (Array<Frame::IPoint>& points,
+                             int xOffset, int yOffset,
+                             float angle, int eSize)
+{
+    double a = (double)angle;
+    double b = (double)eSize;
+    b *= b;
+    double es = (double)eSize;
+
+    Atomic<int> clipped;
+    Frame::IPoint* data = points.getRawDataPointer();
+
+    WorkerPool::forChunks (points.size(), minChunkSize, [&] (int start, int end)
+    {
+        bool chunkClipped = false;
+
+        for (auto n = start; n < end; ++n)
+        {
+            Frame::IPoint& point = data[n];
+            double dx = point.x.w - xOffset;
+            double dy = point.y.w - yOffset;
+            double dist = (dx * dx + dy * dy) / b;
+            double edist = ::exp (-dist);
+            double rad = a * edist;
+            double c = cos (rad);
+            double s = sin (rad);
+            double d;
+
+            d = c * dx + s * dy;
+            int x = (int)d;
+            x += xOffset;
+            if (Frame::clipIlda (x))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.x.w = (int16)x;
+
+            d = -s * dx + c * dy;
+            int y = (int)d;
+            y += yOffset;
+            if (Frame::clipIlda (y))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.y.w = (int16)y;
+
+            double ez = (double)point.z.w;
+            ez -= ((edist * es) / 2.0);
+            int z = (int)ez;
+            Frame::clipIlda (z);
+
+            point.z.w = (int16)z;
+        }
+
+        if (chunkClipped)
+            clipped = 1;
+    });
+
+    return clipped.get() != 0;
+}
+
+bool IldaTransforms::sphere (Array<Frame::IPoint>& points,
+                             int xOffset, int yOffset,
+                             double xScale, double yScale, double rScale)
+{
+    const double pi = MathConstants<double>::pi;
+    double xrad = (2.0 * pi) / 65536.0;
+    double yrad = pi / 65536.0;
+    double r = 65536.0 / (2.0 * pi);
+    r *= rScale;
+
+    Atomic<int> clipped;
+    Frame::IPoint* data = points.getRawDataPointer();
+
+    WorkerPool::forChunks (points.size(), minChunkSize, [&] (int start, int end)
+    {
+        bool chunkClipped = false;
+
+        for (auto n = start; n < end; ++n)
+        {
+            Frame::IPoint& point = data[n];
+            double dx = point.x.w - xOffset;
+            double dy = point.y.w - yOffset;
+            double lon = dx * xScale * xrad;
+            double lat = (32767.0 - (dy * yScale)) * yrad;
+            double sinLat = ::sin (lat);
+            double d;
+
+            d = r * ::sin (lon) * sinLat;
+            int x = (int)d;
+            x += xOffset;
+            if (Frame::clipIlda (x))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.x.w = (int16)x;
+
+            d = r * ::cos (lat);
+            int y = (int)d;
+            y += yOffset;
+            if (Frame::clipIlda (y))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.y.w = (int16)y;
+
+            d = r * sinLat * ::cos (lon);
+            int z = (int)d;
+            if (Frame::clipIlda (z))
+            {
+                Frame::blankPoint (point);
+                chunkClipped = true;
+            }
+            point.z.w = (int16)z;
+        }
+
+        if (chunkClipped)
+            clipped = 1;
+    });
+
+    return clipped.get() != 0;
+}
+
+//==============================================================================
+void IldaTransforms::gradient (Array<Frame::IPoint>& points,
+                               Frame::ViewAngle view,
+                               int xCenter, int yCenter,
+                               const Colour& color1, const Colour& color2,
+                               float angle, float length, bool radial,
+                               const Colour& color3)
+{
+    Point<float> center = Point<float> ((float)xCenter, (float)yCenter);
+
+    float flength = length * 32768.0f / 100.0f;
+    double rot = angle < 0 ? 360.0 + angle : angle;
+
+    // Clip rotation
+    if (rot > 359.9)
+        rot = 0.0;
+
+    // Convert to radians
+    const double pi = MathConstants<double>::pi;
+    float ang = (float)(rot * pi / 180.0);
+
+    // Build our line
+    Line<float> l1 = Line<float>::fromStartAndAngle (center, flength, ang);
+    Line<float> l2 = Line<float>::fromStartAndAngle (center, -flength, ang);
+    Line<float> line = Line<float>(l1.getEnd(), l2.getEnd());
+
+    // Make a color gradient
+    ColourGradient cg;
+    if (radial)
+        cg = ColourGradient(color1, 32768.0f, 32768.0f, color2, 32768.0f, 32768.0f - flength, true);
+    else
+        cg = ColourGradient (color1, line.getStartX(), line.getStartY(), color2, line.getEndX(), line.getEndY(), false);
+
+    if (color3.isOpaque())
+        cg.addColour (0.5, color3);
+
+    // Within 1 LSB of evaluating the gradient for every point
+    GradientLut lut (cg);
+    Frame::IPoint* data = points.getRawDataPointer();
+
+    // Walk the points
+    WorkerPool::forChunks (points.size(), minChunkSize, [&] (int start, int end)
+    {
+        for (auto n = start; n < end; ++n)
+        {
+            Frame::IPoint& point = data[n];
+
+            int x = Frame::getCompXInt (point, view);
+            int y = Frame::getCompYInt (point, view);
+
+            float proportion = 0.0;
+
+            if (radial)
+            {
+                Line<float> l(center.getX(), center.getY(), (float)x, (float)y);
+                proportion = flength / l.getLength();
+            }
+            else
+                proportion = line.findNearestProportionalPositionTo (Point<float> ((float)x, (float)y));
+
+            const Colour& c = lut.getColourAtPosition (proportion);
+            point.red = c.getRed();
+            point.green = c.getGreen();
+            point.blue = c.getBlue();
+
+            if (c == Colours::black)
+                point.status = Frame::BlankedPoint;
+            else
+                point.status = 0;
+        }
+    });
+}
+
+void IldaTransforms::adjustHue (Array<Frame::IPoint>& points,
+                                float hshift, float saturation, float brightness)
+{
+    ColourLut lut ([=] (const Colour& colour)
+    {
+        Colour c = colour.withRotatedHue (hshift);
+        float sat = c.getSaturation() + saturation;
+        if (sat < 0.0f)
+            sat = 0.0f;
+        else if (sat > 1.0f)
+            sat = 1.0f;
+        c = c.withSaturation (sat);
+
+        float b = c.getBrightness() + brightness;
+        if (b < 0.0f)
+            b = 0.0f;
+        else if (b > 1.0f)
+            b = 1.0f;
+        return c.withBrightness (b);
+    });
+
+    lut.apply (points);
+}
@@ -0,0 +1,79 @@
+/*
+    IldaTransforms.h
+    Per-point ILDA transform kernels
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Frame.h"
+
+// Kernels work on the points in place and are split over the WorkerPool.
+// Each returns true if any point got clipped (clipped points are blanked).
+class IldaTransforms
+{
+public:
+    // Center of the bounding box of the points, 0,0,0 if there are none
+    static void getCenter (const Array<Frame::IPoint>& points, int16& x, int16& y, int16& z);
+
+    static bool scale (Array<Frame::IPoint>& points,
+                       int xOffset, int yOffset, int zOffset,
+                       float xScale, float yScale, float zScale);
+
+    static bool rotate (Array<Frame::IPoint>& points,
+                        int xOffset, int yOffset, int zOffset,
+                        float xAngle, float yAngle, float zAngle);
+
+    // Shears in the plane of the given view
+    static bool shear (Array<Frame::IPoint>& points,
+                       Frame::ViewAngle view,
+                       int xOffset, int yOffset,
+                       float xShear, float yShear);
+
+    static bool translate (Array<Frame::IPoint>& points,
+                           int xOffset, int yOffset, int zOffset);
+
+    static bool barberPole (Array<Frame::IPoint>& points,
+                            int xOffset, int yOffset,
+                            float radius, float skew, float zAngle);
+
+    static bool bulge (Array<Frame::IPoint>& points,
+                       int xOffset, int yOffset,
+                       float radius, float gain);
+
+    static bool spiral (Array<Frame::IPoint>& points,
+                        int xOffset, int yOffset,
+                        float angle, int eSize);
+
+    static bool sphere (Array<Frame::IPoint>& points,
+                        int xOffset, int yOffset,
+                        double xScale, double yScale, double rScale);
+
+    // Color kernels never clip, xCenter and yCenter are in component space
+    static void gradient (Array<Frame::IPoint>& points,
+                          Frame::ViewAngle view,
+                          int xCenter, int yCenter,
+                          const Colour& color1, const Colour& color2,
+                          float angle, float length, bool radial,
+                          const Colour& color3);
+
+    static void adjustHue (Array<Frame::IPoint>& points,
+                           float hshift, float saturation, float brightness);
+
+    // Smallest number of points worth handing to another thread
+    static const int minChunkSize = 2048;
+};
@@ -0,0 +1,480 @@
+/*
+    ImageTracer.cpp
+    Traces the reference image into sketch paths
+ 
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#include "ImageTracer.h"
+#include "Frame.h"
+#include "CurveFit.h"
+#include "WorkerPool.h"
+
+//==============================================================================
+// The brightness map blurred by one smoothing
+class ImageTracer::Level
+{
+public:
+    float smoothing;
+    std::vector<float> values;
+    uint32 lastUse;
+};
+
+//==============================================================================
+ImageTracer::ImageTracer()
+: width (0), height (0), useCount (0), traceTime (0.0), blurTime (0.0)
+{
+}
+
+ImageTracer::~ImageTracer()
+{
+}
+
+void ImageTracer::clear()
+{
+    source = nullptr;
+    width = height = 0;
+    brightness.clear();
+    levels.clear();
+}
+
+void ImageTracer::setImage (const Image& image, const AffineTransform& toSketch)
+{
+    if (! image.isValid())
+    {
+        clear();
+        return;
+    }
+    
+    // Pixels traced are box filtered blocks of the image, sampled in the middle
+    int block = jmax (1, (jmax (image.getWidth(), image.getHeight()) + maxSize - 1) / maxSize);
+    pixelToSketch = AffineTransform::translation (0.5f, 0.5f)
+                    .scaled ((float)block)
+                    .followedBy (toSketch);
+    
+    if (image.getPixelData() == source.get())
+        return;
+    
+    clear();
+    source = image.getPixelData();
+    width = image.getWidth() / block;
+    height = image.getHeight() / block;
+    if (width < 2 || height < 2)
+    {
+        clear();
+        return;
+    }
+    
+    brightness.resize ((size_t)(width * height));
+    Image::BitmapData bitmap (image, Image::BitmapData::readOnly);
+    float scale = 1.0f / (float)(block * block);
+    
+    WorkerPool::forChunks (height, 16, [this, &bitmap, block, scale] (int start, int end)
+    {
+        for (auto y = start; y < end; ++y)
+        {
+            for (auto x = 0; x < width; ++x)
+            {
+                float sum = 0.0f;
+                for (auto by = 0; by < block; ++by)
+                {
+                    for (auto bx = 0; bx < block; ++bx)
+                    {
+                        // Over black, like the working area
+                        Colour c = bitmap.getPixelColour (x * block + bx, y * block + by);
+                        sum += c.getPerceivedBrightness() * c.getFloatAlpha();
+                    }
+                }
+                
+                brightness[(size_t)(y * width + x)] = sum * scale;
+            }
+        }
+    });
+}
+
+//==============================================================================
+const ImageTracer::Level& ImageTracer::getLevel (float smoothing)
+{
+    for (auto l : levels)
+    {
+        if (l->smoothing == smoothing)
+        {
+            l->lastUse = ++useCount;
+            return *l;
+        }
+    }
+    
+    // Only keep a few about
+    if (levels.size() >= 4)
+    {
+        int oldest = 0;
+        for (auto n = 1; n < levels.size(); ++n)
+            if (levels[n]->lastUse < levels[oldest]->lastUse)
+                oldest = n;
+        
+        levels.remove (oldest);
+    }
+    
+    double startTime = Time::getMillisecondCounterHiRes();
+    
+    Level* level = levels.add (new Level());
+    level->smoothing = smoothing;
+    level->lastUse = ++useCount;
+    level->values = brightness;
+    
+    if (smoothing >= 0.25f)
+    {
+        // Gaussian, one way then the other
+        int radius = (int)std::ceil (smoothing * 3.0f);
+        std::vector<float> kernel ((size_t)(radius * 2 + 1));
+        float total = 0.0f;
+        for (auto i = -radius; i <= radius; ++i)
+        {
+            kernel[(size_t)(i + radius)] = std::exp (-(float)(i * i) / (2.0f * smoothing * smoothing));
+            total += kernel[(size_t)(i + radius)];
+        }
+        
+        for (auto& k : kernel)
+            k /= total;
+        
+        std::vector<float> across (brightness.size());
+        std::vector<float>& out = level->values;
+        
+        WorkerPool::forChunks (height, 16, [this, &kernel, &across, radius] (int start, int end)
+        {
+            for (auto y = start; y < end; ++y)
+            {
+                const float* row = brightness.data() + y * width;
+                for (auto x = 0; x < width; ++x)
+                {
+                    float sum = 0.0f;
+                    for (auto i = -radius; i <= radius; ++i)
+                        sum += kernel[(size_t)(i + radius)] * row[jlimit (0, width - 1, x + i)];
+                    
+                    across[(size_t)(y * width + x)] = sum;
+                }
+            }
+        });
+        
+        WorkerPool::forChunks (height, 16, [this, &kernel, &across, &out, radius] (int start, int end)
+        {
+            for (auto y = start; y < end; ++y)
+            {
+                float* row = out.data() + y * width;
+                std::fill (row, row + width, 0.0f);
+                
+                for (auto i = -radius; i <= radius; ++i)
+                {
+                    float k = kernel[(size_t)(i + radius)];
+                    const float* from = across.data() + jlimit (0, height - 1, y + i) * width;
+                    for (auto x = 0; x < width; ++x)
+                        row[x] += k * from[x];
+                }
+            }
+        });
+    }
+    
+    blurTime = Time::getMillisecondCounterHiRes() - startTime;
+    return *level;
+}
+
+//==============================================================================
+// Marching squares. Crossings sit on the edges between samples: edge
+// y * (width - 1) + x runs across from sample x,y and the ones after all
+// the across edges run down from it.
+void ImageTracer::findOutlines (const Level& level, float threshold,
+                                Array<Array<Point<float>>>& outlines)
+{
+    const float* v = level.values.data();
+    int across = (width - 1) * height;
+    int edgeCount = across + width * (height - 1);
+    
+    // Two edges joined up in each cell, more than one pair on saddles
+    Array<int> segments;
+    CriticalSection lock;
+    
+    WorkerPool::forChunks (height - 1, 16, [&] (int start, int end)
+    {
+        Array<int> band;
+        
+        for (auto y = start; y < end; ++y)
+        {
+            for (auto x = 0; x < width - 1; ++x)
+            {
+                float tl = v[y * width + x];
+                float tr = v[y * width + x + 1];
+                float br = v[(y + 1) * width + x + 1];
+                float bl = v[(y + 1) * width + x];
+                
+                int cell = (tl >= threshold ? 8 : 0) | (tr >= threshold ? 4 : 0)
+                         | (br >= threshold ? 2 : 0) | (bl >= threshold ? 1 : 0);
+                
+                if (cell == 0 || cell == 15)
+                    continue;
+                
+                int top = y * (width - 1) + x;
+                int bottom = top + width - 1;
+                int left = across + y * width + x;
+                int right = left + 1;
+                
+                // Saddles go by the middle
+                bool middle = (tl + tr + br + bl) / 4.0f >= threshold;
+                
+                switch (cell)
+                {
+                    case 1:  case 14: band.add (left);  band.add (bottom); break;
+                    case 2:  case 13: band.add (bottom); band.add (right); break;
+                    case 3:  case 12: band.add (left);  band.add (right);  break;
+                    case 4:  case 11: band.add (top);   band.add (right);  break;
+                    case 6:  case 9:  band.add (top);   band.add (bottom); break;
+                    case 7:  case 8:  band.add (left);  band.add (top);    break;
+                    case 5:
+                        if (middle)
+                        {
+                            band.add (left); band.add (top);
+                            band.add (bottom); band.add (right);
+                        }
+                        else
+                        {
+                            band.add (top); band.add (right);
+                            band.add (left); band.add (bottom);
+                        }
+                        break;
+                    case 10:
+                        if (middle)
+                        {
+                            band.add (top); band.add (right);
+                            band.add (left); band.add (bottom);
+                        }
+                        else
+                        {
+                            band.add (left); band.add (top);
+                            band.add (bottom); band.add (right);
+                        }
+                        break;
+                    default:
+                        break;
+                }
+            }
+        }
+        
+        const ScopedLock l (lock);
+        segments.addArray (band);
+    });
+    
+    // Each crossing joins at most two cells
+    links.assign ((size_t)edgeCount * 2, -1);
+    visited.assign ((size_t)edgeCount, 0);
+    
+    for (auto n = 0; n < segments.size(); n += 2)
+    {
+        int a = segments[n];
+        int b = segments[n + 1];
+        links[(size_t)a * 2 + (links[(size_t)a * 2] == -1 ? 0 : 1)] = b;
+        links[(size_t)b * 2 + (links[(size_t)b * 2] == -1 ? 0 : 1)] = a;
+    }
+    
+    auto crossing = [v, threshold, across, this] (int edge)
+    {
+        bool down = edge >= across;
+        int e = down ? edge - across : edge;
+        int x = down ? e % width : e % (width - 1);
+        int y = down ? e / width : e / (width - 1);
+        float from = v[y * width + x];
+        float to = down ? v[(y + 1) * width + x] : v[y * width + x + 1];
+        float t = to != from ? jlimit (0.0f, 1.0f, (threshold - from) / (to - from)) : 0.5f;
+        return down ? Point<float> ((float)x, (float)y + t) : Point<float> ((float)x + t, (float)y);
+    };
+    
+    auto follow = [this, &crossing] (int edge, Array<Point<float>>& outline)
+    {
+        int last = -1;
+        int start = edge;
+        
+        while (edge != -1 && ! visited[(size_t)edge])
+        {
+            visited[(size_t)edge] = 1;
+            outline.add (crossing (edge));
+            
+            int next = links[(size_t)edge * 2];
+            if (next == last || next == -1)
+                next = links[(size_t)edge * 2 + 1];
+            
+            last = edge;
+            edge = next;
+        }
+        
+        // Back round to the start
+        if (edge == start && outline.size() > 2)
+            outline.add (outline.getFirst());
+    };
+    
+    // Outlines that run off the image first, from one of their ends
+    for (auto n = 0; n < segments.size(); ++n)
+    {
+        int e = segments[n];
+        if (! visited[(size_t)e] && links[(size_t)e * 2 + 1] == -1)
+        {
+            Array<Point<float>> outline;
+            follow (e, outline);
+            outlines.add (outline);
+        }
+    }
+    
+    // Then the loops
+    for (auto n = 0; n < segments.size(); ++n)
+    {
+        int e = segments[n];
+        if (! visited[(size_t)e])
+        {
+            Array<Point<float>> outline;
+            follow (e, outline);
+            outlines.add (outline);
+        }
+    }
+}
+
+//==============================================================================
+// Ramer-Douglas-Peucker, marks the points worth keeping
+static void simplify (const Array<Point<float>>& points, float tolerance, Array<int>& keep)
+{
+    keep.clearQuick();
+    
+    Array<bool> kept;
+    kept.insertMultiple (0, false, points.size());
+    kept.set (0, true);
+    kept.set (points.size() - 1, true);
+    
+    Array<std::pair<int, int>> ranges;
+    ranges.add (std::make_pair (0, points.size() - 1));
+    
+    while (ranges.size())
+    {
+        std::pair<int, int> r = ranges.removeAndReturn (ranges.size() - 1);
+        Line<float> chord (points.getReference (r.first), points.getReference (r.second));
+        
+        float furthest = 0.0f;
+        int split = -1;
+        Point<float> onChord;
+        for (auto n = r.first + 1; n < r.second; ++n)
+        {
+            // Closed outlines start and end on the same point, that's fine
+            float d = chord.getDistanceFromPoint (points.getReference (n), onChord);
+            if (d > furthest)
+            {
+                furthest = d;
+                split = n;
+            }
+        }
+        
+        if (split != -1 && furthest > tolerance)
+        {
+            kept.set (split, true);
+            ranges.add (std::make_pair (r.first, split));
+            ranges.add (std::make_pair (split, r.second));
+        }
+    }
+    
+    for (auto n = 0; n < kept.size(); ++n)
+        if (kept[n])
+            keep.add (n);
+}
+
+void ImageTracer::trace (float threshold, float smoothing, float minLength,
+                         const Colour& color, Array<IPath>& paths)
+{
+    paths.clear();
+    blurTime = 0.0;
+    if (! hasImage())
+        return;
+    
+    double startTime = Time::getMillisecondCounterHiRes();
+    
+    const Level& level = getLevel (smoothing);
+    Array<Array<Point<float>>> outlines;
+    findOutlines (level, threshold, outlines);
+    
+    Array<IPath> traced;
+    traced.resize (outlines.size());
+    AffineTransform toSketch = pixelToSketch;
+    
+    WorkerPool::forChunks (outlines.size(), 8, [&outlines, &traced, &toSketch, minLength, color] (int start, int end)
+    {
+        Array<int> keep;
+        Array<float> lengths;
+        
+        for (auto n = start; n < end; ++n)
+        {
+            Array<Point<float>>& outline = outlines.getReference (n);
+            if (outline.size() < 2)
+                continue;
+            
+            float pixels = 0.0f;
+            for (auto i = 1; i < outline.size(); ++i)
+                pixels += outline[i - 1].getDistanceFrom (outline[i]);
+            
+            if (pixels < minLength)
+                continue;
+            
+            // A fraction of a pixel off is as close as the blur allows anyway
+            simplify (outline, 0.75f, keep);
+            
+            // Fit in sketch space, along the whole outline
+            Path path;
+            lengths.clearQuick();
+            float length = 0.0f;
+            for (auto i = 0; i < outline.size(); ++i)
+            {
+                Point<float> p = outline[i].transformedBy (toSketch);
+                if (i)
+                {
+                    length += path.getCurrentPosition().getDistanceFrom (p);
+                    path.lineTo (p);
+                }
+                else
+                    path.startNewSubPath (p);
+                
+                lengths.add (length);
+            }
+            
+            CurveFit fitter (path);
+            Array<Anchor> anchors;
+            anchors.insertMultiple (0, Anchor(), keep.size());
+            for (auto k = 0; k < keep.size() - 1; ++k)
+                fitter.fit (lengths[keep[k]], lengths[keep[k + 1]],
+                            anchors.getReference (k), anchors.getReference (k + 1));
+            
+            IPath& ipath = traced.getReference (n);
+            ipath.setColor (color);
+            for (auto& a : anchors)
+            {
+                int x = a.getX();
+                int y = a.getY();
+                Frame::clipSketch (x);
+                Frame::clipSketch (y);
+                a.setX (x);
+                a.setY (y);
+            }
+            ipath.setAnchors (anchors);
+        }
+    });
+    
+    for (auto& p : traced)
+        if (p.getAnchorCount() > 1)
+            paths.add (p);
+    
+    traceTime = Time::getMillisecondCounterHiRes() - startTime;
+}
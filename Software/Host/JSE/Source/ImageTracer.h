@@ -0,0 +1,78 @@
+/*
+    ImageTracer.h
+    Traces the reference image into sketch paths
+ 
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "IPath.h"
+
+// Follows the outlines where the (blurred) brightness of the image crosses
+// a threshold, thins them out to the points that matter and fits cubics
+// between those with CurveFit.
+// The brightness map and its blurred copies are kept, so going back to a
+// smoothing that's been used recently only costs the contour pass. Every
+// pass is split into bands of rows over the WorkerPool.
+class ImageTracer
+{
+public:
+    ImageTracer();
+    ~ImageTracer();
+    
+    // Costs nothing if it's the image we already have. toSketch maps the
+    // image's pixels to sketch space.
+    void setImage (const Image& image, const AffineTransform& toSketch);
+    void clear();
+    bool hasImage() const { return width > 0; }
+    
+    // threshold is a brightness from 0 to 1, smoothing the blur radius and
+    // minLength the shortest outline kept, both in traced pixels
+    void trace (float threshold, float smoothing, float minLength,
+                const Colour& color, Array<IPath>& paths);
+    
+    // Time the last trace took and how much of it went on blurring
+    double getTraceTime() const { return traceTime; }
+    double getBlurTime() const { return blurTime; }
+    
+    // Bigger images are traced from a box filtered copy this size across
+    static const int maxSize = 1024;
+    
+private:
+    class Level;
+    
+    const Level& getLevel (float smoothing);
+    void findOutlines (const Level& level, float threshold, Array<Array<Point<float>>>& outlines);
+    
+    ImagePixelData::Ptr source;
+    AffineTransform pixelToSketch;
+    int width;
+    int height;
+    std::vector<float> brightness;
+    OwnedArray<Level> levels;
+    uint32 useCount;
+    
+    // Reused between traces
+    std::vector<int> links;
+    std::vector<uint8> visited;
+    
+    double traceTime;
+    double blurTime;
+    
+    JUCE_DECLARE_NON_COPYABLE (ImageTracer)
+};
@@ -45,6 +45,7 @@ namespace JSEFile
     const Identifier ExtraAtEnd     ("ExtraAtEnd");
     const Identifier BlanksBefore   ("BlanksBefore");
     const Identifier BlanksAfter    ("BlanksAfter");
+    const Identifier BlankMove      ("BlankMove");
     const Identifier StartZ         ("StartZ");
     const Identifier EndZ           ("EndZ");
     const Identifier Anchors        ("Anchors");
@@ -119,12 +119,17 @@ bool JSEFileLoader::load (ReferenceCountedArray<Frame>& frameArray, File& file)
                 path.setExtraPointsAtEnd ((uint16)(int)pathData->getProperty (JSEFile::ExtraAtEnd));
                 path.setBlankedPointsBeforeStart ((uint16)(int)pathData->getProperty (JSEFile::BlanksBefore));
                 path.setBlankedPointsAfterEnd ((uint16)(int)pathData->getProperty (JSEFile::BlanksAfter));
+                // Older files don't have it
+                path.setBlankMove (pathData->getProperty (JSEFile::BlankMove));
                 path.setStartZ (pathData->getProperty (JSEFile::StartZ));
                 path.setEndZ (pathData->getProperty (JSEFile::EndZ));
                 
                 var anchors = pathData->getProperty (JSEFile::Anchors);
                 if (anchors.isArray())
                 {
+                    Array<Anchor> pathAnchors;
+                    pathAnchors.ensureStorageAllocated (anchors.getArray()->size());
+                    
                     for (auto j = 0; j < anchors.getArray()->size(); ++j)
                     {
                         DynamicObject* anchorData = anchors[j].getDynamicObject();
@@ -138,16 +143,17 @@ bool JSEFileLoader::load (ReferenceCountedArray<Frame>& frameArray, File& file)
                         int exX = anchorData->getProperty (JSEFile::AnchorExitX);
                         int exY = anchorData->getProperty (JSEFile::AnchorExitY);
 
-                        path.addAnchor (Anchor (x, y, enX, enY, exX, exY));
+                        pathAnchors.add (Anchor (x, y, enX, enY, exX, exY));
                     }
+                    
+                    path.setAnchors (pathAnchors);
                 }
                 
                 frame->addPath (path);
             }
         }
 
-        // Build the thumbnail and add the frame
-        frame->buildThumbNail();
+        // Add the frame, the thumbnail is built when it's first shown
         frameArray.add (frame);
     }
 
@@ -120,6 +120,7 @@ var JSEFileSaver::ipathToObj (uint16 frameIndex, uint16 pathIndex)
     obj->setProperty (JSEFile::ExtraAtEnd, path.getExtraPointsAtEnd());
     obj->setProperty (JSEFile::BlanksBefore, path.getBlankedPointsBeforeStart());
     obj->setProperty (JSEFile::BlanksAfter, path.getBlankedPointsAfterEnd());
+    obj->setProperty (JSEFile::BlankMove, path.isBlankMove());
     obj->setProperty (JSEFile::StartZ, path.getStartZ());
     obj->setProperty (JSEFile::EndZ, path.getEndZ());
 
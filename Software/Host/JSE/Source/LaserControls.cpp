@@ -20,46 +20,376 @@
 #include <JuceHeader.h>
 #include "LaserControls.h"
 
+// Display rate the preview is sampled at
+static const int previewHz = 30;
+
 //==============================================================================
 LaserControls::LaserControls (FrameEditor* frame)
+: player (frame)
 {
     frameEditor = frame;
-    frameEditor->addActionListener (this);
+    frameEditor->addEditorListener (this);
+
+    playButton.reset (new juce::TextButton ("playButton"));
+    addAndMakeVisible (playButton.get());
+    playButton->setButtonText ("Play");
+    playButton->setTooltip ("Play the frames as an animation");
+    playButton->setClickingTogglesState (true);
+    playButton->addListener (this);
+
+    loopButton.reset (new juce::TextButton ("loopButton"));
+    addAndMakeVisible (loopButton.get());
+    loopButton->setButtonText ("Loop");
+    loopButton->setTooltip ("Go back to the first frame after the last one");
+    loopButton->setClickingTogglesState (true);
+    loopButton->setToggleState (player.isLooping(), dontSendNotification);
+    loopButton->addListener (this);
+
+    scrubSlider.reset (new juce::Slider ("scrubSlider"));
+    addAndMakeVisible (scrubSlider.get());
+    scrubSlider->setTooltip (TRANS("Frame being shown"));
+    scrubSlider->setSliderStyle (juce::Slider::LinearHorizontal);
+    scrubSlider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 48, 20);
+    scrubSlider->setColour (juce::Slider::backgroundColourId, juce::Colour (0xff0d1112));
+    scrubSlider->addListener (this);
+
+    fpsSlider.reset (new juce::Slider ("fpsSlider"));
+    addAndMakeVisible (fpsSlider.get());
+    fpsSlider->setTooltip (TRANS("Frames per second to play at, Auto shows each frame as long as the scanner takes to draw it"));
+    fpsSlider->setRange (0, 60, 1);
+    fpsSlider->setSliderStyle (juce::Slider::LinearHorizontal);
+    fpsSlider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 48, 20);
+    fpsSlider->setColour (juce::Slider::backgroundColourId, juce::Colour (0xff0d1112));
+    fpsSlider->textFromValueFunction = [] (double value) { return value > 0 ? String ((int)value) : String ("Auto"); };
+    fpsSlider->valueFromTextFunction = [] (const String& text) { return text.getDoubleValue(); };
+    fpsSlider->setValue (player.getFrameRate(), dontSendNotification);
+    fpsSlider->updateText();
+    fpsSlider->addListener (this);
+
+    fpsLabel.reset (new juce::Label ("fpsLabel", TRANS("FPS")));
+    addAndMakeVisible (fpsLabel.get());
+    fpsLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+    fpsLabel->setJustificationType (juce::Justification::centredLeft);
+
+    playStatsLabel.reset (new juce::Label ("playStatsLabel"));
+    addAndMakeVisible (playStatsLabel.get());
+    playStatsLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+    playStatsLabel->setJustificationType (juce::Justification::centredLeft);
+    playStatsLabel->setMinimumHorizontalScale (0.5f);
+
+    scanButton.reset (new juce::TextButton ("scanButton"));
+    addAndMakeVisible (scanButton.get());
+    scanButton->setButtonText ("Scan");
+    scanButton->setTooltip ("Play the frames the way the scanner would draw them");
+    scanButton->setClickingTogglesState (true);
+    scanButton->addListener (this);
+
+    rateSlider.reset (new juce::Slider ("rateSlider"));
+    addAndMakeVisible (rateSlider.get());
+    rateSlider->setTooltip (TRANS("Points per second the scanner runs at"));
+    rateSlider->setRange (5000, 60000, 1000);
+    rateSlider->setSliderStyle (juce::Slider::LinearHorizontal);
+    rateSlider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 48, 20);
+    rateSlider->setColour (juce::Slider::backgroundColourId, juce::Colour (0xff0d1112));
+    rateSlider->setValue (frameEditor->getScanRate(), dontSendNotification);
+    rateSlider->addListener (this);
+
+    rateLabel.reset (new juce::Label ("rateLabel", TRANS("PPS")));
+    addAndMakeVisible (rateLabel.get());
+    rateLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+    rateLabel->setJustificationType (juce::Justification::centredLeft);
+
+    lagSlider.reset (new juce::Slider ("lagSlider"));
+    addAndMakeVisible (lagSlider.get());
+    lagSlider->setTooltip (TRANS("How far behind the mirrors trail the points, in microseconds"));
+    lagSlider->setRange (0, 500, 10);
+    lagSlider->setSliderStyle (juce::Slider::LinearHorizontal);
+    lagSlider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 48, 20);
+    lagSlider->setColour (juce::Slider::backgroundColourId, juce::Colour (0xff0d1112));
+    lagSlider->setValue (simulator.getGalvoLag(), dontSendNotification);
+    lagSlider->addListener (this);
+
+    lagLabel.reset (new juce::Label ("lagLabel", TRANS("Lag")));
+    addAndMakeVisible (lagLabel.get());
+    lagLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+    lagLabel->setJustificationType (juce::Justification::centredLeft);
+
+    offsetSlider.reset (new juce::Slider ("offsetSlider"));
+    addAndMakeVisible (offsetSlider.get());
+    offsetSlider->setTooltip (TRANS("Points the colour turns on late (or early if negative)"));
+    offsetSlider->setRange (-ScanSimulator::maxOffset, ScanSimulator::maxOffset, 1);
+    offsetSlider->setSliderStyle (juce::Slider::LinearHorizontal);
+    offsetSlider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 48, 20);
+    offsetSlider->setColour (juce::Slider::backgroundColourId, juce::Colour (0xff0d1112));
+    offsetSlider->setValue (simulator.getBlankingOffset(), dontSendNotification);
+    offsetSlider->addListener (this);
+
+    offsetLabel.reset (new juce::Label ("offsetLabel", TRANS("Blank")));
+    addAndMakeVisible (offsetLabel.get());
+    offsetLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+    offsetLabel->setJustificationType (juce::Justification::centredLeft);
+
+    statsLabel.reset (new juce::Label ("statsLabel"));
+    addAndMakeVisible (statsLabel.get());
+    statsLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+    statsLabel->setJustificationType (juce::Justification::centredLeft);
+    statsLabel->setMinimumHorizontalScale (0.5f);
+
+    simulator.setScanRate ((int)frameEditor->getScanRate());
+
+    player.onFrame = [this] (int index)
+    {
+        showFrame (index);
+        scrubSlider->setValue (index + 1, dontSendNotification);
+    };
+    player.onStopped = [this]
+    {
+        stopTimer();
+        playButton->setToggleState (false, dontSendNotification);
+        playButton->setButtonText ("Play");
+
+        // Leave the editor on the frame we stopped at
+        if (player.getFrameIndex() != frameEditor->getFrameIndex())
+            frameEditor->setFrameIndex ((uint16)player.getFrameIndex());
+    };
+
+    updateScrub();
 }
 
 LaserControls::~LaserControls()
 {
+    frameEditor->removeEditorListener (this);
+    stopTimer();
+    player.onStopped = nullptr;
+    player.stop();
+    simulator.stopThread (1000);
+
+    playButton = nullptr;
+    loopButton = nullptr;
+    scrubSlider = nullptr;
+    fpsSlider = nullptr;
+    fpsLabel = nullptr;
+    playStatsLabel = nullptr;
+    scanButton = nullptr;
+    rateSlider = nullptr;
+    rateLabel = nullptr;
+    lagSlider = nullptr;
+    lagLabel = nullptr;
+    offsetSlider = nullptr;
+    offsetLabel = nullptr;
+    statsLabel = nullptr;
 }
 
-void LaserControls::paint (juce::Graphics& g)
+//==============================================================================
+Rectangle<int> LaserControls::getPreviewArea() const
 {
-    /* This demo code just fills the component's background and
-       draws some placeholder text to get you started.
-
-       You should replace everything in this method with your own
-       drawing code..
-    */
+    return Rectangle<int> (8, 8, getWidth() - 16, getWidth() - 16);
+}
 
+void LaserControls::paint (juce::Graphics& g)
+{
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));   // clear the background
 
     g.setColour (juce::Colours::grey);
     g.drawRect (getLocalBounds().removeFromLeft(1), 1);
 
-    g.setColour (juce::Colours::white);
-    g.setFont (14.0f);
-    g.drawText ("Laser Controls", getLocalBounds(),
-                juce::Justification::centred, true);   // draw some placeholder text
+    auto r = getPreviewArea();
+    g.setColour (Colours::black);
+    g.fillRect (r);
+
+    if (preview.isValid())
+        g.drawImage (preview, r.toFloat());
+
+    g.setColour (Colours::grey);
+    g.drawRect (r);
 }
 
 void LaserControls::resized()
 {
-    // This method is where you should set the bounds of any child
-    // components that your component contains..
+    auto r = getPreviewArea();
+    int y = r.getBottom() + 8;
+
+    playButton->setBounds (8, y, 56, 24);
+    loopButton->setBounds (68, y, 56, 24);
+    scrubSlider->setBounds (4, y + 28, getWidth() - 8, 24);
+    fpsSlider->setBounds (48, y + 54, getWidth() - 52, 24);
+    fpsLabel->setBounds (4, y + 54, 44, 24);
+    playStatsLabel->setBounds (4, y + 80, getWidth() - 8, 24);
+
+    y += 112;
+    scanButton->setBounds (8, y, 56, 24);
+    statsLabel->setBounds (68, y, getWidth() - 72, 24);
+    rateSlider->setBounds (48, y + 28, getWidth() - 52, 24);
+    rateLabel->setBounds (4, y + 28, 44, 24);
+    lagSlider->setBounds (48, y + 54, getWidth() - 52, 24);
+    lagLabel->setBounds (4, y + 54, 44, 24);
+    offsetSlider->setBounds (48, y + 80, getWidth() - 52, 24);
+    offsetLabel->setBounds (4, y + 80, 44, 24);
+}
+
+//==============================================================================
+void LaserControls::updateFrames()
+{
+    auto frames = std::make_shared<ScanSimulator::Frames>();
+    for (auto n = 0; n < frameEditor->getFrameCount(); ++n)
+        frames->add (frameEditor->getFrame ((uint16)n)->getPoints());
+
+    simulator.setFrames (frames);
+}
+
+void LaserControls::updateScrub()
+{
+    // A slider needs some range even with a single frame
+    int count = frameEditor->getFrameCount();
+    scrubSlider->setRange (1, jmax (2, count), 1);
+    scrubSlider->setEnabled (count > 1);
+
+    if (! player.isPlaying())
+    {
+        player.setFrameIndex (frameEditor->getFrameIndex());
+        scrubSlider->setValue (frameEditor->getFrameIndex() + 1, dontSendNotification);
+    }
+}
+
+void LaserControls::showFrame (int index)
+{
+    if (index < frameEditor->getFrameCount())
+        preview = frameEditor->getThumbNail ((uint16)index);
+
+    repaint (getPreviewArea());
+}
+
+void LaserControls::startPlayer()
+{
+    stopAll();
+
+    player.play();
+    if (! player.isPlaying())
+    {
+        playButton->setToggleState (false, dontSendNotification);
+        return;
+    }
+
+    startTimerHz (previewHz);
+    playButton->setButtonText ("Stop");
+}
+
+void LaserControls::startScan()
+{
+    stopAll();
+
+    updateFrames();
+    simulator.setFrameIndex (frameEditor->getFrameIndex());
+    simulator.resetStats();
+    simulator.startThread();
+    startTimerHz (previewHz);
+    scanButton->setButtonText ("Stop");
+}
+
+void LaserControls::stopAll()
+{
+    stopTimer();
+    player.stop();
+
+    simulator.stopThread (1000);
+    scanButton->setToggleState (false, dontSendNotification);
+    scanButton->setButtonText ("Scan");
+}
+
+//==============================================================================
+void LaserControls::buttonClicked (juce::Button* buttonThatWasClicked)
+{
+    if (buttonThatWasClicked == playButton.get())
+    {
+        if (playButton->getToggleState())
+            startPlayer();
+        else
+            stopAll();
+    }
+    else if (buttonThatWasClicked == loopButton.get())
+    {
+        player.setLooping (loopButton->getToggleState());
+    }
+    else if (buttonThatWasClicked == scanButton.get())
+    {
+        if (scanButton->getToggleState())
+            startScan();
+        else
+            stopAll();
+    }
+}
+
+void LaserControls::sliderValueChanged (juce::Slider* sliderThatWasMoved)
+{
+    if (sliderThatWasMoved == scrubSlider.get())
+    {
+        // Only the preview follows until the drag ends, so scrubbing
+        // doesn't leave a trail of frame selections to undo
+        player.setFrameIndex ((int)scrubSlider->getValue() - 1);
+        if (! player.isPlaying())
+            showFrame (player.getFrameIndex());
+    }
+    else if (sliderThatWasMoved == fpsSlider.get())
+        player.setFrameRate (fpsSlider->getValue());
+    else if (sliderThatWasMoved == rateSlider.get())
+        frameEditor->_setScanRate ((uint32)rateSlider->getValue());
+    else if (sliderThatWasMoved == lagSlider.get())
+        simulator.setGalvoLag ((float)lagSlider->getValue());
+    else if (sliderThatWasMoved == offsetSlider.get())
+        simulator.setBlankingOffset ((int)offsetSlider->getValue());
+}
 
+void LaserControls::sliderDragEnded (juce::Slider* slider)
+{
+    if (slider == scrubSlider.get() && ! player.isPlaying()
+        && player.getFrameIndex() != frameEditor->getFrameIndex())
+        frameEditor->setFrameIndex ((uint16)player.getFrameIndex());
 }
 
-void LaserControls::actionListenerCallback (const String& /*message*/)
+void LaserControls::timerCallback()
 {
-    
+    if (player.isPlaying())
+    {
+        playStatsLabel->setText (String (player.getShownRate(), 1) + " fps, "
+                                 + String (player.getMeanJitter(), 1) + " ms jitter (max "
+                                 + String (player.getMaxJitter(), 1) + "), "
+                                 + String (player.getDroppedFrames()) + " dropped",
+                                 dontSendNotification);
+        return;
+    }
+
+    simulator.getImage (preview);
+    repaint (getPreviewArea());
+
+    statsLabel->setText (String (simulator.getFramesPlayed()) + " frames, "
+                         + String (simulator.getLateFrames()) + " late, "
+                         + String (simulator.getDroppedFrames()) + " dropped, "
+                         + String (roundToInt (simulator.getLoad() * 100.0f)) + "% busy",
+                         dontSendNotification);
 }
 
+void LaserControls::editorChanged (const EditorChanges& changes)
+{
+    if (changes.has (EditorActions::scanRateChanged))
+    {
+        rateSlider->setValue (frameEditor->getScanRate(), dontSendNotification);
+        simulator.setScanRate ((int)frameEditor->getScanRate());
+    }
+
+    if (changes.has (EditorActions::framesChanged | EditorActions::frameIndexChanged))
+        updateScrub();
+
+    if (changes.has (EditorActions::framesChanged | EditorActions::frameIndexChanged | EditorActions::frameThumbsChanged))
+    {
+        if (! player.isPlaying() && ! simulator.isThreadRunning())
+            showFrame (frameEditor->getFrameIndex());
+    }
+
+    if (simulator.isThreadRunning())
+    {
+        if (changes.has (EditorActions::framesChanged | EditorActions::ildaPointsChanged))
+            updateFrames();
+        if (changes.has (EditorActions::frameIndexChanged))
+            simulator.setFrameIndex (frameEditor->getFrameIndex());
+    }
+}
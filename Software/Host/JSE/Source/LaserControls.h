@@ -21,10 +21,17 @@
 
 #include <JuceHeader.h>
 #include "FrameEditor.h"
+#include "ScanSimulator.h"
+#include "FramePlayer.h"
 
 //==============================================================================
+// Plays the frames back as an animation, or shows what the projector
+// would using the scan simulator
 class LaserControls  : public Component,
-                       public ActionListener
+                       public EditorBus::Listener,
+                       public Button::Listener,
+                       public Slider::Listener,
+                       public Timer
 {
 public:
     LaserControls (FrameEditor* frame);
@@ -35,10 +42,40 @@ public:
     void resized() override;
 
     //==============================================================================
-    void actionListenerCallback (const String& message) override;
+    void editorChanged (const EditorChanges& changes) override;
+    void buttonClicked (juce::Button* buttonThatWasClicked) override;
+    void sliderValueChanged (juce::Slider* sliderThatWasMoved) override;
+    void sliderDragEnded (juce::Slider* slider) override;
+    void timerCallback() override;
 
 private:
+    void updateFrames();
+    void updateScrub();
+    void showFrame (int index);
+    void startPlayer();
+    void startScan();
+    void stopAll();
+    Rectangle<int> getPreviewArea() const;
+
     FrameEditor* frameEditor;
+    ScanSimulator simulator;
+    FramePlayer player;
+    Image preview;
+
+    std::unique_ptr<TextButton> playButton;
+    std::unique_ptr<TextButton> loopButton;
+    std::unique_ptr<Slider> scrubSlider;
+    std::unique_ptr<Slider> fpsSlider;
+    std::unique_ptr<Label> fpsLabel;
+    std::unique_ptr<Label> playStatsLabel;
+    std::unique_ptr<TextButton> scanButton;
+    std::unique_ptr<Slider> rateSlider;
+    std::unique_ptr<Label> rateLabel;
+    std::unique_ptr<Slider> lagSlider;
+    std::unique_ptr<Label> lagLabel;
+    std::unique_ptr<Slider> offsetSlider;
+    std::unique_ptr<Label> offsetLabel;
+    std::unique_ptr<Label> statsLabel;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LaserControls)
 };
@@ -21,6 +21,7 @@
 
 // Keys for our properties files
 #define KEY_RECENT_FILES "RecentFiles"
+#define KEY_THUMB_CACHE_MB "ThumbCacheMB"
 
 // Base ID for recent file menu
 #define RECENT_BASE_ID (200)
@@ -44,13 +45,16 @@ MainComponent::MainComponent()
     
     // Shared frame editor worker class
     frameEditor.reset (new FrameEditor());
-    frameEditor->addActionListener (this);
+    frameEditor->addEditorListener (this);
+    
+    // Memory the frame list thumbnails are allowed
+    frameEditor->getThumbCache().setMaxBytes ((int64)propertiesFile->getIntValue (KEY_THUMB_CACHE_MB, 64) * 1024 * 1024);
     
     // GUI components
     mainEditor.reset (new MainEditor (frameEditor.get()));
     addAndMakeVisible (mainEditor.get());
-//    laserControls.reset (new LaserControls (frameEditor.get()));
-//    addAndMakeVisible (laserControls.get());
+    laserControls.reset (new LaserControls (frameEditor.get()));
+    addAndMakeVisible (laserControls.get());
     editProperties.reset (new EditProperties (frameEditor.get()));
     addAndMakeVisible (editProperties.get());
     frameList.reset (new FrameList (frameEditor.get()));
@@ -74,13 +78,16 @@ MainComponent::MainComponent()
     else
         setSize(r.getWidth(), r.getHeight());
     
-    Timer::callAfterDelay (300, [this] { actionListenerCallback(EditorActions::framesChanged); });
+    Timer::callAfterDelay (300, [this] { editorChanged (EditorActions::framesChanged); });
 }
 
 MainComponent::~MainComponent()
 {
+    frameEditor->removeEditorListener (this);
+    
     // Save our recent files changes
     propertiesFile->setValue (KEY_RECENT_FILES, recentFileList->toString());
+    propertiesFile->setValue (KEY_THUMB_CACHE_MB, (int)(frameEditor->getThumbCache().getMaxBytes() / (1024 * 1024)));
     propertiesFile->saveIfNeeded();
     
     recentFileList = nullptr;
@@ -102,8 +109,8 @@ void MainComponent::paint (juce::Graphics& g)
 
 void MainComponent::resized()
 {
-//    laserControls->setBounds (getWidth() - 200, 0, 200, 64);
-    frameList->setBounds (getWidth() - 200, 0 /*64*/, 200, getHeight() /*- 64*/);
+    laserControls->setBounds (getWidth() - 200, 0, 200, 424);
+    frameList->setBounds (getWidth() - 200, 424, 200, getHeight() - 424);
 
     editProperties->setBounds (0, 0, 200, getHeight());
     mainEditor->setBounds (200, 0, getWidth() - 400, getHeight());
@@ -166,6 +173,7 @@ PopupMenu MainComponent::getMenuForIndex (int menuIndex, const String& /*menuNam
                 toolMenu.addCommandItem (&commandManager, CommandIDs::ellipseToolRequest);
                 toolMenu.addCommandItem (&commandManager, CommandIDs::centerRectToolRequest);
                 toolMenu.addCommandItem (&commandManager, CommandIDs::centerEllipseToolRequest);
+                toolMenu.addCommandItem (&commandManager, CommandIDs::freehandToolRequest);
             }
         }
         
@@ -208,6 +216,8 @@ PopupMenu MainComponent::getMenuForIndex (int menuIndex, const String& /*menuNam
         menu.addSeparator();
         menu.addCommandItem (&commandManager, CommandIDs::moveFrameUp);
         menu.addCommandItem (&commandManager, CommandIDs::moveFrameDown);
+        menu.addSeparator();
+        menu.addCommandItem (&commandManager, CommandIDs::applyToFrames);
     }
     else if (menuIndex == 2)
     {
@@ -226,6 +236,9 @@ PopupMenu MainComponent::getMenuForIndex (int menuIndex, const String& /*menuNam
         menu.addCommandItem (&commandManager, CommandIDs::toggleSketchVisible);
         menu.addCommandItem (&commandManager, CommandIDs::toggleIldaVisible);
         menu.addCommandItem (&commandManager, CommandIDs::toggleRefVisible);
+        menu.addSeparator();
+        menu.addCommandItem (&commandManager, CommandIDs::togglePreviewCoalescing);
+        menu.addCommandItem (&commandManager, CommandIDs::toggleChangeCoalescing);
     }
     else if (menuIndex == 3)
     {
@@ -273,12 +286,11 @@ bool MainComponent::isFileDirty()
 }
 
 //==============================================================================
-void MainComponent::actionListenerCallback (const String& message)
+void MainComponent::editorChanged (const EditorChanges& changes)
 {
     commandManager.commandStatusChanged();
     
-    if (message == EditorActions::framesChanged ||
-        message == EditorActions::dirtyStatusChanged)
+    if (changes.has (EditorActions::framesChanged | EditorActions::dirtyStatusChanged))
     {
         DocumentWindow* w = dynamic_cast<DocumentWindow*>(getTopLevelComponent());
         if (w)
@@ -366,11 +378,15 @@ void MainComponent::getAllCommands (Array<CommandID>& c)
                                 CommandIDs::ellipseToolRequest,
                                 CommandIDs::centerRectToolRequest,
                                 CommandIDs::centerEllipseToolRequest,
+                                CommandIDs::freehandToolRequest,
                                 CommandIDs::forceCurve,
                                 CommandIDs::forceStraight,
                                 CommandIDs::zeroExit,
                                 CommandIDs::selectEntry,
-                                CommandIDs::selectExit };
+                                CommandIDs::selectExit,
+                                CommandIDs::applyToFrames,
+                                CommandIDs::togglePreviewCoalescing,
+                                CommandIDs::toggleChangeCoalescing };
     
     c.addArray (commands);
 }
@@ -468,6 +484,14 @@ void MainComponent::getCommandInfo (CommandID commandID, ApplicationCommandInfo&
             result.setInfo ("Move Frame Up", "Move the current frame up", "Menu", 0);
             result.setActive (frameEditor->getFrameIndex());
             break;
+        case CommandIDs::applyToFrames:
+            if (frameEditor->canApplyToFrames())
+                result.setInfo ("Apply " + frameEditor->getLastOperationName() + " to Frames...",
+                                "Repeat the last operation on a range of frames", "Menu", 0);
+            else
+                result.setInfo ("Apply to Frames...", "Repeat the last operation on a range of frames", "Menu", 0);
+            result.setActive (frameEditor->canApplyToFrames() && (frameEditor->getFrameCount() > 1));
+            break;
 
         case CommandIDs::frontView:
             result.setInfo ("Front View", "View along Z axis", "Menu", 0);
@@ -516,6 +540,14 @@ void MainComponent::getCommandInfo (CommandID commandID, ApplicationCommandInfo&
             result.addDefaultKeypress ('6', ModifierKeys::altModifier);
             result.setTicked (frameEditor->getRefVisible());
             break;
+        case CommandIDs::togglePreviewCoalescing:
+            result.setInfo ("Coalesce Live Previews", "Update transform previews once per display frame", "Menu", 0);
+            result.setTicked (frameEditor->getPreviewCoalescing());
+            break;
+        case CommandIDs::toggleChangeCoalescing:
+            result.setInfo ("Coalesce Change Notifications", "Deliver editor changes once per message loop", "Menu", 0);
+            result.setTicked (frameEditor->getCoalescing());
+            break;
 
         case CommandIDs::zoomAll:
             result.setInfo ("Fit All", "Fit entire edit field onscreen", "Menu", 0);
@@ -681,6 +713,12 @@ void MainComponent::getCommandInfo (CommandID commandID, ApplicationCommandInfo&
             result.setActive (frameEditor->getActiveLayer() == FrameEditor::sketch);
             result.setTicked (frameEditor->getActiveSketchTool() == FrameEditor::sketchCenterEllipseTool);
             break;
+        case CommandIDs::freehandToolRequest:
+            result.setInfo ("Freehand Tool", "Select Freehand Tool", "Menu", 0);
+            result.addDefaultKeypress ('f', 0);
+            result.setActive (frameEditor->getActiveLayer() == FrameEditor::sketch);
+            result.setTicked (frameEditor->getActiveSketchTool() == FrameEditor::sketchFreehandTool);
+            break;
         case CommandIDs::centerRectToolRequest:
             result.setInfo ("Centered Rectangle Tool", "Select Centered Rectangle Tool", "Menu", 0);
             result.addDefaultKeypress ('m', 0);
@@ -761,6 +799,9 @@ bool MainComponent::perform (const InvocationInfo& info)
         case CommandIDs::moveFrameDown:
             frameEditor->moveFrameDown();
             break;
+        case CommandIDs::applyToFrames:
+            frameEditor->applyLastOperationToFrames();
+            break;
             
         case CommandIDs::zoomAll:
             mainEditor->setZoom (1.0);
@@ -836,6 +877,13 @@ bool MainComponent::perform (const InvocationInfo& info)
         case CommandIDs::toggleRefVisible:
             frameEditor->setRefVisible (! frameEditor->getRefVisible());
             break;
+        case CommandIDs::togglePreviewCoalescing:
+            frameEditor->setPreviewCoalescing (! frameEditor->getPreviewCoalescing());
+            break;
+        case CommandIDs::toggleChangeCoalescing:
+            frameEditor->setCoalescing (! frameEditor->getCoalescing());
+            frameEditor->resetStats();
+            break;
 
         case CommandIDs::fileOpen:
             frameEditor->loadFile();
@@ -981,6 +1029,9 @@ bool MainComponent::perform (const InvocationInfo& info)
         case CommandIDs::centerEllipseToolRequest:
             frameEditor->setActiveSketchTool (FrameEditor::sketchCenterEllipseTool);
             break;
+        case CommandIDs::freehandToolRequest:
+            frameEditor->setActiveSketchTool (FrameEditor::sketchFreehandTool);
+            break;
         case CommandIDs::forceCurve:
             frameEditor->forceAnchorCurved();
             break;
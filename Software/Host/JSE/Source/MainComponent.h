@@ -34,7 +34,7 @@
 class MainComponent  : public Component,
                        public MenuBarModel,
                        public ApplicationCommandTarget,
-                       public ActionListener
+                       public EditorBus::Listener
 {
 public:
     // Commands we respond to
@@ -101,11 +101,15 @@ public:
         ellipseToolRequest,
         centerRectToolRequest,
         centerEllipseToolRequest,
+        freehandToolRequest,
         selectEntry,
         selectExit,
         forceCurve,
         forceStraight,
-        zeroExit
+        zeroExit,
+        applyToFrames,
+        togglePreviewCoalescing,
+        toggleChangeCoalescing
     };
 
     //==============================================================================
@@ -125,7 +129,7 @@ public:
     bool isFileDirty();
     
     //==============================================================================
-    void actionListenerCallback (const String& message) override;
+    void editorChanged (const EditorChanges& changes) override;
 
     //==============================================================================
     ApplicationCommandTarget* getNextCommandTarget() override;
@@ -28,7 +28,7 @@ const float CenterPitch = 10.0;
 MainEditor::MainEditor (FrameEditor* frame)
     : frameEditor (frame)
 {
-    frameEditor->addActionListener (this);
+    frameEditor->addEditorListener (this);
     
     workingArea.reset (new WorkingArea(frame));
     addAndMakeVisible (workingArea.get());
@@ -36,6 +36,7 @@ MainEditor::MainEditor (FrameEditor* frame)
 
 MainEditor::~MainEditor()
 {
+    frameEditor->removeEditorListener (this);
 }
 
 void MainEditor::paint (juce::Graphics& g)
@@ -130,7 +131,7 @@ void MainEditor::resized()
     workingArea->setActiveInvScale (invScale);
 }
 
-void MainEditor::actionListenerCallback (const String& /*message*/)
+void MainEditor::editorChanged (const EditorChanges& /*changes*/)
 {
     
 }
@@ -26,7 +26,7 @@
 
 //==============================================================================
 class MainEditor  : public Component,
-                    public ActionListener
+                    public EditorBus::Listener
 {
 public:
     MainEditor (FrameEditor* frame);
@@ -41,7 +41,7 @@ public:
     void mouseMagnify (const MouseEvent&, float) override;
 
     //==============================================================================
-    void actionListenerCallback (const String& message) override;
+    void editorChanged (const EditorChanges& changes) override;
 
     //==============================================================================
     void setZoom (float zoom);
@@ -0,0 +1,124 @@
+/*
+    RefImage.cpp
+    Reference image file, decoded when it's first wanted, with mip levels
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "RefImage.h"
+
+//==============================================================================
+RefImage::RefImage (const MemoryBlock& d)
+: data (d), decoded (false)
+{
+}
+
+void RefImage::decode()
+{
+    if (decoded)
+        return;
+
+    decoded = true;
+    if (data.getSize())
+        image = ImageFileFormat::loadFrom (data.getData(), data.getSize());
+
+    if (image.isValid())
+        levels.add (image);
+}
+
+const Image* RefImage::getImage()
+{
+    const ScopedLock l (lock);
+    decode();
+    return image.isValid() ? &image : nullptr;
+}
+
+//==============================================================================
+int RefImage::getLevelCount()
+{
+    const ScopedLock l (lock);
+    decode();
+    if (! image.isValid())
+        return 0;
+
+    int count = 1;
+    for (auto size = jmax (image.getWidth(), image.getHeight()); size / 2 >= minLevelSize; size /= 2)
+        ++count;
+
+    return count;
+}
+
+Image RefImage::getLevel (int level)
+{
+    int count = getLevelCount();
+    if (! count)
+        return Image();
+
+    level = jlimit (0, count - 1, level);
+
+    const ScopedLock l (lock);
+    while (levels.size() <= level)
+        levels.add (halve (levels.getLast()));
+
+    return levels[level];
+}
+
+int RefImage::getLevelFor (float pixelScale)
+{
+    if (pixelScale <= 0)
+        return 0;
+
+    // Halving while there are still two image pixels per device pixel
+    int level = 0;
+    for (auto s = pixelScale; s <= 0.5f; s *= 2.0f)
+        ++level;
+
+    return jmin (level, jmax (0, getLevelCount() - 1));
+}
+
+//==============================================================================
+Image RefImage::halve (const Image& source)
+{
+    // Premultiplied, so the channels can just be averaged
+    Image s = source.convertedToFormat (Image::ARGB);
+    int sw = s.getWidth();
+    int sh = s.getHeight();
+    int w = jmax (1, sw / 2);
+    int h = jmax (1, sh / 2);
+    Image d (Image::ARGB, w, h, false, SoftwareImageType());
+
+    Image::BitmapData from (s, Image::BitmapData::readOnly);
+    Image::BitmapData to (d, Image::BitmapData::writeOnly);
+
+    for (auto y = 0; y < h; ++y)
+    {
+        const uint8* row0 = from.getLinePointer (2 * y);
+        const uint8* row1 = from.getLinePointer (jmin (2 * y + 1, sh - 1));
+        uint8* out = to.getLinePointer (y);
+
+        for (auto x = 0; x < w; ++x)
+        {
+            int x0 = 2 * x * from.pixelStride;
+            int x1 = jmin (2 * x + 1, sw - 1) * from.pixelStride;
+
+            for (auto c = 0; c < 4; ++c)
+                out[c] = (uint8)((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) >> 2);
+
+            out += to.pixelStride;
+        }
+    }
+
+    return d;
+}
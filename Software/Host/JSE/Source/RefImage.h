@@ -0,0 +1,61 @@
+/*
+    RefImage.h
+    Reference image file, decoded when it's first wanted, with mip levels
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// The file never changes once it's in here, so frames and their undo copies
+// share one of these instead of each holding a decoded copy. Level n is the
+// image box filtered down to 1/2^n of its size, each level is built the
+// first time it's asked for from the one above it. All calls lock, so the
+// levels can be asked for from a pool thread.
+class RefImage
+{
+public:
+    RefImage (const MemoryBlock& data);
+    ~RefImage() {;}
+
+    const MemoryBlock& getData() const { return data; }
+
+    // Decodes on the first call, nullptr if the data isn't an image
+    const Image* getImage();
+
+    // Level 0 is the image itself, levels stop at minLevelSize
+    int getLevelCount();
+    Image getLevel (int level);
+
+    // Smallest level that still has a pixel for every device pixel when
+    // one image pixel covers pixelScale device pixels
+    int getLevelFor (float pixelScale);
+
+    static const int minLevelSize = 16;
+
+private:
+    void decode();
+    static Image halve (const Image& source);
+
+    CriticalSection lock;
+    MemoryBlock data;
+    bool decoded;
+    Image image;
+    Array<Image> levels;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RefImage)
+};
@@ -20,12 +20,13 @@
 
 #include <JuceHeader.h>
 #include "RefProperties.h"
+#include "TracePopup.h"
 
 //==============================================================================
 RefProperties::RefProperties (FrameEditor* editor)
 {
     frameEditor = editor;
-    frameEditor->addActionListener (this);
+    frameEditor->addEditorListener (this);
 
     layerVisible.reset (new juce::ToggleButton ("layerVisible"));
     addAndMakeVisible (layerVisible.get());
@@ -51,6 +52,12 @@ RefProperties::RefProperties (FrameEditor* editor)
     clearImageButton->setButtonText ("Clear");
     clearImageButton->addListener (this);
 
+    traceImageButton.reset (new juce::TextButton ("traceImageButton"));
+    addAndMakeVisible (traceImageButton.get());
+    traceImageButton->setTooltip ("Trace the outlines of the background image into sketch paths");
+    traceImageButton->setButtonText ("Auto Trace");
+    traceImageButton->addListener (this);
+
     backgroundAlpha.reset (new juce::Slider ("backgroundAlpha"));
     addAndMakeVisible (backgroundAlpha.get());
     backgroundAlpha->setTooltip (TRANS("Adjust the opacity of the background image"));
@@ -106,8 +113,11 @@ RefProperties::RefProperties (FrameEditor* editor)
 
 RefProperties::~RefProperties()
 {
+    frameEditor->removeEditorListener (this);
     layerVisible = nullptr;
     selectImageButton = nullptr;
+    clearImageButton = nullptr;
+    traceImageButton = nullptr;
     backgroundAlpha = nullptr;
     backgroundScale = nullptr;
     backgroundRotation = nullptr;
@@ -133,6 +143,7 @@ void RefProperties::resized()
     backgroundRotation->setBounds (16, 188, 166, 40);
     backgroundXoffset->setBounds (16, 236, 166, 40);
     backgroundYoffset->setBounds (16, 284, 166, 40);
+    traceImageButton->setBounds (16, 336, 100, 24);
 }
 
 //==============================================================================
@@ -146,6 +157,10 @@ void RefProperties::buttonClicked (juce::Button* buttonThatWasClicked)
         frameEditor->selectImage();
     else if (buttonThatWasClicked == clearImageButton.get())
         frameEditor->clearImage();
+    else if (buttonThatWasClicked == traceImageButton.get())
+        CallOutBox::launchAsynchronously (std::make_unique<TracePopup> (frameEditor),
+                                          traceImageButton->getScreenBounds(),
+                                          nullptr);
 }
 
 //==============================================================================
@@ -165,23 +180,31 @@ void RefProperties::sliderValueChanged (juce::Slider* sliderThatWasMoved)
 }
 
 //==============================================================================
-void RefProperties::actionListenerCallback (const String& message)
+void RefProperties::editorChanged (const EditorChanges& changes)
 {
-    if (message == EditorActions::refVisibilityChanged)
+    // Covers everything below
+    if (changes.has (EditorActions::frameIndexChanged))
+    {
+        refresh();
+        return;
+    }
+    
+    if (changes.has (EditorActions::refVisibilityChanged))
         layerVisible->setToggleState (frameEditor->getRefVisible(), dontSendNotification);
-    else if (message == EditorActions::refDrawGridChanged)
+    
+    if (changes.has (EditorActions::refDrawGridChanged))
         drawGrid->setToggleState (frameEditor->getRefDrawGrid(), dontSendNotification);
-    else if (message == EditorActions::refOpacityChanged)
+    
+    if (changes.has (EditorActions::refOpacityChanged))
         backgroundAlpha->setValue (frameEditor->getImageOpacity() * 100, dontSendNotification);
-    else if (message == EditorActions::backgroundImageAdjusted)
+    
+    if (changes.has (EditorActions::backgroundImageAdjusted))
     {
         backgroundScale->setValue (frameEditor->getImageScale() * 100.0, dontSendNotification);
         backgroundRotation->setValue (frameEditor->getImageRotation(), dontSendNotification);
         backgroundXoffset->setValue (frameEditor->getImageXoffset(), dontSendNotification);
         backgroundYoffset->setValue (frameEditor->getImageYoffset(), dontSendNotification);
     }
-    else if (message == EditorActions::frameIndexChanged)
-        refresh();
 }
 
 //==============================================================================
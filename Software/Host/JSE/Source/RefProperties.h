@@ -28,7 +28,7 @@
 class RefProperties  : public Component,
                        public Button::Listener,
                        public Slider::Listener,
-                       public ActionListener
+                       public EditorBus::Listener
 {
 public:
     RefProperties (FrameEditor* editor);
@@ -41,7 +41,7 @@ public:
 
     void sliderValueChanged (juce::Slider* sliderThatWasMoved) override;
 
-    void actionListenerCallback (const String& message) override;
+    void editorChanged (const EditorChanges& changes) override;
 
 private:
     FrameEditor* frameEditor;
@@ -49,6 +49,7 @@ private:
     std::unique_ptr<ToggleButton> drawGrid;
     std::unique_ptr<TextButton> selectImageButton;
     std::unique_ptr<TextButton> clearImageButton;
+    std::unique_ptr<TextButton> traceImageButton;
     std::unique_ptr<Slider> backgroundAlpha;
     std::unique_ptr<Slider> backgroundScale;
     std::unique_ptr<Slider> backgroundRotation;
@@ -32,10 +32,57 @@ public:
         pathButton.reset (new juce::ToggleButton ("pathButton"));
         addAndMakeVisible (pathButton.get());
         pathButton->setButtonText (TRANS("Use shortest path"));
+        pathButton->setTooltip (TRANS("Order and flip paths for the fewest blanked points"));
         pathButton->addListener (this);
 
         pathButton->setBounds (16, 16, 150, 24);
 
+        adaptiveButton.reset (new juce::ToggleButton ("adaptiveButton"));
+        addAndMakeVisible (adaptiveButton.get());
+        adaptiveButton->setButtonText (TRANS("Adaptive spacing"));
+        adaptiveButton->setTooltip (TRANS("Space points by curvature and only dwell on corners that need it"));
+        adaptiveButton->setToggleState (frameEditor->getAdaptiveTolerance() > 0.0f, dontSendNotification);
+        adaptiveButton->setBounds (16, 42, 150, 24);
+
+        animationButton.reset (new juce::ToggleButton ("animationButton"));
+        addAndMakeVisible (animationButton.get());
+        animationButton->setButtonText (TRANS("All frames"));
+        animationButton->setTooltip (TRANS("Render every frame, each starting near where the one before ended"));
+        animationButton->setBounds (16, 68, 150, 24);
+
+        // Blank move speed profile, in sketch units per point
+        velocitySlider.reset (new juce::Slider ("velocitySlider"));
+        addAndMakeVisible (velocitySlider.get());
+        velocitySlider->setRange (500, 16000, 100);
+        velocitySlider->setSliderStyle (juce::Slider::LinearHorizontal);
+        velocitySlider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 48, 20);
+        velocitySlider->setColour (juce::Slider::backgroundColourId, juce::Colour (0xff0d1112));
+        velocitySlider->setTooltip (TRANS("Fastest the scanner moves on blanked jumps"));
+        velocitySlider->setValue (frameEditor->getBlankMove().getMaxVelocity(), dontSendNotification);
+        velocitySlider->setBounds (56, 96, 118, 24);
+
+        velocityLabel.reset (new juce::Label ("velocityLabel", TRANS("Speed")));
+        addAndMakeVisible (velocityLabel.get());
+        velocityLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+        velocityLabel->setJustificationType (juce::Justification::centredLeft);
+        velocityLabel->setBounds (12, 96, 44, 24);
+
+        accelerationSlider.reset (new juce::Slider ("accelerationSlider"));
+        addAndMakeVisible (accelerationSlider.get());
+        accelerationSlider->setRange (100, 8000, 50);
+        accelerationSlider->setSliderStyle (juce::Slider::LinearHorizontal);
+        accelerationSlider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 48, 20);
+        accelerationSlider->setColour (juce::Slider::backgroundColourId, juce::Colour (0xff0d1112));
+        accelerationSlider->setTooltip (TRANS("How hard the scanner speeds up and slows down on blanked jumps"));
+        accelerationSlider->setValue (frameEditor->getBlankMove().getAcceleration(), dontSendNotification);
+        accelerationSlider->setBounds (56, 122, 118, 24);
+
+        accelerationLabel.reset (new juce::Label ("accelerationLabel", TRANS("Accel")));
+        addAndMakeVisible (accelerationLabel.get());
+        accelerationLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+        accelerationLabel->setJustificationType (juce::Justification::centredLeft);
+        accelerationLabel->setBounds (12, 122, 44, 24);
+
 //        updateSketchButton.reset (new juce::ToggleButton ("updateSketchButton"));
 //        addAndMakeVisible (updateSketchButton.get());
 //        updateSketchButton->setButtonText (TRANS("Update sketch"));
@@ -48,9 +95,18 @@ public:
         goButton->setButtonText ("Render");
         goButton->addListener (this);
         
-        goButton->setBounds (50, 84 - 26, 80, 40);
-
-        setSize (180, 140 - 28);
+        goButton->setBounds (50, 154, 80, 40);
+
+        // What the last render came to
+        reportLabel.reset (new juce::Label ("reportLabel", frameEditor->getRenderReport()));
+        addAndMakeVisible (reportLabel.get());
+        reportLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+        reportLabel->setJustificationType (juce::Justification::centred);
+        reportLabel->setMinimumHorizontalScale (0.5f);
+        reportLabel->setTooltip (frameEditor->getRenderPathReport());
+        reportLabel->setBounds (8, 200, 164, 44);
+
+        setSize (180, 210 + (frameEditor->getRenderReport().isEmpty() ? 0 : 42));
         pathButton->setToggleState (true, dontSendNotification);
     }
     
@@ -58,7 +114,14 @@ public:
     {
         pathButton = nullptr;
         updateSketchButton = nullptr;
+        adaptiveButton = nullptr;
+        animationButton = nullptr;
+        velocitySlider = nullptr;
+        velocityLabel = nullptr;
+        accelerationSlider = nullptr;
+        accelerationLabel = nullptr;
         goButton = nullptr;
+        reportLabel = nullptr;
     }
     
     void paint (juce::Graphics& g) override
@@ -74,8 +137,14 @@ public:
     {
         if (buttonThatWasClicked == goButton.get())
         {
-            frameEditor->renderSketch (pathButton->getToggleState() /*,
-                                       updateSketchButton->getToggleState()*/);
+            frameEditor->setAdaptiveTolerance (adaptiveButton->getToggleState() ? adaptiveTolerance : 0.0f);
+            frameEditor->setBlankMove (BlankMove ((float)velocitySlider->getValue(),
+                                                  (float)accelerationSlider->getValue()));
+            if (animationButton->getToggleState())
+                frameEditor->renderAnimation (pathButton->getToggleState());
+            else
+                frameEditor->renderSketch (pathButton->getToggleState() /*,
+                                           updateSketchButton->getToggleState()*/);
             
             CallOutBox* box = findParentComponentOfClass<CallOutBox>();
             box->dismiss();
@@ -88,6 +157,16 @@ private:
     std::unique_ptr<TextButton> goButton;
     std::unique_ptr<ToggleButton> pathButton;
     std::unique_ptr<ToggleButton> updateSketchButton;
+    std::unique_ptr<ToggleButton> adaptiveButton;
+    std::unique_ptr<ToggleButton> animationButton;
+    std::unique_ptr<Slider> velocitySlider;
+    std::unique_ptr<Label> velocityLabel;
+    std::unique_ptr<Slider> accelerationSlider;
+    std::unique_ptr<Label> accelerationLabel;
+    std::unique_ptr<Label> reportLabel;
+    
+    // Furthest the lines between points may stray from the curve
+    const float adaptiveTolerance = 24.0f;
 };
 
 //==============================================================================
@@ -0,0 +1,165 @@
+/*
+    RetainedLayer.cpp
+    Cached image of a component layer, re-rasterized in the background
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "RetainedLayer.h"
+
+//==============================================================================
+// Everything a pool thread needs, kept alive by whoever still holds it
+class RetainedLayer::Job
+{
+public:
+    Job (const Painter& p, Rectangle<int> a, float s, int64 v)
+    : painter (p), area (a), scale (s), version (v), time (0) {;}
+
+    Painter painter;
+    Rectangle<int> area;
+    float scale;
+    int64 version;
+    Image image;
+    double time;
+};
+
+//==============================================================================
+RetainedLayer::RetainedLayer (Component* c)
+: owner (c), version (1), imageScale (0), imageVersion (0), rasterTime (0)
+{
+}
+
+RetainedLayer::~RetainedLayer()
+{
+}
+
+void RetainedLayer::clear()
+{
+    image = Image();
+    imageVersion = 0;
+}
+
+//==============================================================================
+Rectangle<int> RetainedLayer::getVisibleArea() const
+{
+    auto area = owner->getLocalBounds();
+    for (auto* p = owner->getParentComponent(); p != nullptr; p = p->getParentComponent())
+        area = area.getIntersection (owner->getLocalArea (p, p->getLocalBounds()));
+
+    return area;
+}
+
+void RetainedLayer::rasterize (Job& job)
+{
+    double start = Time::getMillisecondCounterHiRes();
+
+    int w = jmax (1, roundToInt (job.area.getWidth() * job.scale));
+    int h = jmax (1, roundToInt (job.area.getHeight() * job.scale));
+    job.image = Image (Image::ARGB, w, h, true, SoftwareImageType());
+
+    {
+        Graphics g (job.image);
+        g.addTransform (AffineTransform::translation ((float)-job.area.getX(), (float)-job.area.getY())
+                        .scaled (job.scale));
+        job.painter (g);
+    }
+
+    job.time = Time::getMillisecondCounterHiRes() - start;
+}
+
+void RetainedLayer::jobDone (std::shared_ptr<Job> job)
+{
+    if (pending != job)
+        return;
+
+    pending = nullptr;
+    // Drawn right away since this one set off
+    if (job->version < imageVersion)
+        return;
+
+    image = job->image;
+    imageArea = job->area;
+    imageScale = job->scale;
+    imageVersion = job->version;
+    rasterTime = job->time;
+
+    // paint() will start another one if things moved on meanwhile
+    owner->repaint();
+}
+
+//==============================================================================
+void RetainedLayer::paint (Graphics& g, const std::function<Painter()>& makePainter, float opacity)
+{
+    float scale = g.getInternalContext().getPhysicalPixelScaleFactor();
+    Rectangle<int> area = getVisibleArea();
+    if (area.isEmpty())
+        return;
+
+    // Zoomed in past anything sensible to keep, draw it straight
+    if (area.getWidth() * scale > maxSize || area.getHeight() * scale > maxSize)
+    {
+        clear();
+        Graphics::ScopedSaveState state (g);
+        g.setOpacity (opacity);
+        makePainter() (g);
+        return;
+    }
+
+    bool current = image.isValid() &&
+                   imageVersion == version &&
+                   imageArea == area &&
+                   imageScale == scale;
+
+    if (! current)
+    {
+        // Cheap layers are drawn right away so edits don't lag a frame
+        if (! image.isValid() || rasterTime < syncTime)
+        {
+            Job job (makePainter(), area, scale, version);
+            rasterize (job);
+            image = job.image;
+            imageArea = area;
+            imageScale = scale;
+            imageVersion = version;
+            rasterTime = job.time;
+        }
+        else if (pending == nullptr)
+        {
+            pending = std::make_shared<Job> (makePainter(), area, scale, version);
+
+            std::shared_ptr<Job> job = pending;
+            Component::SafePointer<Component> safeOwner (owner);
+            SharedResourcePointer<ThreadPool> pool;
+            pool->addJob ([this, job, safeOwner]
+            {
+                rasterize (*job);
+                MessageManager::callAsync ([this, job, safeOwner]
+                {
+                    // We belong to the owner, so if it's gone so are we
+                    if (safeOwner != nullptr)
+                        jobDone (job);
+                });
+            });
+        }
+    }
+
+    Graphics::ScopedSaveState state (g);
+    g.setOpacity (opacity);
+    g.setImageResamplingQuality (Graphics::lowResamplingQuality);
+    g.drawImageTransformed (image,
+                            AffineTransform::scale ((float)imageArea.getWidth() / image.getWidth(),
+                                                    (float)imageArea.getHeight() / image.getHeight())
+                            .translated ((float)imageArea.getX(), (float)imageArea.getY()));
+}
@@ -0,0 +1,78 @@
+/*
+    RetainedLayer.h
+    Cached image of a component layer, re-rasterized in the background
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// Keeps a layer as an image at screen resolution so repaints that don't
+// change it (hover markers, selection) are just a blit. When the content
+// or the view changes the old image keeps being drawn, stretched to fit,
+// while a pool thread draws the new one. The owner is repainted once it's
+// ready.
+class RetainedLayer
+{
+public:
+    // Draws the layer in the owner's coordinates. It runs on a pool thread,
+    // so it may only use what it captured.
+    typedef std::function<void (Graphics&)> Painter;
+
+    RetainedLayer (Component* owner);
+    ~RetainedLayer();
+
+    // Call whenever whatever the painter draws has changed
+    void invalidate() { ++version; }
+
+    // makePainter is only called when a new image is needed. The very first
+    // image is drawn right away so there's never a blank frame. Opacity only
+    // applies to this layer, whatever the context had is left alone.
+    void paint (Graphics& g, const std::function<Painter()>& makePainter, float opacity = 1.0f);
+
+    // Drops the image, say when the layer isn't shown
+    void clear();
+
+    // How long the last rasterization took, in ms
+    double getRasterTime() const { return rasterTime; }
+
+    // Largest image side, bigger views are drawn directly
+    static const int maxSize = 4096;
+    
+    // Layers that took less than this many ms last time aren't worth a thread
+    static constexpr double syncTime = 4.0;
+
+private:
+    class Job;
+
+    Rectangle<int> getVisibleArea() const;
+    static void rasterize (Job& job);
+    void jobDone (std::shared_ptr<Job> job);
+
+    Component* owner;
+    int64 version;
+
+    Image image;
+    Rectangle<int> imageArea;
+    float imageScale;
+    int64 imageVersion;
+
+    std::shared_ptr<Job> pending;
+    double rasterTime;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RetainedLayer)
+};
@@ -0,0 +1,282 @@
+/*
+    ScanSimulator.cpp
+    Plays frames back point by point the way a scanner would show them
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ScanSimulator.h"
+
+// The image fades and the clock is checked this often
+static const int blocksPerSecond = 200;
+
+// Brightness the tone mapping puts at half way
+static const float halfBrightness = 0.25f;
+
+// Too dim to show up at all
+static const float minLight = 1.0e-4f;
+
+//==============================================================================
+ScanSimulator::ScanSimulator()
+: Thread ("Scan Simulator"),
+  nextFrameIndex (-1),
+  frameIndex (0),
+  scanRate (30000),
+  galvoLag (100.0f),
+  blankingOffset (0),
+  persistence (40.0f),
+  framesPlayed (0),
+  lateFrames (0),
+  droppedFrames (0),
+  load (0.0f),
+  clockRate (30000),
+  clockStart (0),
+  clockPoints (0),
+  x1 (imageSize / 2), y1 (imageSize / 2),
+  x2 (imageSize / 2), y2 (imageSize / 2)
+{
+    red.calloc (imageSize * imageSize);
+    green.calloc (imageSize * imageSize);
+    blue.calloc (imageSize * imageSize);
+}
+
+ScanSimulator::~ScanSimulator()
+{
+    stopThread (1000);
+}
+
+void ScanSimulator::setFrames (std::shared_ptr<const Frames> f)
+{
+    const SpinLock::ScopedLockType lock (framesLock);
+    newFrames = f;
+}
+
+void ScanSimulator::resetStats()
+{
+    framesPlayed = 0;
+    lateFrames = 0;
+    droppedFrames = 0;
+}
+
+//==============================================================================
+void ScanSimulator::getImage (Image& image)
+{
+    const int size = imageSize * imageSize;
+    HeapBlock<float> r (size);
+    HeapBlock<float> g (size);
+    HeapBlock<float> b (size);
+
+    {
+        const ScopedLock lock (imageLock);
+        memcpy (r, red, size * sizeof (float));
+        memcpy (g, green, size * sizeof (float));
+        memcpy (b, blue, size * sizeof (float));
+    }
+
+    if (! image.isValid() || image.getWidth() != imageSize || image.getHeight() != imageSize)
+        image = Image (Image::RGB, imageSize, imageSize, false);
+
+    // Soft knee so dense spots don't just clip
+    Image::BitmapData data (image, Image::BitmapData::writeOnly);
+    for (auto y = 0; y < imageSize; ++y)
+    {
+        for (auto x = 0; x < imageSize; ++x)
+        {
+            int i = y * imageSize + x;
+            data.setPixelColour (x, y, Colour::fromFloatRGBA (r[i] / (r[i] + halfBrightness),
+                                                              g[i] / (g[i] + halfBrightness),
+                                                              b[i] / (b[i] + halfBrightness),
+                                                              1.0f));
+        }
+    }
+}
+
+//==============================================================================
+void ScanSimulator::splat (float x, float y, float r, float g, float b)
+{
+    int ix = (int)x;
+    int iy = (int)y;
+    if (x < 0 || y < 0 || ix >= imageSize - 1 || iy >= imageSize - 1)
+        return;
+
+    float fx = x - ix;
+    float fy = y - iy;
+    float w[4] = { (1 - fx) * (1 - fy), fx * (1 - fy), (1 - fx) * fy, fx * fy };
+    int at[4] = { iy * imageSize + ix, iy * imageSize + ix + 1,
+                  (iy + 1) * imageSize + ix, (iy + 1) * imageSize + ix + 1 };
+
+    for (auto n = 0; n < 4; ++n)
+    {
+        red[at[n]] += r * w[n];
+        green[at[n]] += g * w[n];
+        blue[at[n]] += b * w[n];
+    }
+}
+
+void ScanSimulator::deposit (float fromX, float fromY, float toX, float toY, float r, float g, float b)
+{
+    // Each point leaves the same light, spread along the way the beam went
+    float length = std::hypot (toX - fromX, toY - fromY);
+    int steps = jlimit (1, 32, (int)std::ceil (length));
+    float share = 1.0f / steps;
+
+    for (auto n = 0; n < steps; ++n)
+    {
+        float t = (n + 0.5f) * share;
+        splat (fromX + (toX - fromX) * t, fromY + (toY - fromY) * t,
+               r * share, g * share, b * share);
+    }
+}
+
+void ScanSimulator::scanBlock (const Array<Frame::IPoint>& points, int start, int end)
+{
+    const int size = imageSize * imageSize;
+    const float scale = (float)imageSize / 65536.0f;
+    float dt = 1.0f / clockRate;
+
+    // Two stages of half the lag each round the corners off like mirrors do
+    float lag = galvoLag * 0.5e-6f;
+    float follow = lag > 0.0f ? 1.0f - std::exp (-dt / lag) : 1.0f;
+    int offset = blankingOffset;
+
+    const ScopedLock lock (imageLock);
+
+    float fade = std::exp (-(end - start) * dt / (persistence * 0.001f));
+    // Faded out pixels are zeroed before they go denormal and crawl
+    for (auto n = 0; n < size; ++n)
+    {
+        red[n] = red[n] > minLight ? red[n] * fade : 0.0f;
+        green[n] = green[n] > minLight ? green[n] * fade : 0.0f;
+        blue[n] = blue[n] > minLight ? blue[n] * fade : 0.0f;
+    }
+
+    for (auto n = start; n < end; ++n)
+    {
+        const Frame::IPoint& point = points.getReference (n);
+        float targetX = ((float)point.x.w + 32768.0f) * scale;
+        float targetY = (32767.0f - (float)point.y.w) * scale;
+
+        x1 += (targetX - x1) * follow;
+        y1 += (targetY - y1) * follow;
+        float x = x2 + (x1 - x2) * follow;
+        float y = y2 + (y1 - y2) * follow;
+
+        int c = ((n - offset) % points.size() + points.size()) % points.size();
+        const Frame::IPoint& color = points.getReference (c);
+        if (! (color.status & Frame::BlankedPoint))
+            deposit (x2, y2, x, y, color.red / 255.0f, color.green / 255.0f, color.blue / 255.0f);
+
+        x2 = x;
+        y2 = y;
+    }
+}
+
+//==============================================================================
+void ScanSimulator::startClock()
+{
+    clockRate = scanRate;
+    clockStart = Time::getMillisecondCounterHiRes();
+    clockPoints = 0;
+}
+
+void ScanSimulator::run()
+{
+    int index = 0;
+    double busy = 0;
+    double loadStart = Time::getMillisecondCounterHiRes();
+    startClock();
+
+    while (! threadShouldExit())
+    {
+        {
+            const SpinLock::ScopedLockType lock (framesLock);
+            if (newFrames != nullptr)
+            {
+                frames = newFrames;
+                newFrames = nullptr;
+            }
+        }
+
+        if (frames == nullptr || frames->isEmpty())
+        {
+            wait (50);
+            startClock();
+            continue;
+        }
+
+        int next = nextFrameIndex.exchange (-1);
+        if (next >= 0)
+            index = next;
+        index %= frames->size();
+        frameIndex = index;
+
+        // Hang on to them, setFrames may swap them out
+        std::shared_ptr<const Frames> playing = frames;
+        const Array<Frame::IPoint>& points = playing->getReference (index);
+        if (points.isEmpty())
+        {
+            ++index;
+            wait (1);
+            startClock();
+            continue;
+        }
+
+        if (clockRate != scanRate)
+            startClock();
+
+        int blockSize = jmax (1, clockRate / blocksPerSecond);
+        double due = clockStart;
+
+        for (auto start = 0; start < points.size() && ! threadShouldExit(); start += blockSize)
+        {
+            int end = jmin (points.size(), start + blockSize);
+            double started = Time::getMillisecondCounterHiRes();
+            scanBlock (points, start, end);
+            double now = Time::getMillisecondCounterHiRes();
+            busy += now - started;
+
+            clockPoints += end - start;
+            due = clockStart + clockPoints * 1000.0 / clockRate;
+            if (due - now >= 1.0)
+                wait ((int)(due - now));
+        }
+
+        ++framesPlayed;
+
+        double now = Time::getMillisecondCounterHiRes();
+        double behind = now - due;
+        if (behind > 1000.0 / blocksPerSecond)
+            ++lateFrames;
+
+        // More than a frame behind, skip ahead rather than play catch up
+        double frameTime = points.size() * 1000.0 / clockRate;
+        if (behind > frameTime)
+        {
+            int skip = (int)(behind / frameTime);
+            droppedFrames += skip;
+            index += skip;
+            startClock();
+        }
+
+        ++index;
+
+        if (now - loadStart > 500.0)
+        {
+            load = (float)(busy / (now - loadStart));
+            busy = 0;
+            loadStart = now;
+        }
+    }
+}
@@ -0,0 +1,106 @@
+/*
+    ScanSimulator.h
+    Plays frames back point by point the way a scanner would show them
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Frame.h"
+
+// Runs in real time against the wall clock. The mirrors trail the points
+// through two first order lags, the colour can be shifted against the
+// position like a projector's blanking offset, and the beam builds up a
+// fading image the UI copies whenever it likes.
+class ScanSimulator : public Thread
+{
+public:
+    ScanSimulator();
+    ~ScanSimulator() override;
+
+    typedef Array<Array<Frame::IPoint>> Frames;
+
+    // Picked up at the next frame boundary, playback loops over them
+    void setFrames (std::shared_ptr<const Frames> frames);
+    // Jumps there at the next frame boundary
+    void setFrameIndex (int index) { nextFrameIndex = index; }
+    int getFrameIndex() const { return frameIndex; }
+
+    void setScanRate (int pointsPerSecond) { scanRate = jmax (1000, pointsPerSecond); }
+    int getScanRate() const { return scanRate; }
+    // Time constant of the mirrors
+    void setGalvoLag (float microseconds) { galvoLag = jmax (0.0f, microseconds); }
+    float getGalvoLag() const { return galvoLag; }
+    // Positive turns the colour on that many points late. Points near the
+    // ends of a frame borrow colours from its other end.
+    void setBlankingOffset (int points) { blankingOffset = jlimit (-maxOffset, maxOffset, points); }
+    int getBlankingOffset() const { return blankingOffset; }
+    // How long the image takes to fade to about a third
+    void setPersistence (float ms) { persistence = jmax (1.0f, ms); }
+
+    // Tone mapped copy of the persistence image, imageSize square
+    void getImage (Image& image);
+    static const int imageSize = 256;
+    static const int maxOffset = 16;
+
+    // Frames that finished after they were due or were skipped to catch up
+    int getFramesPlayed() const { return framesPlayed; }
+    int getLateFrames() const { return lateFrames; }
+    int getDroppedFrames() const { return droppedFrames; }
+    // Share of the time the thread was busy, 0 to 1
+    float getLoad() const { return load; }
+    void resetStats();
+
+    void run() override;
+
+private:
+    void startClock();
+    void scanBlock (const Array<Frame::IPoint>& points, int start, int end);
+    void deposit (float x1, float y1, float x2, float y2, float r, float g, float b);
+    void splat (float x, float y, float r, float g, float b);
+
+    SpinLock framesLock;
+    std::shared_ptr<const Frames> newFrames;
+    std::shared_ptr<const Frames> frames;
+
+    std::atomic<int> nextFrameIndex;
+    std::atomic<int> frameIndex;
+    std::atomic<int> scanRate;
+    std::atomic<float> galvoLag;
+    std::atomic<int> blankingOffset;
+    std::atomic<float> persistence;
+
+    std::atomic<int> framesPlayed;
+    std::atomic<int> lateFrames;
+    std::atomic<int> droppedFrames;
+    std::atomic<float> load;
+
+    // Wall clock the scanning is paced against
+    int clockRate;
+    double clockStart;
+    int64 clockPoints;
+
+    // Mirror positions, the second stage is where the beam is
+    float x1, y1, x2, y2;
+
+    CriticalSection imageLock;
+    HeapBlock<float> red;
+    HeapBlock<float> green;
+    HeapBlock<float> blue;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ScanSimulator)
+};
@@ -0,0 +1,105 @@
+/*
+    SegmentIndex.cpp
+    Bounding volume tree over the segments of a frame, for culling
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "SegmentIndex.h"
+
+//==============================================================================
+SegmentIndex::SegmentIndex (const Array<Frame::IPoint>& points, Frame::ViewAngle v)
+: numSegments (points.size()), view (v)
+{
+    int numLeaves = (numSegments + leafSize - 1) / leafSize;
+    firstLeaf = 1;
+    while (firstLeaf < numLeaves)
+        firstLeaf <<= 1;
+
+    // Empty nodes never touch anything
+    Bounds empty = { 1.0f, 1.0f, -1.0f, -1.0f };
+    nodes.insertMultiple (0, empty, firstLeaf * 2);
+
+    for (auto leaf = 0; leaf < numLeaves; ++leaf)
+    {
+        Bounds& b = nodes.getReference (firstLeaf + leaf);
+        int end = jmin (numSegments, (leaf + 1) * leafSize);
+
+        // The last segment's end is the first point of the next leaf
+        for (auto n = leaf * leafSize; n <= end; ++n)
+        {
+            const Frame::IPoint& p = points.getReference (n % numSegments);
+            float x = Frame::getCompX (p, view);
+            float y = Frame::getCompY (p, view);
+
+            if (b.x1 > b.x2)
+                b = { x, y, x, y };
+            else
+            {
+                b.x1 = jmin (b.x1, x);
+                b.y1 = jmin (b.y1, y);
+                b.x2 = jmax (b.x2, x);
+                b.y2 = jmax (b.y2, y);
+            }
+        }
+    }
+
+    for (auto n = firstLeaf - 1; n > 0; --n)
+    {
+        const Bounds& l = nodes.getReference (2 * n);
+        const Bounds& r = nodes.getReference (2 * n + 1);
+
+        if (l.x1 > l.x2)
+            nodes.set (n, r);
+        else if (r.x1 > r.x2)
+            nodes.set (n, l);
+        else
+            nodes.set (n, { jmin (l.x1, r.x1), jmin (l.y1, r.y1),
+                            jmax (l.x2, r.x2), jmax (l.y2, r.y2) });
+    }
+}
+
+//==============================================================================
+void SegmentIndex::findRuns (const Rectangle<float>& area, Array<Range<int>>& runs) const
+{
+    runs.clearQuick();
+    if (! numSegments)
+        return;
+
+    Bounds b = { area.getX(), area.getY(), area.getRight(), area.getBottom() };
+    findRuns (1, b, runs);
+}
+
+void SegmentIndex::findRuns (int node, const Bounds& area, Array<Range<int>>& runs) const
+{
+    const Bounds& b = nodes.getReference (node);
+    if (b.x1 > area.x2 || b.x2 < area.x1 || b.y1 > area.y2 || b.y2 < area.y1)
+        return;
+
+    if (node < firstLeaf)
+    {
+        findRuns (2 * node, area, runs);
+        findRuns (2 * node + 1, area, runs);
+        return;
+    }
+
+    int start = (node - firstLeaf) * leafSize;
+    int end = jmin (numSegments, start + leafSize);
+
+    if (runs.size() && runs.getReference (runs.size() - 1).getEnd() == start)
+        runs.getReference (runs.size() - 1).setEnd (end);
+    else
+        runs.add (Range<int> (start, end));
+}
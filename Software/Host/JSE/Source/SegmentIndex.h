@@ -0,0 +1,61 @@
+/*
+    SegmentIndex.h
+    Bounding volume tree over the segments of a frame, for culling
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Frame.h"
+
+// Segment n goes from point n to point n + 1, the last one back to point 0,
+// in component coordinates for one view angle. Leaves are runs of
+// consecutive segments, which laser frames keep close together anyway, so
+// a query hands back runs in drawing order and nothing gets sorted.
+class SegmentIndex
+{
+public:
+    SegmentIndex (const Array<Frame::IPoint>& points, Frame::ViewAngle view);
+    ~SegmentIndex() {;}
+
+    Frame::ViewAngle getView() const { return view; }
+    int getSegmentCount() const { return numSegments; }
+
+    // Runs of segments whose bounds touch area, in order, with touching
+    // runs joined up
+    void findRuns (const Rectangle<float>& area, Array<Range<int>>& runs) const;
+
+    // Segments per leaf
+    static const int leafSize = 32;
+
+private:
+    struct Bounds
+    {
+        float x1, y1, x2, y2;
+    };
+
+    void findRuns (int node, const Bounds& area, Array<Range<int>>& runs) const;
+
+    // Implicit binary tree, node n has children 2n and 2n + 1 and the
+    // leaves start at firstLeaf
+    Array<Bounds> nodes;
+    int firstLeaf;
+    int numSegments;
+    Frame::ViewAngle view;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SegmentIndex)
+};
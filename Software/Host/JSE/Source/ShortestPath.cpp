@@ -18,152 +18,581 @@
 */
 
 #include "ShortestPath.h"
+#include "WorkerPool.h"
 
-class PElement
+//==============================================================================
+int DistanceCost::getCost (Point<int> from, int, Point<int> to, int) const
+{
+    return from.getDistanceFrom (to);
+}
+
+int DistanceCost::getMinimumCost (int distance) const
+{
+    return distance;
+}
+
+//==============================================================================
+BlankPointCost::BlankPointCost (const BlankMove& m)
+: move (m)
+{
+}
+
+int BlankPointCost::getCost (Point<int> from, int fromZ, Point<int> to, int toZ) const
+{
+    return move.getPointCount (BlankMove::getMoveLength (from, fromZ, to, toZ));
+}
+
+int BlankPointCost::getMinimumCost (int distance) const
+{
+    return move.getPointCount ((float)distance);
+}
+
+//==============================================================================
+int MoveLengthCost::getCost (Point<int> from, int fromZ, Point<int> to, int toZ) const
+{
+    return roundToInt (BlankMove::getMoveLength (from, fromZ, to, toZ));
+}
+
+int MoveLengthCost::getMinimumCost (int distance) const
+{
+    return distance;
+}
+
+//==============================================================================
+// Each path has two endpoints, 2 * index is its start and 2 * index + 1 its
+// end, each with the Z the path has there
+class PathEnds
 {
 public:
-    PElement () : index (-1), reversed (false) {;}
-    PElement (const Array<IPath>& paths, int idx)
-    : index (idx), reversed (false)
+    PathEnds (const Array<IPath>& paths, const TransitionCost& c)
+    : cost (c)
     {
-        Anchor startA = paths[idx].getAnchor (0);
-        Anchor endA = paths[idx].getAnchor (paths[idx].getAnchorCount() - 1);
-        
-        start = Point<int>(startA.getX(), startA.getY());
-        end = Point<int>(endA.getX(), endA.getY());
+        for (auto n = 0; n < paths.size(); ++n)
+        {
+            const IPath& p = paths.getReference (n);
+            const Anchor& s = p.getAnchor (0);
+            const Anchor& e = p.getAnchor (p.getAnchorCount() - 1);
+            points.add (Point<int> (s.getX(), s.getY()));
+            points.add (Point<int> (e.getX(), e.getY()));
+            z.add (p.getStartZ());
+            z.add (p.getEndZ());
+        }
     }
     
-public:
-    int index;
-    Point<int> start;
-    Point<int> end;
-    bool reversed;
+    int distance (int a, int b) const
+    {
+        return cost.getCost (points.getReference (a), z[a], points.getReference (b), z[b]);
+    }
+    
+    Array<Point<int>> points;
+    Array<int> z;
+    const TransitionCost& cost;
 };
 
-static int getTotalLength (const Array<PElement>& elements)
+//==============================================================================
+// k-d tree over the endpoints for nearest endpoint searches, kept in one
+// array (each range's middle item splits it). Endpoints can be taken out as
+// the greedy tour uses them up, and put back with reset.
+class EndTree
 {
-    Point<int> start;
-    Point<int> end;
+public:
+    EndTree (const PathEnds& e)
+    : ends (e)
+    {
+        for (auto n = 0; n < ends.points.size(); ++n)
+            items.add (n);
+        
+        build (0, items.size(), 0);
+        
+        slotOf.resize (items.size());
+        for (auto n = 0; n < items.size(); ++n)
+            slotOf.set (items[n], n);
+        
+        alive.resize (items.size());
+        removed.resize (items.size());
+        reset();
+    }
     
-    int length = 0;
+    void reset()
+    {
+        count (0, items.size());
+    }
     
-    for (auto n = 0; n < (elements.size() - 1); ++n)
+    void remove (int e)
     {
-        if (elements[n].reversed)
-            start = elements[n].start;
-        else
-            start = elements[n].end;
+        // Walk down to it taking one off every range on the way
+        int slot = slotOf[e];
+        int lo = 0;
+        int hi = items.size();
         
-        if (elements[n+1].reversed)
-            end = elements[n+1].end;
-        else
-            end = elements[n+1].start;
+        for (;;)
+        {
+            int mid = (lo + hi) / 2;
+            alive.getReference (mid)--;
+            
+            if (slot == mid)
+                break;
+            if (slot < mid)
+                hi = mid;
+            else
+                lo = mid + 1;
+        }
+        
+        removed.getReference (slot) = true;
+    }
+    
+    // Cheapest endpoint to move to from endpoint from, ties go to the
+    // lowest endpoint number (so the lowest path, start before end).
+    // -1 if none are left.
+    int nearest (int from) const
+    {
+        int best = -1;
+        int bestDistance = 0;
+        nearest (from, 0, items.size(), 0, best, bestDistance);
+        return best;
+    }
+    
+    // Up to count cheapest endpoints to move to from endpoint e that belong
+    // to other paths, cheapest first. Ignores removals.
+    void nearestOthers (int e, int count, Array<int>& result) const
+    {
+        Array<std::pair<int, int>> found;
+        nearestOthers (e, count, 0, items.size(), 0, found);
+        
+        result.clearQuick();
+        for (auto& f : found)
+            result.add (f.second);
+    }
+    
+private:
+    int coord (int e, int axis) const
+    {
+        const Point<int>& p = ends.points.getReference (e);
+        return axis ? p.getY() : p.getX();
+    }
+    
+    void build (int lo, int hi, int axis)
+    {
+        if (hi - lo < 2)
+            return;
+        
+        int mid = (lo + hi) / 2;
+        std::nth_element (items.begin() + lo, items.begin() + mid, items.begin() + hi,
+                          [this, axis] (int a, int b) { return coord (a, axis) < coord (b, axis); });
+        
+        build (lo, mid, axis ^ 1);
+        build (mid + 1, hi, axis ^ 1);
+    }
+    
+    int count (int lo, int hi)
+    {
+        if (lo >= hi)
+            return 0;
         
-        length += start.getDistanceFrom (end);
+        int mid = (lo + hi) / 2;
+        int c = 1 + count (lo, mid) + count (mid + 1, hi);
+        alive.set (mid, c);
+        removed.set (mid, false);
+        return c;
     }
     
-    if (elements[elements.size() -1].reversed)
-        start = elements[elements.size() -1].start;
-    else
-        start = elements[elements.size() -1].end;
+    void nearest (int from, int lo, int hi, int axis, int& best, int& bestDistance) const
+    {
+        if (lo >= hi)
+            return;
+        
+        int mid = (lo + hi) / 2;
+        if (! alive[mid])
+            return;
+        
+        int e = items[mid];
+        if (! removed[mid])
+        {
+            int d = ends.distance (from, e);
+            if (best == -1 || d < bestDistance || (d == bestDistance && e < best))
+            {
+                best = e;
+                bestDistance = d;
+            }
+        }
+        
+        int diff = coord (from, axis) - coord (e, axis);
+        bool below = diff < 0;
+        nearest (from, below ? lo : mid + 1, below ? mid : hi, axis ^ 1, best, bestDistance);
+        
+        // The far side can still tie, which matters for which one wins
+        if (best == -1 || ends.cost.getMinimumCost (std::abs (diff)) <= bestDistance)
+            nearest (from, below ? mid + 1 : lo, below ? hi : mid, axis ^ 1, best, bestDistance);
+    }
     
-    if (elements[0].reversed)
-        end = elements[0].end;
-    else
-        end = elements[0].start;
+    void nearestOthers (int e, int count, int lo, int hi, int axis,
+                        Array<std::pair<int, int>>& found) const
+    {
+        if (lo >= hi)
+            return;
+        
+        int mid = (lo + hi) / 2;
+        int o = items[mid];
+        if ((o >> 1) != (e >> 1))
+        {
+            std::pair<int, int> f (ends.distance (e, o), o);
+            if (found.size() < count || f < found.getLast())
+            {
+                int n = found.size();
+                while (n > 0 && f < found.getReference (n - 1))
+                    --n;
+                found.insert (n, f);
+                if (found.size() > count)
+                    found.removeLast();
+            }
+        }
+        
+        int diff = coord (e, axis) - coord (o, axis);
+        bool below = diff < 0;
+        nearestOthers (e, count, below ? lo : mid + 1, below ? mid : hi, axis ^ 1, found);
+        
+        if (found.size() < count || ends.cost.getMinimumCost (std::abs (diff)) <= found.getLast().first)
+            nearestOthers (e, count, below ? mid + 1 : lo, below ? hi : mid, axis ^ 1, found);
+    }
+    
+    const PathEnds& ends;
+    Array<int> items;
+    Array<int> slotOf;
+    // Endpoints left in each range, stored at the range's middle
+    Array<int> alive;
+    Array<bool> removed;
+};
 
-    length += start.getDistanceFrom (end);
-    return length;
-}
+//==============================================================================
+class PElement
+{
+public:
+    PElement () : index (-1), reversed (false) {;}
+    PElement (int idx, bool rev) : index (idx), reversed (rev) {;}
+    
+    // Endpoints the tour enters and leaves this path by
+    int in() const { return 2 * index + (reversed ? 1 : 0); }
+    int out() const { return 2 * index + (reversed ? 0 : 1); }
+    
+public:
+    int index;
+    bool reversed;
+};
 
-void findAndMoveShortest (Array<PElement>& dst, Array<PElement>& src)
+static int getTotalCost (const Array<PElement>& elements, const PathEnds& ends)
 {
-    PElement e = dst[dst.size() -1];
-    Point<int> start;
+    int total = 0;
+    
+    for (auto n = 0; n < elements.size(); ++n)
+        total += ends.distance (elements.getReference (n).out(),
+                                 elements.getReference ((n + 1) % elements.size()).in());
     
-    if (e.reversed)
-        start = e.start;
-    else
-        start = e.end;
+    return total;
+}
 
-    int index = 0;
-    int shortest = 1000000;
-    bool reversed = false;
+// Nearest neighbour tour from first, always going to the closest free
+// endpoint (and flipping the path if that is its end)
+static void greedyTour (PElement first, EndTree& tree, Array<PElement>& tour)
+{
+    tree.reset();
+    tour.clearQuick();
+    
+    PElement e = first;
+    for (;;)
+    {
+        tour.add (e);
+        tree.remove (2 * e.index);
+        tree.remove (2 * e.index + 1);
+        
+        int next = tree.nearest (e.out());
+        if (next == -1)
+            break;
+        
+        e = PElement (next >> 1, (next & 1) != 0);
+    }
+}
 
-    for (auto n = 0; n < src.size(); ++n)
+//==============================================================================
+// 2-opt and Or-opt over a closed tour of paths. Reversing a stretch of the
+// tour also flips every path in it, so path direction is part of each move.
+class TourImprover
+{
+public:
+    TourImprover (Array<PElement>& t, const PathEnds& e, const EndTree& tree)
+    : tour (t), ends (e)
     {
-        e = src[n];
-        int distance = start.getDistanceFrom (e.start);
-        if (distance < shortest)
+        Array<int> near;
+        for (auto n = 0; n < ends.points.size(); ++n)
         {
-            shortest = distance;
-            index = n;
-            reversed = false;
+            tree.nearestOthers (n, neighbourCount, near);
+            neighbours.add (near);
         }
         
-        distance = start.getDistanceFrom (e.end);
-        if (distance < shortest)
+        position.resize (tour.size());
+        updatePositions();
+    }
+    
+    // Returns false if it ran out of time or got stopped before it was done
+    bool run (double endTime, const std::function<bool()>& shouldStop)
+    {
+        if (tour.size() < 4)
+            return true;
+        
+        bool improved = true;
+        while (improved)
         {
-            shortest = distance;
-            index = n;
-            reversed = true;
+            improved = false;
+            for (auto n = 0; n < tour.size(); ++n)
+            {
+                if ((n & 63) == 0)
+                {
+                    if (Time::getMillisecondCounterHiRes() > endTime)
+                        return false;
+                    if (shouldStop && shouldStop())
+                        return false;
+                }
+                
+                // Keep working on the same spot while it improves
+                while (twoOptOut (n) || twoOptIn (n) || orOpt (n, 1) || orOpt (n, 2) || orOpt (n, 3))
+                    improved = true;
+            }
         }
+        
+        return true;
     }
     
-    e = src[index];
-    src.remove (index);
-    e.reversed = reversed;
-    dst.add (e);
-}
-
-void ShortestPath::find (const Array<IPath>& original, Array<IPath>& shortest)
-{
-    Array<PElement> base;
+private:
+    int wrap (int n) const { return (n + tour.size()) % tour.size(); }
+    int in (int n) const { return tour.getReference (wrap (n)).in(); }
+    int out (int n) const { return tour.getReference (wrap (n)).out(); }
+    int posOf (int endpoint) const { return position[endpoint >> 1]; }
+    bool isOut (int endpoint) const { return out (posOf (endpoint)) == endpoint; }
+    int d (int a, int b) const { return ends.distance (a, b); }
     
-    // Collect the starts and ends
-    for (auto n = 0; n < original.size(); ++n)
-        base.add (PElement (original, n));
+    void updatePositions()
+    {
+        for (auto n = 0; n < tour.size(); ++n)
+            position.set (tour.getReference (n).index, n);
+    }
     
-    // The original is the one to beat
-    Array<PElement> minPath = base;
-    int minLength = getTotalLength (minPath);
+    // Reverse and flip positions from..to, going round the end if needed.
+    // The rest of the tour reversed is the same loop, so do the shorter one.
+    void reverse (int from, int to)
+    {
+        int count = wrap (to - from) + 1;
+        if (count * 2 > tour.size())
+        {
+            from = wrap (to + 1);
+            count = tour.size() - count;
+        }
+        
+        for (auto n = 0; n < count / 2; ++n)
+            tour.swap (wrap (from + n), wrap (from + count - 1 - n));
+        
+        for (auto n = 0; n < count; ++n)
+        {
+            PElement& e = tour.getReference (wrap (from + n));
+            e.reversed = ! e.reversed;
+            position.set (e.index, wrap (from + n));
+        }
+    }
     
-    for (auto n = 0; n < base.size(); ++n)
+    // Replace (out i, in i+1) with (out i, out j) by reversing i+1..j
+    bool twoOptOut (int i)
     {
-        Array<PElement> src = base;
-        Array<PElement> dst;
-
-        PElement e = src[n];
-        dst.add (e);
-        src.remove (n);
+        int a = out (i);
+        int b = in (i + 1);
+        int ab = d (a, b);
+        
+        for (auto c : neighbours.getReference (a))
+        {
+            int ac = d (a, c);
+            if (ac >= ab)
+                break;
+            if (! isOut (c))
+                continue;
+            
+            int j = posOf (c);
+            if (j == wrap (i))
+                continue;
+            
+            int next = in (j + 1);
+            if (ac + d (b, next) < ab + d (c, next))
+            {
+                reverse (i + 1, j);
+                return true;
+            }
+        }
         
-        while (src.size())
-            findAndMoveShortest (dst, src);
+        return false;
+    }
+    
+    // Replace (out i, in i+1) with (in j, in i+1) by reversing i+1..j-1
+    bool twoOptIn (int i)
+    {
+        int a = out (i);
+        int b = in (i + 1);
+        int ab = d (a, b);
         
-        int length = getTotalLength (dst);
-        if (length < minLength)
+        for (auto c : neighbours.getReference (b))
         {
-            minLength = length;
-            minPath = dst;
+            int bc = d (b, c);
+            if (bc >= ab)
+                break;
+            if (isOut (c))
+                continue;
+            
+            int j = posOf (c);
+            if (j == wrap (i + 1))
+                continue;
+            
+            int prev = out (j - 1);
+            if (bc + d (a, prev) < ab + d (prev, c))
+            {
+                reverse (i + 1, j - 1);
+                return true;
+            }
         }
         
-        src = base;
-        dst.clear();
-        e.reversed = true;
-        dst.add (e);
-        src.remove (n);
+        return false;
+    }
+    
+    // Move the run of count paths starting at i somewhere else, either way round
+    bool orOpt (int i, int count)
+    {
+        if (tour.size() < count + 3)
+            return false;
+        
+        int f = in (i);
+        int g = out (i + count - 1);
+        int p = out (i - 1);
+        int q = in (i + count);
+        int gain = d (p, f) + d (g, q) - d (p, q);
+        if (gain <= 0)
+            return false;
+        
+        auto inRun = [this, i, count] (int k) { return wrap (k - i) < count; };
+        
+        // Join either end of the run to one of its neighbours
+        for (auto side = 0; side < 2; ++side)
+        {
+            int e = side ? g : f;
+            for (auto c : neighbours.getReference (e))
+            {
+                int ec = d (e, c);
+                if (ec >= gain)
+                    break;
+                
+                int k = posOf (c);
+                if (inRun (k))
+                    continue;
+                
+                // The other side of c's edge
+                bool after = isOut (c);
+                int other = after ? in (k + 1) : out (k - 1);
+                int otherPos = after ? wrap (k + 1) : wrap (k - 1);
+                if (inRun (otherPos))
+                    continue;
+                
+                // f joins an out forward or an in reversed, g the other way
+                bool flip = (side == 0) != after;
+                int toOther = d (other, side ? f : g);
+                if (ec + toOther - d (c, other) < gain)
+                {
+                    moveRun (i, count, after ? k : wrap (k - 1), flip);
+                    return true;
+                }
+            }
+        }
         
-        while (src.size())
-            findAndMoveShortest (dst, src);
+        return false;
+    }
+    
+    // Take the run out and put it back after the path now at afterPos
+    void moveRun (int i, int count, int afterPos, bool flip)
+    {
+        int afterIndex = tour.getReference (afterPos).index;
+        
+        Array<PElement> run;
+        for (auto n = 0; n < count; ++n)
+            run.add (tour.getReference (wrap (i + n)));
+        
+        if (flip)
+        {
+            std::reverse (run.begin(), run.end());
+            for (auto& e : run)
+                e.reversed = ! e.reversed;
+        }
+        
+        // It's a loop, so the rest can start anywhere
+        Array<PElement> rest;
+        rest.ensureStorageAllocated (tour.size());
+        for (auto n = count; n < tour.size(); ++n)
+        {
+            rest.add (tour.getReference (wrap (i + n)));
+            if (rest.getLast().index == afterIndex)
+                rest.addArray (run);
+        }
+        
+        tour.swapWith (rest);
+        updatePositions();
+    }
+    
+    Array<PElement>& tour;
+    const PathEnds& ends;
+    Array<Array<int>> neighbours;
+    Array<int> position;
+    
+    static const int neighbourCount = 8;
+};
+
+//==============================================================================
+void ShortestPath::find (const Array<IPath>& original, Array<IPath>& shortest,
+                         const TransitionCost& cost,
+                         double timeBudgetMs, const std::function<bool()>& shouldStop)
+{
+    shortest.clear();
+    if (! original.size())
+        return;
+    
+    double endTime = Time::getMillisecondCounterHiRes() + timeBudgetMs;
+    
+    PathEnds ends (original, cost);
+    EndTree tree (ends);
+    
+    // The original is the one to beat
+    Array<PElement> minPath;
+    for (auto n = 0; n < original.size(); ++n)
+        minPath.add (PElement (n, false));
+    int minCost = getTotalCost (minPath, ends);
+    
+    // Greedy tours from every path both ways round, as long as there's
+    // time. Small sketches get them all; big ones get as many as a third
+    // of the budget allows, but always the first.
+    double greedyEnd = Time::getMillisecondCounterHiRes() + timeBudgetMs / 3.0;
+    Array<PElement> tour;
+    
+    for (auto n = 0; n < original.size() * 2; ++n)
+    {
+        if (n && (Time::getMillisecondCounterHiRes() > greedyEnd || (shouldStop && shouldStop())))
+            break;
         
-        length = getTotalLength (dst);
-        if (length < minLength)
+        greedyTour (PElement (n >> 1, (n & 1) != 0), tree, tour);
+        int tourCost = getTotalCost (tour, ends);
+        if (tourCost < minCost)
         {
-            minLength = length;
-            minPath = dst;
+            minCost = tourCost;
+            minPath = tour;
         }
     }
     
+    // Then polish the best one for the rest of the time
+    if (! (shouldStop && shouldStop()))
+    {
+        TourImprover improver (minPath, ends, tree);
+        improver.run (endTime, shouldStop);
+    }
+    
     for (auto n = 0; n < minPath.size(); ++n)
     {
         if (minPath[n].reversed)
@@ -172,3 +601,253 @@ void ShortestPath::find (const Array<IPath>& original, Array<IPath>& shortest)
             shortest.add (original[minPath[n].index]);
     }
 }
+
+int ShortestPath::getTourCost (const Array<IPath>& paths, const TransitionCost& cost)
+{
+    PathEnds ends (paths, cost);
+    
+    Array<PElement> tour;
+    for (auto n = 0; n < paths.size(); ++n)
+        tour.add (PElement (n, false));
+    
+    return getTotalCost (tour, ends);
+}
+
+//==============================================================================
+// Where a looped tour starts (and so ends) when it starts at endpoint start
+class TourStart
+{
+public:
+    TourStart() : start (0), z (0) {}
+    
+    TourStart (const Array<IPath>& tour, int s)
+    : start (s)
+    {
+        const IPath& path = tour.getReference (start >> 1);
+        const Anchor& a = path.getAnchor ((start & 1) ? path.getAnchorCount() - 1 : 0);
+        point = Point<int> (a.getX(), a.getY());
+        z = (start & 1) ? path.getEndZ() : path.getStartZ();
+    }
+    
+    int getCost (const TourStart& to, const TransitionCost& cost) const
+    {
+        return cost.getCost (point, z, to.point, to.z);
+    }
+    
+    int start;
+    Point<int> point;
+    int z;
+};
+
+// Starts worth trying for a tour: where it starts now, and the endpoints
+// cheapest to get to from where its neighbours start now
+static void getStartCandidates (const Array<IPath>& tour, const TourStart& current,
+                                const TourStart& before, const TourStart& after,
+                                const TransitionCost& cost, int nearest,
+                                Array<TourStart>& candidates)
+{
+    candidates.clearQuick();
+    candidates.add (current);
+    
+    Array<TourStart> all;
+    for (auto e = 0; e < tour.size() * 2; ++e)
+        all.add (TourStart (tour, e));
+    
+    for (auto neighbour : { &before, &after })
+    {
+        Array<std::pair<int, int>> byCost;
+        for (auto e = 0; e < all.size(); ++e)
+            byCost.add (std::make_pair (neighbour->getCost (all.getReference (e), cost), e));
+        
+        int count = jmin (nearest, byCost.size());
+        std::partial_sort (byCost.begin(), byCost.begin() + count, byCost.end());
+        
+        for (auto n = 0; n < count; ++n)
+        {
+            const TourStart& s = all.getReference (byCost[n].second);
+            bool dupe = false;
+            for (auto& c : candidates)
+                dupe = dupe || c.start == s.start;
+            
+            if (! dupe)
+                candidates.add (s);
+        }
+    }
+}
+
+// Cheapest way round the loop of frames with the first frame starting at
+// its candidate first. Fills in the candidate picked for every frame when
+// picks isn't null.
+static int stitchFrom (const Array<Array<TourStart>>& candidates, int first,
+                       const TransitionCost& cost, Array<int>* picks)
+{
+    const TourStart& origin = candidates.getReference (0).getReference (first);
+    Array<TourStart> start;
+    start.add (origin);
+    
+    Array<int> best;
+    best.add (0);
+    Array<Array<int>> from;
+    from.resize (candidates.size());
+    
+    Array<int> next;
+    for (auto f = 1; f < candidates.size(); ++f)
+    {
+        const Array<TourStart>& was = f == 1 ? start : candidates.getReference (f - 1);
+        const Array<TourStart>& now = candidates.getReference (f);
+        
+        next.clearQuick();
+        for (auto j = 0; j < now.size(); ++j)
+        {
+            int minCost = std::numeric_limits<int>::max();
+            int minFrom = 0;
+            
+            for (auto i = 0; i < was.size(); ++i)
+            {
+                int c = best[i] + was.getReference (i).getCost (now.getReference (j), cost);
+                if (c < minCost)
+                {
+                    minCost = c;
+                    minFrom = i;
+                }
+            }
+            
+            next.add (minCost);
+            from.getReference (f).add (minFrom);
+        }
+        
+        best.swapWith (next);
+    }
+    
+    // And back round to the first
+    const Array<TourStart>& last = candidates.getLast();
+    int total = std::numeric_limits<int>::max();
+    int pick = 0;
+    for (auto j = 0; j < best.size(); ++j)
+    {
+        int c = best[j] + last.getReference (j).getCost (origin, cost);
+        if (c < total)
+        {
+            total = c;
+            pick = j;
+        }
+    }
+    
+    if (picks != nullptr)
+    {
+        picks->clearQuick();
+        picks->insertMultiple (0, 0, candidates.size());
+        for (auto f = candidates.size() - 1; f > 0; --f)
+        {
+            picks->set (f, pick);
+            pick = from.getReference (f)[pick];
+        }
+        picks->set (0, first);
+    }
+    
+    return total;
+}
+
+//==============================================================================
+void ShortestPath::startTourAt (const Array<IPath>& tour, int start, Array<IPath>& result)
+{
+    result.clearQuick();
+    
+    int count = tour.size();
+    int first = start >> 1;
+    for (auto n = 0; n < count; ++n)
+    {
+        // Backwards round the loop from the end of the first path
+        if (start & 1)
+            result.add (tour[(first - n + count) % count].reversed());
+        else
+            result.add (tour[(first + n) % count]);
+    }
+}
+
+int ShortestPath::getBoundaryCost (const Array<Array<IPath>>& tours, const Array<int>& starts,
+                                   const TransitionCost& cost)
+{
+    Array<TourStart> used;
+    for (auto n = 0; n < tours.size(); ++n)
+        if (tours.getReference (n).size())
+            used.add (TourStart (tours.getReference (n), starts[n]));
+    
+    int total = 0;
+    for (auto n = 0; n < used.size(); ++n)
+        total += used.getReference (n).getCost (used.getReference ((n + 1) % used.size()), cost);
+    
+    return total;
+}
+
+int ShortestPath::chooseStarts (const Array<Array<IPath>>& tours, Array<int>& starts,
+                                const TransitionCost& cost, int nearest, int rounds)
+{
+    starts.clearQuick();
+    starts.insertMultiple (0, 0, tours.size());
+    
+    // Empty frames don't take part
+    Array<int> frames;
+    for (auto n = 0; n < tours.size(); ++n)
+        if (tours.getReference (n).size())
+            frames.add (n);
+    
+    if (frames.size() < 2)
+        return 0;
+    
+    Array<TourStart> current;
+    for (auto f : frames)
+        current.add (TourStart (tours.getReference (f), 0));
+    
+    int total = getBoundaryCost (tours, starts, cost);
+    
+    // Each round only looks at starts near where the neighbours start now.
+    // Where the frame starts now is always a candidate, so a round can
+    // never make things worse.
+    Array<Array<TourStart>> candidates;
+    candidates.resize (frames.size());
+    
+    for (auto r = 0; r < rounds; ++r)
+    {
+        int count = frames.size();
+        WorkerPool::forChunks (count, 1, [&] (int start, int end)
+        {
+            for (auto f = start; f < end; ++f)
+                getStartCandidates (tours.getReference (frames[f]), current.getReference (f),
+                                    current.getReference ((f + count - 1) % count),
+                                    current.getReference ((f + 1) % count),
+                                    cost, nearest, candidates.getReference (f));
+        });
+        
+        // The loop has no natural start, so try every start of the first frame
+        int firstCount = candidates.getReference (0).size();
+        Array<int> totals;
+        totals.insertMultiple (0, 0, firstCount);
+        
+        WorkerPool::forChunks (firstCount, 1, [&] (int start, int end)
+        {
+            for (auto c = start; c < end; ++c)
+                totals.set (c, stitchFrom (candidates, c, cost, nullptr));
+        });
+        
+        int first = 0;
+        for (auto c = 1; c < firstCount; ++c)
+            if (totals[c] < totals[first])
+                first = c;
+        
+        if (totals[first] >= total)
+            break;
+        
+        total = totals[first];
+        
+        Array<int> picks;
+        stitchFrom (candidates, first, cost, &picks);
+        for (auto f = 0; f < count; ++f)
+        {
+            current.set (f, candidates.getReference (f).getReference (picks[f]));
+            starts.set (frames[f], current.getReference (f).start);
+        }
+    }
+    
+    return total;
+}
@@ -21,9 +21,79 @@
 
 #include <JuceHeader.h>
 #include "IPath.h"
+#include "BlankMove.h"
 
+// What the blanked move from the end of one path to the start of the next
+// costs. Has to be the same both ways round.
+class TransitionCost
+{
+public:
+    virtual ~TransitionCost() {}
+    
+    virtual int getCost (Point<int> from, int fromZ, Point<int> to, int toZ) const = 0;
+    
+    // The least any move covering at least distance can cost, searches use
+    // it to skip whole areas
+    virtual int getMinimumCost (int distance) const = 0;
+};
+
+// Straight line gap
+class DistanceCost : public TransitionCost
+{
+public:
+    int getCost (Point<int> from, int fromZ, Point<int> to, int toZ) const override;
+    int getMinimumCost (int distance) const override;
+};
+
+// Blanked points connectIPaths and generatePointsFromPaths will put out for
+// the move, so the cheapest order is the one with the best frame rate
+class BlankPointCost : public TransitionCost
+{
+public:
+    BlankPointCost (const BlankMove& move);
+    
+    int getCost (Point<int> from, int fromZ, Point<int> to, int toZ) const override;
+    int getMinimumCost (int distance) const override;
+    
+private:
+    BlankMove move;
+};
+
+// Length of the blanked move with Z included
+class MoveLengthCost : public TransitionCost
+{
+public:
+    int getCost (Point<int> from, int fromZ, Point<int> to, int toZ) const override;
+    int getMinimumCost (int distance) const override;
+};
+
+// Orders (and flips) paths to make the moves between them as cheap as
+// possible, treating the frame as a loop. Greedy tours come first, then
+// 2-opt and Or-opt moves on the best of them until nothing improves, the
+// time budget is used up or shouldStop returns true. shortest always gets
+// every path.
 class ShortestPath
 {
 public:
-    static void find (const Array<IPath>& original, Array<IPath>& shortest);
+    static void find (const Array<IPath>& original, Array<IPath>& shortest,
+                      const TransitionCost& cost = DistanceCost(),
+                      double timeBudgetMs = 250.0,
+                      const std::function<bool()>& shouldStop = nullptr);
+    
+    // Cost of all the moves in paths as they are, back to the first included
+    static int getTourCost (const Array<IPath>& paths, const TransitionCost& cost);
+    
+    // A tour is a loop, so it can start at any path going either way round
+    // for the same cost. Starts are 2 * index to start with that path as it
+    // is and 2 * index + 1 to start from its end going backwards.
+    static void startTourAt (const Array<IPath>& tour, int start, Array<IPath>& result);
+    
+    // For the tours of consecutive frames, picks the starts that make the
+    // jumps from where each frame starts (and ends) to where the next one
+    // starts, and from the last back to the first, cheapest. Frames without
+    // paths are skipped over. Returns the cost of those jumps.
+    static int chooseStarts (const Array<Array<IPath>>& tours, Array<int>& starts,
+                             const TransitionCost& cost, int nearest = 16, int rounds = 4);
+    static int getBoundaryCost (const Array<Array<IPath>>& tours, const Array<int>& starts,
+                                const TransitionCost& cost);
 };
@@ -0,0 +1,170 @@
+/*
+    SketchCache.cpp
+    Rendered point runs of sketch paths, keyed by path content
+ 
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "SketchCache.h"
+
+//==============================================================================
+class SketchCache::Entry
+{
+public:
+    MemoryBlock key;
+    Array<Frame::IPoint> points;
+    uint32 lastUse;
+};
+
+//==============================================================================
+SketchCache::SketchCache (int max)
+: maxPoints (max), totalPoints (0), useCount (0)
+{
+}
+
+SketchCache::~SketchCache()
+{
+    clear();
+}
+
+bool SketchCache::find (const IPath& path, Frame::ViewAngle view, float tolerance, Array<Frame::IPoint>& points)
+{
+    if (path.isBlankMove())
+        return false;
+    
+    MemoryBlock key;
+    makeKey (path, view, tolerance, key);
+    int64 hash = hashKey (key);
+    
+    const ScopedLock l (lock);
+    
+    Entry* e = entries[hash];
+    // A different path with the same hash just counts as a miss
+    if (e == nullptr || e->key != key)
+    {
+        ++misses;
+        return false;
+    }
+    
+    e->lastUse = ++useCount;
+    points.addArray (e->points);
+    ++hits;
+    return true;
+}
+
+void SketchCache::add (const IPath& path, Frame::ViewAngle view, float tolerance, const Array<Frame::IPoint>& points)
+{
+    // Never going to fit, or depends on more than the path
+    if (points.size() > maxPoints || path.isBlankMove())
+        return;
+    
+    MemoryBlock key;
+    makeKey (path, view, tolerance, key);
+    int64 hash = hashKey (key);
+    
+    const ScopedLock l (lock);
+    
+    Entry* e = entries[hash];
+    if (e == nullptr)
+    {
+        e = new Entry();
+        entries.set (hash, e);
+    }
+    else
+        totalPoints -= e->points.size();
+    
+    e->key = key;
+    e->points = points;
+    e->lastUse = ++useCount;
+    totalPoints += points.size();
+    
+    if (totalPoints > maxPoints)
+        trim();
+}
+
+void SketchCache::clear()
+{
+    const ScopedLock l (lock);
+    
+    for (HashMap<int64, Entry*>::Iterator i (entries); i.next();)
+        delete i.getValue();
+    
+    entries.clear();
+    totalPoints = 0;
+}
+
+//==============================================================================
+void SketchCache::makeKey (const IPath& path, Frame::ViewAngle view, float tolerance, MemoryBlock& key)
+{
+    MemoryOutputStream out (key, false);
+    
+    out.writeInt ((int)view);
+    out.writeFloat (tolerance);
+    out.writeInt ((int)path.getColor().getARGB());
+    out.writeInt (path.getStartZ());
+    out.writeInt (path.getEndZ());
+    out.writeShort ((short)path.getPointDensity());
+    out.writeShort ((short)path.getExtraPointsPerAnchor());
+    out.writeShort ((short)path.getExtraPointsAtStart());
+    out.writeShort ((short)path.getExtraPointsAtEnd());
+    out.writeShort ((short)path.getBlankedPointsBeforeStart());
+    out.writeShort ((short)path.getBlankedPointsAfterEnd());
+    
+    for (auto n = 0; n < path.getAnchorCount(); ++n)
+    {
+        const Anchor& a = path.getAnchor (n);
+        out.writeInt (a.getX());
+        out.writeInt (a.getY());
+        out.writeInt (a.getEntryXDelta());
+        out.writeInt (a.getEntryYDelta());
+        out.writeInt (a.getExitXDelta());
+        out.writeInt (a.getExitYDelta());
+    }
+}
+
+int64 SketchCache::hashKey (const MemoryBlock& key)
+{
+    // 64 bit FNV-1a
+    uint64 hash = 0xcbf29ce484222325ULL;
+    auto data = static_cast<const uint8*> (key.getData());
+    
+    for (size_t n = 0; n < key.getSize(); ++n)
+    {
+        hash ^= data[n];
+        hash *= 0x100000001b3ULL;
+    }
+    
+    return (int64)hash;
+}
+
+void SketchCache::trim()
+{
+    // Drop the oldest runs until there's a quarter of the room free again,
+    // so this doesn't happen on every add
+    Array<std::pair<uint32, int64>> ages;
+    for (HashMap<int64, Entry*>::Iterator i (entries); i.next();)
+        ages.add ({ i.getValue()->lastUse, i.getKey() });
+    
+    std::sort (ages.begin(), ages.end());
+    
+    int target = maxPoints - maxPoints / 4;
+    for (auto n = 0; n < ages.size() && totalPoints > target; ++n)
+    {
+        Entry* e = entries[ages.getReference (n).second];
+        totalPoints -= e->points.size();
+        entries.remove (ages.getReference (n).second);
+        delete e;
+    }
+}
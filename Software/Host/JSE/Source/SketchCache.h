@@ -0,0 +1,65 @@
+/*
+    SketchCache.h
+    Rendered point runs of sketch paths, keyed by path content
+ 
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Frame.h"
+#include "IPath.h"
+
+// The key is everything that goes into rendering a path (anchors, colour,
+// density, Z, extra and blanked point counts, the view and the adaptive
+// spacing tolerance), so an entry never goes stale, it just stops being
+// asked for. Least recently used runs are dropped once the cache holds
+// more than maxPoints. Blank moves follow the BlankMove settings and are
+// cheap, so they are never kept.
+// All calls lock, so it is fine to share between render jobs.
+class SketchCache
+{
+public:
+    SketchCache (int maxPoints = 2 * 1024 * 1024);
+    ~SketchCache();
+    
+    // Appends the cached run for path to points, false if there isn't one
+    bool find (const IPath& path, Frame::ViewAngle view, float tolerance, Array<Frame::IPoint>& points);
+    void add (const IPath& path, Frame::ViewAngle view, float tolerance, const Array<Frame::IPoint>& points);
+    void clear();
+    
+    // Counts since the last resetStats
+    int getHits() const { return hits.get(); }
+    int getMisses() const { return misses.get(); }
+    void resetStats() { hits = 0; misses = 0; }
+    
+private:
+    class Entry;
+    
+    static void makeKey (const IPath& path, Frame::ViewAngle view, float tolerance, MemoryBlock& key);
+    static int64 hashKey (const MemoryBlock& key);
+    void trim();
+    
+    CriticalSection lock;
+    HashMap<int64, Entry*> entries;
+    int maxPoints;
+    int totalPoints;
+    uint32 useCount;
+    Atomic<int> hits;
+    Atomic<int> misses;
+    
+    JUCE_DECLARE_NON_COPYABLE (SketchCache)
+};
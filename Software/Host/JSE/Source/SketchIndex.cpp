@@ -0,0 +1,341 @@
+/*
+    SketchIndex.cpp
+    Bounding volume trees over sketch anchors, handles and segments
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "SketchIndex.h"
+
+//==============================================================================
+// Keeps its own copy of the anchors, so it can tell when they've changed
+class SketchIndex::PathTree
+{
+public:
+    PathTree (const Array<Anchor>& a)
+    : anchors (a)
+    {
+        int numLeaves = (anchors.size() + leafSize - 1) / leafSize;
+        build (nodes, firstLeaf, numLeaves, [this] (int leaf, Bounds& b)
+        {
+            int start = leaf * leafSize;
+            int end = jmin (anchors.size(), start + leafSize);
+
+            // The last segment ends on the first anchor of the next leaf
+            for (auto n = start; n <= end && n < anchors.size(); ++n)
+            {
+                const Anchor& an = anchors.getReference (n);
+                int x, y;
+                an.getEntryPosition (x, y);
+                add (b, (float)x, (float)y);
+                an.getPosition (x, y);
+                add (b, (float)x, (float)y);
+                if (n < end)
+                {
+                    an.getExitPosition (x, y);
+                    add (b, (float)x, (float)y);
+                }
+            }
+        });
+    }
+
+    bool matches (const Array<Anchor>& a) const
+    {
+        // Anchors are just ints
+        return a.size() == anchors.size() &&
+               ! memcmp (a.begin(), anchors.begin(), (size_t)a.size() * sizeof (Anchor));
+    }
+
+    static void add (Bounds& b, float x, float y)
+    {
+        if (b.x1 > b.x2)
+            b = { x, y, x, y };
+        else
+        {
+            b.x1 = jmin (b.x1, x);
+            b.y1 = jmin (b.y1, y);
+            b.x2 = jmax (b.x2, x);
+            b.y2 = jmax (b.y2, y);
+        }
+    }
+
+    Array<Anchor> anchors;
+    Array<Bounds> nodes;
+    int firstLeaf;
+};
+
+//==============================================================================
+static float getDistance (float x1, float y1, float x2, float y2, Point<float> p)
+{
+    // Empty bounds are never near anything
+    if (x1 > x2)
+        return std::numeric_limits<float>::max();
+
+    float dx = jmax (x1 - p.x, 0.0f, p.x - x2);
+    float dy = jmax (y1 - p.y, 0.0f, p.y - y2);
+    return std::sqrt (dx * dx + dy * dy);
+}
+
+template <typename LeafBounds>
+void SketchIndex::build (Array<Bounds>& nodes, int& firstLeaf, int numLeaves, LeafBounds leafBounds)
+{
+    firstLeaf = 1;
+    while (firstLeaf < numLeaves)
+        firstLeaf <<= 1;
+
+    Bounds empty = { 1.0f, 1.0f, -1.0f, -1.0f };
+    nodes.clearQuick();
+    nodes.insertMultiple (0, empty, firstLeaf * 2);
+
+    for (auto leaf = 0; leaf < numLeaves; ++leaf)
+        leafBounds (leaf, nodes.getReference (firstLeaf + leaf));
+
+    for (auto n = firstLeaf - 1; n > 0; --n)
+    {
+        const Bounds& l = nodes.getReference (2 * n);
+        const Bounds& r = nodes.getReference (2 * n + 1);
+
+        if (l.x1 > l.x2)
+            nodes.set (n, r);
+        else if (r.x1 > r.x2)
+            nodes.set (n, l);
+        else
+            nodes.set (n, { jmin (l.x1, r.x1), jmin (l.y1, r.y1),
+                            jmax (l.x2, r.x2), jmax (l.y2, r.y2) });
+    }
+}
+
+template <typename Visit>
+void SketchIndex::search (const Array<Bounds>& nodes, int firstLeaf, int node,
+                          Point<float> pos, const float& best, Visit& visit)
+{
+    // best shrinks as visit finds things, so later branches prune harder
+    const Bounds& b = nodes.getReference (node);
+    if (getDistance (b.x1, b.y1, b.x2, b.y2, pos) > best)
+        return;
+
+    if (node < firstLeaf)
+    {
+        search (nodes, firstLeaf, 2 * node, pos, best, visit);
+        search (nodes, firstLeaf, 2 * node + 1, pos, best, visit);
+    }
+    else
+        visit (node - firstLeaf);
+}
+
+template <typename Visit>
+void SketchIndex::searchPaths (Point<float> pos, const float& best, int onlyPath, Visit& visit) const
+{
+    if (onlyPath >= 0)
+    {
+        if (onlyPath < trees.size())
+            visit (onlyPath);
+    }
+    else if (trees.size())
+        search (nodes, firstLeaf, 1, pos, best, visit);
+}
+
+//==============================================================================
+SketchIndex::SketchIndex()
+: firstLeaf (1)
+{
+}
+
+SketchIndex::~SketchIndex()
+{
+}
+
+void SketchIndex::clear()
+{
+    trees.clear();
+    nodes.clear();
+    firstLeaf = 1;
+}
+
+int SketchIndex::update (const Array<IPath>& paths)
+{
+    int rebuilt = 0;
+    bool changed = trees.size() != paths.size();
+    trees.removeLast (trees.size() - paths.size());
+
+    for (auto n = 0; n < paths.size(); ++n)
+    {
+        const Array<Anchor>& anchors = paths.getReference (n).getAnchors();
+        if (n < trees.size() && trees.getUnchecked (n)->matches (anchors))
+            continue;
+
+        if (n < trees.size())
+            trees.set (n, new PathTree (anchors));
+        else
+            trees.add (new PathTree (anchors));
+
+        ++rebuilt;
+        changed = true;
+    }
+
+    if (changed)
+        build (nodes, firstLeaf, trees.size(), [this] (int leaf, Bounds& b)
+        {
+            b = trees.getUnchecked (leaf)->nodes.getReference (1);
+        });
+
+    return rebuilt;
+}
+
+//==============================================================================
+bool SketchIndex::findAnchor (Point<float> pos, float radius, Hit& hit, int onlyPath) const
+{
+    float best = radius;
+    bool found = false;
+
+    auto visitPath = [&] (int p)
+    {
+        const PathTree& t = *trees.getUnchecked (p);
+        auto visitLeaf = [&] (int leaf)
+        {
+            int end = jmin (t.anchors.size(), (leaf + 1) * leafSize);
+            for (auto n = leaf * leafSize; n < end; ++n)
+            {
+                const Anchor& a = t.anchors.getReference (n);
+                float d = pos.getDistanceFrom (Point<float> ((float)a.getX(), (float)a.getY()));
+                if (d < best || (! found && d <= best))
+                {
+                    best = d;
+                    found = true;
+                    hit = { p, n, 0, d };
+                }
+            }
+        };
+        if (t.anchors.size())
+            search (t.nodes, t.firstLeaf, 1, pos, best, visitLeaf);
+    };
+
+    searchPaths (pos, best, onlyPath, visitPath);
+    return found;
+}
+
+bool SketchIndex::findHandle (Point<float> pos, float radius, Hit& hit,
+                              int onlyPath, int onlyAnchor) const
+{
+    float best = radius;
+    bool found = false;
+
+    auto visitPath = [&] (int p)
+    {
+        const PathTree& t = *trees.getUnchecked (p);
+        auto visitLeaf = [&] (int leaf)
+        {
+            int end = jmin (t.anchors.size(), (leaf + 1) * leafSize);
+            for (auto n = leaf * leafSize; n < end; ++n)
+            {
+                if (onlyAnchor >= 0 && n != onlyAnchor)
+                    continue;
+
+                const Anchor& a = t.anchors.getReference (n);
+                for (auto control = 1; control <= 2; ++control)
+                {
+                    int x, y;
+                    if (control == 1)
+                    {
+                        if (! a.getEntryXDelta() && ! a.getEntryYDelta())
+                            continue;
+                        a.getEntryPosition (x, y);
+                    }
+                    else
+                    {
+                        if (! a.getExitXDelta() && ! a.getExitYDelta())
+                            continue;
+                        a.getExitPosition (x, y);
+                    }
+
+                    float d = pos.getDistanceFrom (Point<float> ((float)x, (float)y));
+                    if (d < best || (! found && d <= best))
+                    {
+                        best = d;
+                        found = true;
+                        hit = { p, n, control, d };
+                    }
+                }
+            }
+        };
+        if (t.anchors.size())
+            search (t.nodes, t.firstLeaf, 1, pos, best, visitLeaf);
+    };
+
+    searchPaths (pos, best, onlyPath, visitPath);
+    return found;
+}
+
+bool SketchIndex::findSegment (Point<float> pos, float radius, Hit& hit) const
+{
+    float best = radius;
+    bool found = false;
+
+    auto visitPath = [&] (int p)
+    {
+        const PathTree& t = *trees.getUnchecked (p);
+        auto visitLeaf = [&] (int leaf)
+        {
+            int end = jmin (t.anchors.size(), (leaf + 1) * leafSize);
+            for (auto n = leaf * leafSize; n < end; ++n)
+            {
+                const Anchor& a = t.anchors.getReference (n);
+                Point<float> nearest ((float)a.getX(), (float)a.getY());
+
+                if (t.anchors.size() > 1)
+                {
+                    if (n + 1 >= t.anchors.size())
+                        break;
+
+                    const Anchor& b = t.anchors.getReference (n + 1);
+                    int x1, y1, x2, y2;
+                    a.getExitPosition (x1, y1);
+                    b.getEntryPosition (x2, y2);
+
+                    // Skip segments whose hull is too far off to beat best
+                    float hx1 = (float)jmin (a.getX(), x1, x2, b.getX());
+                    float hy1 = (float)jmin (a.getY(), y1, y2, b.getY());
+                    float hx2 = (float)jmax (a.getX(), x1, x2, b.getX());
+                    float hy2 = (float)jmax (a.getY(), y1, y2, b.getY());
+                    if (getDistance (hx1, hy1, hx2, hy2, pos) > best)
+                        continue;
+
+                    // Same curve IPath draws
+                    Path segment;
+                    segment.startNewSubPath (nearest);
+                    if (x1 == a.getX() && y1 == a.getY() && x2 == b.getX() && y2 == b.getY())
+                        segment.lineTo ((float)b.getX(), (float)b.getY());
+                    else
+                        segment.cubicTo ((float)x1, (float)y1, (float)x2, (float)y2,
+                                         (float)b.getX(), (float)b.getY());
+                    segment.getNearestPoint (pos, nearest);
+                }
+
+                float d = pos.getDistanceFrom (nearest);
+                if (d < best || (! found && d <= best))
+                {
+                    best = d;
+                    found = true;
+                    hit = { p, n, 0, d };
+                }
+            }
+        };
+        if (t.anchors.size())
+            search (t.nodes, t.firstLeaf, 1, pos, best, visitLeaf);
+    };
+
+    searchPaths (pos, best, -1, visitPath);
+    return found;
+}
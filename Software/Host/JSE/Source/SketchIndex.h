@@ -0,0 +1,85 @@
+/*
+    SketchIndex.h
+    Bounding volume trees over sketch anchors, handles and segments
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "IPath.h"
+
+// Each path gets a tree whose leaves are runs of consecutive anchors, with
+// their handles and the hulls of the segments leaving them, and a tree over
+// the paths sits on top. update() only rebuilds the trees of paths whose
+// anchors changed. Queries take the closest match within radius, ties go
+// to the lowest path and anchor.
+class SketchIndex
+{
+public:
+    SketchIndex();
+    ~SketchIndex();
+
+    // Returns how many path trees had to be rebuilt
+    int update (const Array<IPath>& paths);
+    void clear();
+
+    int getPathCount() const { return trees.size(); }
+
+    struct Hit
+    {
+        int path;
+        // For segments, the anchor the segment leaves from
+        int anchor;
+        // 1 for the entry handle, 2 for the exit one, 0 otherwise
+        int control;
+        float distance;
+    };
+
+    // onlyPath and onlyAnchor narrow the search when they aren't -1
+    bool findAnchor (Point<float> pos, float radius, Hit& hit, int onlyPath = -1) const;
+    bool findHandle (Point<float> pos, float radius, Hit& hit,
+                     int onlyPath = -1, int onlyAnchor = -1) const;
+    // A path with one anchor is hit on the anchor
+    bool findSegment (Point<float> pos, float radius, Hit& hit) const;
+
+    // Anchors per leaf
+    static const int leafSize = 8;
+
+private:
+    struct Bounds
+    {
+        float x1, y1, x2, y2;
+    };
+
+    class PathTree;
+
+    template <typename LeafBounds>
+    static void build (Array<Bounds>& nodes, int& firstLeaf, int numLeaves, LeafBounds leafBounds);
+    template <typename Visit>
+    static void search (const Array<Bounds>& nodes, int firstLeaf, int node,
+                        Point<float> pos, const float& best, Visit& visit);
+    template <typename Visit>
+    void searchPaths (Point<float> pos, const float& best, int onlyPath, Visit& visit) const;
+
+    OwnedArray<PathTree> trees;
+
+    // Same layout as SegmentIndex, leaf n is path n
+    Array<Bounds> nodes;
+    int firstLeaf;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SketchIndex)
+};
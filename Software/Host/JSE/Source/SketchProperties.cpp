@@ -25,7 +25,7 @@
 SketchProperties::SketchProperties (FrameEditor* editor)
 {
     frameEditor = editor;
-    frameEditor->addActionListener (this);
+    frameEditor->addEditorListener (this);
     
     layerVisible.reset (new juce::ToggleButton ("layerVisible"));
     addAndMakeVisible (layerVisible.get());
@@ -124,6 +124,27 @@ SketchProperties::SketchProperties (FrameEditor* editor)
     penToolButton->setTooltip ("Pen Tool (click for Line, click and drag for Curve)");
     penToolButton->addListener (this);
 
+    {
+        // A squiggle, drawn rather than a png so it needs no resource
+        Path squiggle;
+        squiggle.startNewSubPath (3.0f, 17.0f);
+        squiggle.cubicTo (6.0f, 3.0f, 10.0f, 3.0f, 11.0f, 12.0f);
+        squiggle.cubicTo (12.0f, 21.0f, 17.0f, 21.0f, 21.0f, 6.0f);
+        auto icon = std::make_unique<DrawablePath>();
+        icon->setPath (squiggle);
+        icon->setFill (Colours::transparentBlack);
+        icon->setStrokeFill (Colours::black);
+        icon->setStrokeType (PathStrokeType (2.0f, PathStrokeType::curved, PathStrokeType::rounded));
+        freehandIcon = std::move (icon);
+    }
+    
+    freehandToolButton.reset (new DrawableButton ("freehandToolButton", DrawableButton::ImageOnButtonBackground));
+    addAndMakeVisible (freehandToolButton.get());
+    freehandToolButton->setImages (freehandIcon.get());
+    freehandToolButton->setEdgeIndent (0);
+    freehandToolButton->setTooltip ("Freehand Tool (drag to draw, it's fitted with curves as you go)");
+    freehandToolButton->addListener (this);
+
     toolColorButton.reset (new ColourButton ());
     addAndMakeVisible (toolColorButton.get());
     toolColorButton->setTooltip ("Select color for drawing tools");
@@ -418,6 +439,7 @@ SketchProperties::SketchProperties (FrameEditor* editor)
 
 SketchProperties::~SketchProperties()
 {
+    frameEditor->removeEditorListener (this);
     layerVisible = nullptr;
     renderButton = nullptr;
     renderIcon = nullptr;
@@ -437,6 +459,8 @@ SketchProperties::~SketchProperties()
     centerEllipseIcon = nullptr;
     penToolButton = nullptr;
     penIcon = nullptr;
+    freehandToolButton = nullptr;
+    freehandIcon = nullptr;
     toolColorButton = nullptr;
     selectLabel = nullptr;
     pointsLabel = nullptr;
@@ -497,6 +521,7 @@ void SketchProperties::resized()
     centerEllipseToolButton->setBounds (46 + 12, 84, 32, 32);
     selectToolButton->setBounds (82 + 12, 84, 32, 32);
     moveToolButton->setBounds (118 + 12, 84, 32, 32);
+    freehandToolButton->setBounds (154 + 12, 84, 32, 32);
 
     selectLabel->setBounds (16, 88 + 36, getWidth() - 32, 24);
     pointsLabel->setBounds (16, 104 + 36, getWidth() - 32, 24);
@@ -549,6 +574,8 @@ void SketchProperties::buttonClicked (juce::Button* buttonThatWasClicked)
         frameEditor->setActiveSketchTool (FrameEditor::sketchCenterEllipseTool);
     else if (buttonThatWasClicked == penToolButton.get())
         frameEditor->setActiveSketchTool (FrameEditor::sketchPenTool);
+    else if (buttonThatWasClicked == freehandToolButton.get())
+        frameEditor->setActiveSketchTool (FrameEditor::sketchFreehandTool);
     else if (buttonThatWasClicked == centerButton.get())
         frameEditor->centerSketchSelected (true, true, false);
     else if (buttonThatWasClicked == centerXButton.get())
@@ -648,21 +675,22 @@ void SketchProperties::textEditorFocusLost (TextEditor&)
 }
 
 //==============================================================================
-void SketchProperties::actionListenerCallback (const String& message)
+void SketchProperties::editorChanged (const EditorChanges& changes)
 {
-    if (message == EditorActions::sketchVisibilityChanged)
+    // Covers all the changes
+    if (changes.has (EditorActions::sketchVisibilityChanged | EditorActions::framesChanged))
         refresh();
-    else if (message == EditorActions::framesChanged)
-        refresh();
-    else if (message == EditorActions::sketchToolChanged)
-        updateTools();
-    else if (message == EditorActions::sketchToolColorChanged)
-        updateTools();
-    else if (message == EditorActions::iPathSelectionChanged)
-        updateSelection();
-    else if (message == EditorActions::iPathsChanged)
-        updateSelection();
-    else if (message == EditorActions::deleteRequest)
+    else
+    {
+        if (changes.has (EditorActions::sketchToolChanged | EditorActions::sketchToolColorChanged))
+            updateTools();
+        
+        if (changes.has (EditorActions::iPathSelectionChanged | EditorActions::scanRateChanged | EditorActions::iPathsChanged))
+            updateSelection();
+    }
+    
+    // Requests always come on their own
+    if (changes.has (EditorActions::deleteRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::sketch)
         {
@@ -675,7 +703,7 @@ void SketchProperties::actionListenerCallback (const String& message)
             }
         }
     }
-    else if (message == EditorActions::cancelRequest)
+    else if (changes.has (EditorActions::cancelRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::sketch)
         {
@@ -683,42 +711,42 @@ void SketchProperties::actionListenerCallback (const String& message)
                 frameEditor->setIPathSelection (IPathSelection());
         }
     }
-    else if (message == EditorActions::upRequest)
+    else if (changes.has (EditorActions::upRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::sketch)
             frameEditor->moveSketchSelected (0, -256);
     }
-    else if (message == EditorActions::downRequest)
+    else if (changes.has (EditorActions::downRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::sketch)
             frameEditor->moveSketchSelected (0, 256);
     }
-    else if (message == EditorActions::leftRequest)
+    else if (changes.has (EditorActions::leftRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::sketch)
             frameEditor->moveSketchSelected (-256, 0);
     }
-    else if (message == EditorActions::rightRequest)
+    else if (changes.has (EditorActions::rightRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::sketch)
             frameEditor->moveSketchSelected (256, 0);
     }
-    else if (message == EditorActions::smallUpRequest)
+    else if (changes.has (EditorActions::smallUpRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::sketch)
             frameEditor->moveSketchSelected (0, -16);
     }
-    else if (message == EditorActions::smallDownRequest)
+    else if (changes.has (EditorActions::smallDownRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::sketch)
             frameEditor->moveSketchSelected (0, 16);
     }
-    else if (message == EditorActions::smallLeftRequest)
+    else if (changes.has (EditorActions::smallLeftRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::sketch)
             frameEditor->moveSketchSelected (-16, 0);
     }
-    else if (message == EditorActions::smallRightRequest)
+    else if (changes.has (EditorActions::smallRightRequest))
     {
         if (frameEditor->getActiveLayer() == FrameEditor::sketch)
             frameEditor->moveSketchSelected (16, 0);
@@ -911,94 +939,17 @@ void SketchProperties::updateSelection()
 
 void SketchProperties::updateTools()
 {
-    if (frameEditor->getActiveSketchTool() == FrameEditor::sketchSelectTool)
-    {
-        selectToolButton->setToggleState (true, dontSendNotification);
-        moveToolButton->setToggleState (false, dontSendNotification);
-        ellipseToolButton->setToggleState (false, dontSendNotification);
-        penToolButton->setToggleState (false, dontSendNotification);
-        lineToolButton->setToggleState (false, dontSendNotification);
-        rectToolButton->setToggleState (false, dontSendNotification);
-        centerRectToolButton->setToggleState (false, dontSendNotification);
-        centerEllipseToolButton->setToggleState (false, dontSendNotification);
-    }
-    else if (frameEditor->getActiveSketchTool() == FrameEditor::sketchMoveTool)
-    {
-        selectToolButton->setToggleState (false, dontSendNotification);
-        moveToolButton->setToggleState (true, dontSendNotification);
-        ellipseToolButton->setToggleState (false, dontSendNotification);
-        penToolButton->setToggleState (false, dontSendNotification);
-        lineToolButton->setToggleState (false, dontSendNotification);
-        rectToolButton->setToggleState (false, dontSendNotification);
-        centerRectToolButton->setToggleState (false, dontSendNotification);
-        centerEllipseToolButton->setToggleState (false, dontSendNotification);
-    }
-    else if (frameEditor->getActiveSketchTool() == FrameEditor::sketchEllipseTool)
-    {
-        selectToolButton->setToggleState (false, dontSendNotification);
-        moveToolButton->setToggleState (false, dontSendNotification);
-        ellipseToolButton->setToggleState (true, dontSendNotification);
-        penToolButton->setToggleState (false, dontSendNotification);
-        lineToolButton->setToggleState (false, dontSendNotification);
-        rectToolButton->setToggleState (false, dontSendNotification);
-        centerRectToolButton->setToggleState (false, dontSendNotification);
-        centerEllipseToolButton->setToggleState (false, dontSendNotification);
-    }
-    else if (frameEditor->getActiveSketchTool() == FrameEditor::sketchLineTool)
-    {
-        selectToolButton->setToggleState (false, dontSendNotification);
-        moveToolButton->setToggleState (false, dontSendNotification);
-        ellipseToolButton->setToggleState (false, dontSendNotification);
-        penToolButton->setToggleState (false, dontSendNotification);
-        lineToolButton->setToggleState (true, dontSendNotification);
-        rectToolButton->setToggleState (false, dontSendNotification);
-        centerRectToolButton->setToggleState (false, dontSendNotification);
-        centerEllipseToolButton->setToggleState (false, dontSendNotification);
-    }
-    else if (frameEditor->getActiveSketchTool() == FrameEditor::sketchRectTool)
-    {
-        selectToolButton->setToggleState (false, dontSendNotification);
-        moveToolButton->setToggleState (false, dontSendNotification);
-        ellipseToolButton->setToggleState (false, dontSendNotification);
-        penToolButton->setToggleState (false, dontSendNotification);
-        lineToolButton->setToggleState (false, dontSendNotification);
-        rectToolButton->setToggleState (true, dontSendNotification);
-        centerRectToolButton->setToggleState (false, dontSendNotification);
-        centerEllipseToolButton->setToggleState (false, dontSendNotification);
-    }
-    else if (frameEditor->getActiveSketchTool() == FrameEditor::sketchCenterRectTool)
-    {
-        selectToolButton->setToggleState (false, dontSendNotification);
-        moveToolButton->setToggleState (false, dontSendNotification);
-        ellipseToolButton->setToggleState (false, dontSendNotification);
-        penToolButton->setToggleState (false, dontSendNotification);
-        lineToolButton->setToggleState (false, dontSendNotification);
-        rectToolButton->setToggleState (false, dontSendNotification);
-        centerRectToolButton->setToggleState (true, dontSendNotification);
-        centerEllipseToolButton->setToggleState (false, dontSendNotification);
-    }
-    else if (frameEditor->getActiveSketchTool() == FrameEditor::sketchCenterEllipseTool)
-    {
-        selectToolButton->setToggleState (false, dontSendNotification);
-        moveToolButton->setToggleState (false, dontSendNotification);
-        ellipseToolButton->setToggleState (false, dontSendNotification);
-        penToolButton->setToggleState (false, dontSendNotification);
-        lineToolButton->setToggleState (false, dontSendNotification);
-        rectToolButton->setToggleState (false, dontSendNotification);
-        centerRectToolButton->setToggleState (false, dontSendNotification);
-        centerEllipseToolButton->setToggleState (true, dontSendNotification);
-    }
-    else
-    {
-        selectToolButton->setToggleState (false, dontSendNotification);
-        moveToolButton->setToggleState (false, dontSendNotification);
-        ellipseToolButton->setToggleState (false, dontSendNotification);
-        penToolButton->setToggleState (true, dontSendNotification);
-        lineToolButton->setToggleState (false, dontSendNotification);
-        rectToolButton->setToggleState (false, dontSendNotification);
-        centerRectToolButton->setToggleState (false, dontSendNotification);
-        centerEllipseToolButton->setToggleState (false, dontSendNotification);
-    }
+    FrameEditor::SketchTool tool = frameEditor->getActiveSketchTool();
+    
+    selectToolButton->setToggleState (tool == FrameEditor::sketchSelectTool, dontSendNotification);
+    moveToolButton->setToggleState (tool == FrameEditor::sketchMoveTool, dontSendNotification);
+    ellipseToolButton->setToggleState (tool == FrameEditor::sketchEllipseTool, dontSendNotification);
+    penToolButton->setToggleState (tool == FrameEditor::sketchPenTool, dontSendNotification);
+    lineToolButton->setToggleState (tool == FrameEditor::sketchLineTool, dontSendNotification);
+    rectToolButton->setToggleState (tool == FrameEditor::sketchRectTool, dontSendNotification);
+    centerRectToolButton->setToggleState (tool == FrameEditor::sketchCenterRectTool, dontSendNotification);
+    centerEllipseToolButton->setToggleState (tool == FrameEditor::sketchCenterEllipseTool, dontSendNotification);
+    freehandToolButton->setToggleState (tool == FrameEditor::sketchFreehandTool, dontSendNotification);
 
     toolColorButton->setColour (TextButton::buttonColourId, frameEditor->getSketchToolColor());
 }
@@ -32,7 +32,7 @@
 /*
 */
 class SketchProperties  : public Component,
-                          public ActionListener,
+                          public EditorBus::Listener,
                           public Button::Listener,
                           public TextEditor::Listener,
                           public ChangeListener
@@ -57,7 +57,7 @@ public:
     void changeListenerCallback (ChangeBroadcaster* source) override;
 
     //==============================================================================
-    void actionListenerCallback (const String& message) override;
+    void editorChanged (const EditorChanges& changes) override;
 
 private:
     void refresh();
@@ -85,6 +85,8 @@ private:
     std::unique_ptr<DrawableButton> centerEllipseToolButton;
     std::unique_ptr <Drawable> penIcon;
     std::unique_ptr<DrawableButton> penToolButton;
+    std::unique_ptr <Drawable> freehandIcon;
+    std::unique_ptr<DrawableButton> freehandToolButton;
     std::unique_ptr<ColourButton> toolColorButton;
     std::unique_ptr<Label> selectLabel;
     std::unique_ptr<Label> pointsLabel;
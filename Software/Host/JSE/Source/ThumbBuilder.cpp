@@ -20,6 +20,11 @@
 #include "ThumbBuilder.h"
 
 void ThumbBuilder::build (Frame* frame, Image& thumb, int width, int height, float lineSize)
+{
+    build (frame->getPoints(), thumb, width, height, lineSize);
+}
+
+void ThumbBuilder::build (const Array<Frame::IPoint>& points, Image& thumb, int width, int height, float lineSize)
 {
     thumb = Image(Image::ARGB, width, height, true);
     
@@ -27,38 +32,25 @@ void ThumbBuilder::build (Frame* frame, Image& thumb, int width, int height, flo
     float wScale = width / 65536.0f;
     float hScale = height / 65536.0f;
     
-    for (uint16 n = 0; n < frame->getPointCount(); ++n)
+    for (auto n = 0; n < points.size(); ++n)
     {
-        Frame::IPoint point;
-        
-        if (frame->getPoint (n, point))
+        const Frame::IPoint& point = points.getReference (n);
+        const Frame::IPoint& nextPoint = points.getReference ((n + 1) % points.size());
+
+        if (! (point.status & Frame::BlankedPoint))
         {
-            Frame::IPoint nextPoint;
-            bool b;
+            g.setColour (Colour (point.red, point.green, point.blue));
             
-            if (n < (frame->getPointCount() - 1))
-                b = frame->getPoint (n+1, nextPoint);
-            else
-                b = frame->getPoint (0, nextPoint);
-
-            if (b)
-            {
-                if (! (point.status & Frame::BlankedPoint))
-                {
-                    g.setColour (Colour (point.red, point.green, point.blue));
-                    
-                    // We put in the dots for beam images, etc.
-                    g.fillEllipse (Frame::getCompX(point) * wScale,
-                                   Frame::getCompY(point) * hScale,
-                                   lineSize / 2.0f, lineSize / 2.0f);
+            // We put in the dots for beam images, etc.
+            g.fillEllipse (Frame::getCompX(point) * wScale,
+                           Frame::getCompY(point) * hScale,
+                           lineSize / 2.0f, lineSize / 2.0f);
 
-                    g.drawLine (Frame::getCompX(point) * wScale,
-                                Frame::getCompY(point) * hScale,
-                                Frame::getCompX(nextPoint) * wScale,
-                                Frame::getCompY(nextPoint) * hScale,
-                                lineSize);
-                }
-            }
+            g.drawLine (Frame::getCompX(point) * wScale,
+                        Frame::getCompY(point) * hScale,
+                        Frame::getCompX(nextPoint) * wScale,
+                        Frame::getCompY(nextPoint) * hScale,
+                        lineSize);
         }
     }
 }
@@ -26,4 +26,5 @@ class ThumbBuilder
 {
 public:
     static void build (Frame* frame, Image& thumb, int width, int height, float lineSize = 1.0);
+    static void build (const Array<Frame::IPoint>& points, Image& thumb, int width, int height, float lineSize = 1.0);
 };
@@ -0,0 +1,265 @@
+/*
+    ThumbCache.cpp
+    Frame thumbnails, built when they're wanted and kept to a memory budget
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "ThumbBuilder.h"
+#include "ThumbCache.h"
+
+//==============================================================================
+class ThumbCache::Entry
+{
+public:
+    Image image;
+    uint32 lastUse;
+};
+
+// A build in flight, the destructor waits for these
+class ThumbCache::Job
+{
+public:
+    Job (int64 k, const Array<Frame::IPoint>& p, bool r) : key (k), points (p), refreshing (r) {;}
+    
+    int64 key;
+    Array<Frame::IPoint> points;
+    bool refreshing;
+    WaitableEvent done { true };
+};
+
+//==============================================================================
+ThumbCache::ThumbCache (int64 max)
+: maxBytes (jmax (minBytes, max)), totalBytes (0), useCount (0)
+{
+}
+
+ThumbCache::~ThumbCache()
+{
+    stopTimer();
+    pendingFrames.clear();
+    
+    Array<std::shared_ptr<Job>> waitFor;
+    {
+        const ScopedLock l (lock);
+        waitFor = jobs;
+    }
+    
+    for (auto& job : waitFor)
+        job->done.wait();
+    
+    clear();
+}
+
+//==============================================================================
+Image ThumbCache::get (Frame* frame)
+{
+    int64 key = frame->getThumbKey();
+    
+    {
+        const ScopedLock l (lock);
+        
+        Entry* e = entries[key];
+        if (e != nullptr)
+        {
+            e->lastUse = ++useCount;
+            ++hits;
+            return e->image;
+        }
+    }
+    
+    ++misses;
+    
+    Image image;
+    ThumbBuilder::build (frame->getPoints(), image, thumbWidth, thumbHeight);
+    add (key, image);
+    return image;
+}
+
+Image ThumbCache::peek (Frame* frame)
+{
+    const ScopedLock l (lock);
+    
+    Entry* e = entries[frame->getThumbKey()];
+    return e != nullptr ? e->image : Image();
+}
+
+void ThumbCache::prefetch (Frame* frame)
+{
+    int64 key = frame->getThumbKey();
+    
+    {
+        const ScopedLock l (lock);
+        
+        if (entries.contains (key))
+            return;
+        
+        for (auto& job : jobs)
+            if (job->key == key && ! job->done.wait (0))
+                return;
+    }
+    
+    ++prefetches;
+    startJob (key, frame->getPoints(), false);
+}
+
+void ThumbCache::refresh (Frame* frame)
+{
+    // Every edit pushes it back, so a run of nudges only builds once
+    pendingFrames.addIfNotAlreadyThere (frame);
+    startTimer (debounceMs);
+}
+
+void ThumbCache::timerCallback()
+{
+    stopTimer();
+    
+    for (auto* frame : pendingFrames)
+    {
+        int64 oldKey = frame->getThumbKey();
+        frame->invalidateThumbNail();
+        int64 key = frame->getThumbKey();
+        
+        Entry* e;
+        {
+            const ScopedLock l (lock);
+            
+            // The old one stands in until the new one lands
+            e = entries[oldKey];
+            if (e != nullptr)
+            {
+                entries.remove (oldKey);
+                entries.set (key, e);
+            }
+        }
+        
+        // Nobody is looking at it, it can be built when somebody does
+        if (e != nullptr)
+        {
+            ++refreshes;
+            startJob (key, frame->getPoints(), true);
+        }
+    }
+    
+    pendingFrames.clear();
+}
+
+void ThumbCache::startJob (int64 key, const Array<Frame::IPoint>& points, bool refreshing)
+{
+    auto job = std::make_shared<Job> (key, points, refreshing);
+    
+    {
+        const ScopedLock l (lock);
+        
+        for (auto n = jobs.size(); --n >= 0;)
+            if (jobs.getReference (n)->done.wait (0))
+                jobs.remove (n);
+        
+        jobs.add (job);
+    }
+    
+    pool->addJob ([this, job]
+    {
+        Image image;
+        ThumbBuilder::build (job->points, image, thumbWidth, thumbHeight);
+        add (job->key, image);
+        
+        if (job->refreshing && onRefreshed != nullptr)
+            onRefreshed();
+        
+        job->done.signal();
+    });
+}
+
+void ThumbCache::clear()
+{
+    const ScopedLock l (lock);
+    
+    for (HashMap<int64, Entry*>::Iterator i (entries); i.next();)
+        delete i.getValue();
+    
+    entries.clear();
+    totalBytes = 0;
+}
+
+//==============================================================================
+void ThumbCache::setMaxBytes (int64 bytes)
+{
+    const ScopedLock l (lock);
+    
+    maxBytes = jmax (minBytes, bytes);
+    if (totalBytes > maxBytes)
+        trim();
+}
+
+int64 ThumbCache::getBytes() const
+{
+    const ScopedLock l (lock);
+    return totalBytes;
+}
+
+int ThumbCache::getCount() const
+{
+    const ScopedLock l (lock);
+    return entries.size();
+}
+
+//==============================================================================
+int64 ThumbCache::getSize (const Image& image)
+{
+    return (int64)image.getWidth() * image.getHeight() * 4;
+}
+
+void ThumbCache::add (int64 key, const Image& image)
+{
+    const ScopedLock l (lock);
+    
+    Entry* e = entries[key];
+    if (e == nullptr)
+    {
+        e = new Entry();
+        entries.set (key, e);
+    }
+    else
+        totalBytes -= getSize (e->image);
+    
+    e->image = image;
+    e->lastUse = ++useCount;
+    totalBytes += getSize (image);
+    
+    if (totalBytes > maxBytes)
+        trim();
+}
+
+void ThumbCache::trim()
+{
+    // Drop the oldest thumbnails until there's a quarter of the room free
+    // again, so this doesn't happen on every add
+    Array<std::pair<uint32, int64>> ages;
+    for (HashMap<int64, Entry*>::Iterator i (entries); i.next();)
+        ages.add ({ i.getValue()->lastUse, i.getKey() });
+    
+    std::sort (ages.begin(), ages.end());
+    
+    int64 target = maxBytes - maxBytes / 4;
+    for (auto n = 0; n < ages.size() && totalBytes > target; ++n)
+    {
+        Entry* e = entries[ages.getReference (n).second];
+        totalBytes -= getSize (e->image);
+        entries.remove (ages.getReference (n).second);
+        delete e;
+        ++evictions;
+    }
+}
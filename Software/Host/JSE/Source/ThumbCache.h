@@ -0,0 +1,102 @@
+/*
+    ThumbCache.h
+    Frame thumbnails, built when they're wanted and kept to a memory budget
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Frame.h"
+
+// Entries are keyed by the frame's thumb key, which a refresh moves on.
+// The old image is carried over to the new key so get() keeps handing it
+// back until the rebuild lands, then it is replaced. Least recently used
+// thumbnails are dropped once the cache holds more than maxBytes.
+// All calls lock, prefetch() and refresh() build on the shared ThreadPool
+// from a copy of the points so the frame can carry on being edited
+// meanwhile. refresh() has to be called on the message thread.
+class ThumbCache : private Timer
+{
+public:
+    ThumbCache (int64 maxBytes = 64 * 1024 * 1024);
+    ~ThumbCache() override;
+    
+    // Builds it right here on a miss
+    Image get (Frame* frame);
+    // Whatever is cached, without building or counting it
+    Image peek (Frame* frame);
+    // Builds it in the background if it isn't cached or on the way already
+    void prefetch (Frame* frame);
+    // The frame changed. Once it has been left alone for debounceMs the
+    // thumbnail is built again in the background, get() hands back the
+    // old one until then.
+    void refresh (Frame* frame);
+    void clear();
+    
+    // Called from a pool thread whenever refreshed thumbnails land
+    std::function<void()> onRefreshed;
+    
+    void setMaxBytes (int64 bytes);
+    int64 getMaxBytes() const { return maxBytes; }
+    int64 getBytes() const;
+    int getCount() const;
+    
+    // Counts since the last resetStats
+    int getHits() const { return hits.get(); }
+    int getMisses() const { return misses.get(); }
+    int getEvictions() const { return evictions.get(); }
+    int getPrefetches() const { return prefetches.get(); }
+    int getRefreshes() const { return refreshes.get(); }
+    void resetStats() { hits = 0; misses = 0; evictions = 0; prefetches = 0; refreshes = 0; }
+    
+    static const int thumbWidth = 150;
+    static const int thumbHeight = 150;
+    // Never less than this, or the visible rows would keep pushing each
+    // other out
+    static const int64 minBytes = 8 * 1024 * 1024;
+    // How long a frame has to be left alone before it's refreshed
+    static const int debounceMs = 250;
+    
+private:
+    class Entry;
+    class Job;
+    
+    static int64 getSize (const Image& image);
+    void add (int64 key, const Image& image);
+    void startJob (int64 key, const Array<Frame::IPoint>& points, bool refreshing);
+    void trim();
+    void timerCallback() override;
+    
+    CriticalSection lock;
+    HashMap<int64, Entry*> entries;
+    Array<std::shared_ptr<Job>> jobs;
+    // Waiting out the debounce, message thread only
+    ReferenceCountedArray<Frame> pendingFrames;
+    int64 maxBytes;
+    int64 totalBytes;
+    uint32 useCount;
+    Atomic<int> hits;
+    Atomic<int> misses;
+    Atomic<int> evictions;
+    Atomic<int> prefetches;
+    Atomic<int> refreshes;
+    
+    // Keeps the pool threads alive while we're around
+    SharedResourcePointer<ThreadPool> pool;
+    
+    JUCE_DECLARE_NON_COPYABLE (ThumbCache)
+};
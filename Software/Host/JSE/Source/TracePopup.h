@@ -0,0 +1,198 @@
+/*
+    TracePopup.h
+    Auto Trace Reference Image Popup Controls
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include "FrameEditor.h"
+#include <JuceHeader.h>
+
+class TracePopup : public Component,
+                   public juce::Slider::Listener,
+                   public juce::Button::Listener
+{
+public:
+    TracePopup (FrameEditor* editor)
+    : frameEditor (editor)
+    {
+        thresholdSlider.reset (new juce::Slider ("thresholdSlider"));
+        addAndMakeVisible (thresholdSlider.get());
+        thresholdSlider->setRange (1, 99, 1);
+        thresholdSlider->setSliderStyle (juce::Slider::LinearHorizontal);
+        thresholdSlider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 40, 20);
+        thresholdSlider->setColour (juce::Slider::backgroundColourId, juce::Colour (0xff0d1112));
+        thresholdSlider->setTooltip (TRANS("Brightness the outlines are traced at"));
+        thresholdSlider->setTextValueSuffix ("%");
+        thresholdSlider->setValue (50, dontSendNotification);
+        thresholdSlider->addListener (this);
+        thresholdSlider->setBounds (72, 216, 144, 24);
+
+        thresholdLabel.reset (new juce::Label ("thresholdLabel", TRANS("Threshold")));
+        addAndMakeVisible (thresholdLabel.get());
+        thresholdLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+        thresholdLabel->setJustificationType (juce::Justification::centredLeft);
+        thresholdLabel->setBounds (8, 216, 64, 24);
+
+        smoothingSlider.reset (new juce::Slider ("smoothingSlider"));
+        addAndMakeVisible (smoothingSlider.get());
+        smoothingSlider->setRange (0, 8, 0.5);
+        smoothingSlider->setSliderStyle (juce::Slider::LinearHorizontal);
+        smoothingSlider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 40, 20);
+        smoothingSlider->setColour (juce::Slider::backgroundColourId, juce::Colour (0xff0d1112));
+        smoothingSlider->setTooltip (TRANS("How much the image is blurred before tracing, in pixels"));
+        smoothingSlider->setValue (2, dontSendNotification);
+        smoothingSlider->addListener (this);
+        smoothingSlider->setBounds (72, 242, 144, 24);
+
+        smoothingLabel.reset (new juce::Label ("smoothingLabel", TRANS("Smoothing")));
+        addAndMakeVisible (smoothingLabel.get());
+        smoothingLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+        smoothingLabel->setJustificationType (juce::Justification::centredLeft);
+        smoothingLabel->setBounds (8, 242, 64, 24);
+
+        lengthSlider.reset (new juce::Slider ("lengthSlider"));
+        addAndMakeVisible (lengthSlider.get());
+        lengthSlider->setRange (0, 200, 1);
+        lengthSlider->setSliderStyle (juce::Slider::LinearHorizontal);
+        lengthSlider->setTextBoxStyle (juce::Slider::TextBoxRight, false, 40, 20);
+        lengthSlider->setColour (juce::Slider::backgroundColourId, juce::Colour (0xff0d1112));
+        lengthSlider->setTooltip (TRANS("Drop outlines shorter than this, in pixels"));
+        lengthSlider->setValue (20, dontSendNotification);
+        lengthSlider->addListener (this);
+        lengthSlider->setBounds (72, 268, 144, 24);
+
+        lengthLabel.reset (new juce::Label ("lengthLabel", TRANS("Min Length")));
+        addAndMakeVisible (lengthLabel.get());
+        lengthLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+        lengthLabel->setJustificationType (juce::Justification::centredLeft);
+        lengthLabel->setBounds (8, 268, 64, 24);
+
+        goButton.reset (new juce::TextButton ("goButton"));
+        addAndMakeVisible (goButton.get());
+        goButton->setButtonText ("Trace");
+        goButton->setTooltip (TRANS("Add the traced outlines to the sketch"));
+        goButton->addListener (this);
+        goButton->setBounds (72, 300, 80, 32);
+
+        reportLabel.reset (new juce::Label ("reportLabel"));
+        addAndMakeVisible (reportLabel.get());
+        reportLabel->setFont (juce::Font (12.00f, juce::Font::plain));
+        reportLabel->setJustificationType (juce::Justification::centred);
+        reportLabel->setMinimumHorizontalScale (0.5f);
+        reportLabel->setBounds (8, 336, 208, 24);
+
+        setSize (224, 364);
+        retrace();
+    }
+
+    ~TracePopup()
+    {
+        thresholdSlider = nullptr;
+        thresholdLabel = nullptr;
+        smoothingSlider = nullptr;
+        smoothingLabel = nullptr;
+        lengthSlider = nullptr;
+        lengthLabel = nullptr;
+        goButton = nullptr;
+        reportLabel = nullptr;
+    }
+
+    void paint (juce::Graphics& g) override
+    {
+        g.fillAll (Colours::transparentBlack);
+
+        // Preview of the whole sketch area
+        auto r = getPreviewArea();
+        g.setColour (Colours::black);
+        g.fillRect (r);
+
+        auto t = AffineTransform::scale (r.getWidth() / 65536.0f,
+                                         r.getHeight() / 65536.0f)
+                 .followedBy (AffineTransform::translation (r.getX(), r.getY()));
+        for (auto n = 0; n < paths.size(); ++n)
+        {
+            g.setColour (paths.getReference (n).getColor());
+            g.strokePath (paths.getReference (n).getPath(), PathStrokeType (1.0f), t);
+        }
+
+        g.setColour (Colours::grey);
+        g.drawRect (r);
+    }
+
+    void resized() override
+    {
+    }
+
+    void sliderValueChanged (juce::Slider* /*sliderThatWasMoved*/) override
+    {
+        retrace();
+    }
+
+    void buttonClicked (juce::Button* buttonThatWasClicked) override
+    {
+        if (buttonThatWasClicked == goButton.get())
+        {
+            frameEditor->addTracedPaths (paths);
+
+            CallOutBox* box = findParentComponentOfClass<CallOutBox>();
+            box->dismiss();
+        }
+    }
+
+private:
+    Rectangle<float> getPreviewArea() const
+    {
+        return Rectangle<float> (12, 8, 200, 200);
+    }
+
+    void retrace()
+    {
+        frameEditor->traceImage ((float)thresholdSlider->getValue() / 100.0f,
+                                 (float)smoothingSlider->getValue(),
+                                 (float)lengthSlider->getValue(),
+                                 paths);
+
+        if (frameEditor->getImageTracer().hasImage())
+        {
+            int anchors = 0;
+            for (auto n = 0; n < paths.size(); ++n)
+                anchors += paths.getReference (n).getAnchorCount();
+
+            reportLabel->setText (String (paths.size()) + " paths, "
+                                  + String (anchors) + " anchors, "
+                                  + String (frameEditor->getImageTracer().getTraceTime(), 0) + " ms",
+                                  dontSendNotification);
+        }
+        else
+            reportLabel->setText (TRANS("No reference image"), dontSendNotification);
+
+        goButton->setEnabled (paths.size() > 0);
+        repaint();
+    }
+
+    FrameEditor* frameEditor;
+    Array<IPath> paths;
+
+    std::unique_ptr<Slider> thresholdSlider;
+    std::unique_ptr<Label> thresholdLabel;
+    std::unique_ptr<Slider> smoothingSlider;
+    std::unique_ptr<Label> smoothingLabel;
+    std::unique_ptr<Slider> lengthSlider;
+    std::unique_ptr<Label> lengthLabel;
+    std::unique_ptr<TextButton> goButton;
+    std::unique_ptr<Label> reportLabel;
+};
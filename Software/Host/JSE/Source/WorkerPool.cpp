@@ -0,0 +1,95 @@
+/*
+    WorkerPool.cpp
+    Shared worker threads for data-parallel jobs
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "WorkerPool.h"
+
+//==============================================================================
+// Shared between the caller and the pool jobs. Jobs that only get to run
+// after the caller has returned find no chunks left and never touch the
+// (by then dead) job function.
+class ChunkRun
+{
+public:
+    ChunkRun (int c, int size, const std::function<void (int, int)>& j)
+    : job (j), count (c), chunkSize (size)
+    {
+        numChunks = (count + chunkSize - 1) / chunkSize;
+    }
+
+    bool runNext()
+    {
+        int chunk = ++nextChunk - 1;
+        if (chunk >= numChunks)
+            return false;
+
+        int start = chunk * chunkSize;
+        job (start, jmin (start + chunkSize, count));
+
+        if (++doneChunks == numChunks)
+            finished.signal();
+
+        return true;
+    }
+
+    void waitForAll() { finished.wait(); }
+    int getNumChunks() { return numChunks; }
+
+private:
+    const std::function<void (int, int)>& job;
+    int count;
+    int chunkSize;
+    int numChunks;
+    Atomic<int> nextChunk;
+    Atomic<int> doneChunks;
+    WaitableEvent finished;
+};
+
+//==============================================================================
+void WorkerPool::forChunks (int count,
+                            int minChunk,
+                            const std::function<void (int start, int end)>& job)
+{
+    if (count <= 0)
+        return;
+
+    SharedResourcePointer<ThreadPool> pool;
+    // A few chunks per thread so uneven jobs still balance out
+    int slots = (pool->getNumThreads() + 1) * 4;
+    int chunkSize = jmax (jmax (1, minChunk), (count + slots - 1) / slots);
+
+    // Not worth the hand-off
+    if (chunkSize >= count)
+    {
+        job (0, count);
+        return;
+    }
+
+    std::shared_ptr<ChunkRun> run = std::make_shared<ChunkRun> (count, chunkSize, job);
+    for (auto n = 1; n < run->getNumChunks(); ++n)
+        pool->addJob ([run] { while (run->runNext()); });
+
+    while (run->runNext());
+    run->waitForAll();
+}
+
+int WorkerPool::getNumThreads()
+{
+    SharedResourcePointer<ThreadPool> pool;
+    return pool->getNumThreads() + 1;
+}
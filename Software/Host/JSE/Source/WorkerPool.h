@@ -0,0 +1,38 @@
+/*
+    WorkerPool.h
+    Shared worker threads for data-parallel jobs
+
+    Copyright 2020 Scrootch.me!
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// The pool itself is a SharedResourcePointer<ThreadPool>, so whoever wants
+// the threads to stay warm just needs to hold one (FrameEditor does)
+class WorkerPool
+{
+public:
+    // Split [0, count) into chunks of at least minChunk items and run
+    // job (start, end) on each of them. The calling thread works on chunks
+    // too and doesn't return until every chunk is done, so it is safe to
+    // call from inside another pool job.
+    static void forChunks (int count,
+                           int minChunk,
+                           const std::function<void (int start, int end)>& job);
+
+    static int getNumThreads();
+};
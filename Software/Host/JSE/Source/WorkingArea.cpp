@@ -22,9 +22,10 @@
 
 //==============================================================================
 WorkingArea::WorkingArea (FrameEditor* frame)
+: refLayer (this), ildaLayer (this), sketchLayer (this)
 {
     frameEditor = frame;
-    frameEditor->addActionListener (this);
+    frameEditor->addEditorListener (this);
     
     updateCursor();
     
@@ -34,10 +35,15 @@ WorkingArea::WorkingArea (FrameEditor* frame)
     drawSMark = false;
     drawEllipse = false;
     drawSDot = false;
+    ildaSkipSegment = -1;
+    sketchSkipPath = -1;
+    sketchIndexDirty = true;
+    strokeAnchors = 0;
 }
 
 WorkingArea::~WorkingArea()
 {
+    frameEditor->removeEditorListener (this);
 }
 
 void WorkingArea::killMarkers()
@@ -106,6 +112,49 @@ void WorkingArea::mouseDownSketchPen (const MouseEvent& event)
     }
 }
 
+void WorkingArea::mouseDownSketchFreehand (const MouseEvent& event)
+{
+    // Left mouse only for now
+    if (! event.mods.isLeftButtonDown())
+        return;
+    
+    // Fitted to within a couple of pixels at the current zoom
+    stroke.reset (new StrokeFit (2.0f * activeInvScale, 2.0f * activeInvScale));
+    strokeSettled.clear();
+    strokeOpen.clear();
+    strokeAnchors = 0;
+    stroke->addSample (event.position);
+}
+
+void WorkingArea::mouseDragSketchFreehand (const MouseEvent& event)
+{
+    Rectangle<float> dirty = strokeOpen.getBounds();
+    
+    // Only what settled since the last drag gets added on
+    if (stroke->addSample (event.position))
+    {
+        const Array<Anchor>& anchors = stroke->getAnchors();
+        if (! strokeAnchors)
+            strokeSettled.startNewSubPath ((float)anchors[0].getX(), (float)anchors[0].getY());
+        
+        for (auto n = jmax (1, strokeAnchors); n < anchors.size(); ++n)
+        {
+            const Anchor& a = anchors.getReference (n - 1);
+            const Anchor& b = anchors.getReference (n);
+            int x1, y1, x2, y2;
+            a.getExitPosition (x1, y1);
+            b.getEntryPosition (x2, y2);
+            strokeSettled.cubicTo ((float)x1, (float)y1, (float)x2, (float)y2, (float)b.getX(), (float)b.getY());
+        }
+        
+        strokeAnchors = anchors.size();
+    }
+    
+    stroke->getOpenSegment (strokeOpen);
+    dirty = dirty.getUnion (strokeOpen.getBounds());
+    repaint (dirty.expanded (3 * activeInvScale).getSmallestIntegerContainer());
+}
+
 void WorkingArea::mouseDownSketchMove (const MouseEvent& event)
 {
     // Left mouse only for now
@@ -379,6 +428,8 @@ void WorkingArea::mouseDown (const MouseEvent& event)
             mouseDownSketchRect (event);
         else if (frameEditor->getActiveSketchTool() == FrameEditor::sketchCenterEllipseTool)
             mouseDownSketchEllipse (event);
+        else if (frameEditor->getActiveSketchTool() == FrameEditor::sketchFreehandTool)
+            mouseDownSketchFreehand (event);
     }
 }
 
@@ -392,6 +443,23 @@ void WorkingArea::mouseUp (const MouseEvent& event)
 
 void WorkingArea::mouseUpSketch (const MouseEvent& event)
 {
+    if (stroke != nullptr)
+    {
+        // The open segment is all that's left to fit, so no waiting here
+        stroke->finish();
+        Array<Anchor> anchors (stroke->getAnchors());
+        stroke = nullptr;
+        
+        repaint (strokeSettled.getBounds().getUnion (strokeOpen.getBounds())
+                 .expanded (3 * activeInvScale).getSmallestIntegerContainer());
+        strokeSettled.clear();
+        strokeOpen.clear();
+        strokeAnchors = 0;
+        
+        frameEditor->insertFreehandPath (anchors);
+        return;
+    }
+    
     if (drawRect)
     {
         drawRect = false;
@@ -510,23 +578,23 @@ void WorkingArea::mouseMoveSketchMove (const MouseEvent& event)
         mouseMoveSketchSelect (event);
 }
 
-void WorkingArea::findNearestAnchor (const Point<int>& pos, int& x, int& y)
+const SketchIndex& WorkingArea::getSketchIndex()
 {
-    for (auto n = 0; n < frameEditor->getIPathCount(); ++n)
+    // The change message can still be on its way
+    if (sketchIndexDirty || sketchIndex.getPathCount() != frameEditor->getIPathCount())
     {
-        IPath path = frameEditor->getIPath (n);
-        for (auto i = 0; i < path.getAnchorCount(); ++i)
-        {
-            int ax, ay;
-            path.getAnchor (i).getPosition (ax, ay);
-            if (pos.getDistanceFrom (Point<int>(ax, ay)) <= (int)(3 * activeInvScale))
-            {
-                x = ax;
-                y = ay;
-                break;
-            }
-        }
+        sketchIndex.update (frameEditor->getIPaths());
+        sketchIndexDirty = false;
     }
+    
+    return sketchIndex;
+}
+
+void WorkingArea::findNearestAnchor (const Point<int>& pos, int& x, int& y)
+{
+    SketchIndex::Hit hit;
+    if (getSketchIndex().findAnchor (pos.toFloat(), (float)(int)(3 * activeInvScale), hit))
+        frameEditor->getIPath (hit.path).getAnchor (hit.anchor).getPosition (x, y);
 }
 
 void WorkingArea::mouseMoveSketchPen (const MouseEvent& event)
@@ -595,125 +663,67 @@ void WorkingArea::mouseMoveSketchPen (const MouseEvent& event)
 void WorkingArea::mouseMoveSketchSelect (const MouseEvent& event)
 {
     Point<float> pos ((float)event.x, (float)event.y);
+    float radius = 3 * activeInvScale;
+    const SketchIndex& index = getSketchIndex();
+    SketchIndex::Hit hit;
     
     IPathSelection selection = frameEditor->getIPathSelection();
     
     // If we already have a selected anchor, offer opporutnity
     // to select controls
-    if ((!selection.isEmpty()) && (selection.getAnchor() != -1))
+    if ((!selection.isEmpty()) && (selection.getAnchor() != -1) &&
+        index.findHandle (pos, radius, hit, selection.getRange(0).getStart(), selection.getAnchor()))
     {
-        Anchor a = frameEditor->getIPath (selection.getRange(0).getStart()).getAnchor (selection.getAnchor());
+        if (drawSMark)
+            repaint (lastSMarkRect);
         
-        if (a.getEntryXDelta() || a.getEntryYDelta())
-        {
-            int x, y;
-            a.getEntryPosition (x, y);
-            Point<float> nearest ((float)x, (float) y);
-            
-            float distance = pos.getDistanceFrom (nearest);
-            if (abs(distance) <= (3* activeInvScale))
-            {
-                if (drawSMark)
-                    repaint (lastSMarkRect);
-                
-                Rectangle<float> r = frameEditor->getIPath (selection.getRange(0).getStart()).getPath().getBounds();
-                Rectangle<float> u(pos, nearest);
-                r = r.getUnion (u);
-                r.expand (15 * activeInvScale, 15 * activeInvScale);
-                lastSMarkRect = r.getSmallestIntegerContainer();
-                
-                drawSMark = true;
-                sMarkIndex = selection.getRange(0).getStart();
-                sMarkAnchorIndex = selection.getAnchor();
-                sMarkControlIndex = 1;
-                repaint (lastSMarkRect);
-                return;
-            }
-        }
-        if (a.getExitXDelta() || a.getExitYDelta())
-        {
-            int x, y;
-            a.getExitPosition (x, y);
-            Point<float> nearest ((float)x, (float) y);
-            
-            float distance = pos.getDistanceFrom (nearest);
-            if (abs(distance) <= (3* activeInvScale))
-            {
-                if (drawSMark)
-                    repaint (lastSMarkRect);
-                
-                Rectangle<float> r = frameEditor->getIPath (selection.getRange(0).getStart()).getPath().getBounds();
-                Rectangle<float> u(pos, nearest);
-                r = r.getUnion (u);
-                r.expand (15 * activeInvScale, 15 * activeInvScale);
-                lastSMarkRect = r.getSmallestIntegerContainer();
-                
-                drawSMark = true;
-                sMarkIndex = selection.getRange(0).getStart();
-                sMarkAnchorIndex = selection.getAnchor();
-                sMarkControlIndex = 2;
-                repaint (lastSMarkRect);
-                return;
-            }
-        }
+        const IPath path = frameEditor->getIPath (hit.path);
+        int x, y;
+        if (hit.control == 1)
+            path.getAnchor (hit.anchor).getEntryPosition (x, y);
+        else
+            path.getAnchor (hit.anchor).getExitPosition (x, y);
+        
+        Rectangle<float> r = path.getPath().getBounds();
+        Rectangle<float> u(pos, Point<float> ((float)x, (float)y));
+        r = r.getUnion (u);
+        r.expand (15 * activeInvScale, 15 * activeInvScale);
+        lastSMarkRect = r.getSmallestIntegerContainer();
+        
+        drawSMark = true;
+        sMarkIndex = hit.path;
+        sMarkAnchorIndex = hit.anchor;
+        sMarkControlIndex = hit.control;
+        repaint (lastSMarkRect);
+        return;
     }
     
-    int n;
-    for (n = 0; n < frameEditor->getIPathCount(); ++n)
+    if (index.findSegment (pos, radius, hit))
     {
-        IPath path;
-        Point<float> nearest;
+        if (drawSMark)
+            repaint (lastSMarkRect);
         
-        path = frameEditor->getIPath (n);
+        Rectangle<float> r = frameEditor->getIPath (hit.path).getPath().getBounds();
+        r.expand (15 * activeInvScale, 15 * activeInvScale);
+        lastSMarkRect = r.getSmallestIntegerContainer();
         
-        if (path.getAnchorCount() == 1)
-            nearest = Point<float> ((float)path.getAnchor (0).getX(),
-                                    (float)path.getAnchor (0).getY());
-        else
-            path.getPath().getNearestPoint (pos, nearest);
+        sMarkAnchorIndex = -1;
+        sMarkControlIndex = -1;
         
-        float distance = pos.getDistanceFrom (nearest);
-        if (abs(distance) <= (3 * activeInvScale))
-        {
-            if (drawSMark)
-                repaint (lastSMarkRect);
-            
-            Rectangle<float> r = path.getPath().getBounds();
-            r.expand (15 * activeInvScale, 15 * activeInvScale);
-            lastSMarkRect = r.getSmallestIntegerContainer();
-            
-            sMarkAnchorIndex = -1;
-            sMarkControlIndex = -1;
-            
-            // Check if we are highlighing an anchor, but no mods
-            if (! event.mods.isAnyModifierKeyDown())
-            {
-                for (auto i = 0; i < path.getAnchorCount(); ++i)
-                {
-                    Anchor a = path.getAnchor (i);
-                    nearest = Point<float>((float)a.getX(), (float)a.getY());
-                    distance = pos.getDistanceFrom (nearest);
-                    if (abs(distance) <= (3 * activeInvScale))
-                    {
-                        sMarkAnchorIndex = i;
-                        break;
-                    }
-                }
-            }
-            sMarkIndex = n;
-            drawSMark = true;
-            repaint (lastSMarkRect);
-            break;
-        }
+        // Check if we are highlighing an anchor, but no mods
+        SketchIndex::Hit anchorHit;
+        if (! event.mods.isAnyModifierKeyDown() &&
+            index.findAnchor (pos, radius, anchorHit, hit.path))
+            sMarkAnchorIndex = anchorHit.anchor;
+        
+        sMarkIndex = hit.path;
+        drawSMark = true;
+        repaint (lastSMarkRect);
     }
-    
-    if (n == frameEditor->getIPathCount())
+    else if (drawSMark)
     {
-        if (drawSMark)
-        {
-            drawSMark = false;
-            repaint (lastSMarkRect);
-        }
+        drawSMark = false;
+        repaint (lastSMarkRect);
     }
 }
 
@@ -997,7 +1007,9 @@ void WorkingArea::mouseDrag (const MouseEvent& event)
     if (! event.mods.isLeftButtonDown())
         return;
 
-    if (drawRect)
+    if (stroke != nullptr)
+        mouseDragSketchFreehand (event);
+    else if (drawRect)
     {
         int expansion = (int)(activeInvScale * 3);
         repaint (lastDrawRect.expanded (expansion, expansion));
@@ -1092,322 +1104,483 @@ void WorkingArea::mouseDrag (const MouseEvent& event)
     }
 }
 
-void WorkingArea::paint (juce::Graphics& g)
+//==============================================================================
+void WorkingArea::invalidateIlda()
 {
-    // Black background
-    g.fillAll (Colours::transparentBlack);
-    
-    // Background Image
-    if (frameEditor->getRefVisible() && (frameEditor->getActiveView() == Frame::front))
-    {
-        g.setOpacity (frameEditor->getImageOpacity());
-        const Image* i = frameEditor->getImage();
-        if (i != nullptr)
-        {
-            auto w = i->getWidth();
-            auto h = i->getHeight();
-            float scale;
-            float iscale = frameEditor->getImageScale();
-            
-            if (w > h)
-                scale = iscale * 65536.0f / w;
-            else
-                scale = iscale * 65536.0f / h;
-
-            float x = 32768.0f - (w * scale / 2) +
-                (frameEditor->getImageXoffset() / 100.0f * 65536.0f);
-            float y = 32768.0f - (h * scale / 2) +
-                (frameEditor->getImageYoffset() / 100.0f * 65536.0f);
-
-            AffineTransform t = \
-                AffineTransform::rotation (frameEditor->getImageRotation() * MathConstants<float>::pi / 180.0f,
-                    w / 2.0f,
-                    h / 2.0f) \
-                .followedBy (AffineTransform::scale (scale)) \
-                .followedBy (AffineTransform::translation(x, y));
-            
-            g.drawImageTransformed (*i, t);
-        }
-    }
-
-    float dotSize = 3.0f * activeInvScale;
-    float halfDotSize = dotSize / 2.0f;
-    float selectSize = 6.0f * activeInvScale;
-    float halfSelectSize = selectSize / 2.0f;
+    ildaIndex = nullptr;
+    ildaLayer.invalidate();
+}
 
-    // ILDA points
-    if (frameEditor->getIldaVisible())
+RetainedLayer::Painter WorkingArea::makeIldaPainter()
+{
+    FrameEditor::View view = frameEditor->getActiveView();
+    if (ildaIndex == nullptr || ildaIndex->getView() != view)
+        ildaIndex = std::make_shared<const SegmentIndex> (frameEditor->getPoints(), view);
+    
+    Array<Frame::IPoint> points (frameEditor->getPoints());
+    std::shared_ptr<const SegmentIndex> index = ildaIndex;
+    bool drawLines = frameEditor->getIldaDrawLines();
+    bool showBlanked = frameEditor->getIldaShowBlanked();
+    float invScale = activeInvScale;
+    int skip = ildaSkipSegment;
+    
+    return [points, index, view, drawLines, showBlanked, invScale, skip] (Graphics& g)
     {
-        FrameEditor::View view = frameEditor->getActiveView();
+        float dotSize = 3.0f * invScale;
+        float halfDotSize = dotSize / 2.0f;
         
-        for (uint16 n = 0; n < frameEditor->getPointCount(); ++n)
+        // Runs of segments shorter than a pixel get drawn as one
+        float pixel = 1.0f / g.getInternalContext().getPhysicalPixelScaleFactor();
+        
+        Array<Range<int>> runs;
+        index->findRuns (g.getClipBounds().toFloat().expanded (dotSize), runs);
+        
+        // One path per color so each gets a single fill, 0 is blanked
+        std::map<uint32, Path> lines;
+        std::map<uint32, Path> dots;
+        
+        for (auto& run : runs)
         {
-            Frame::IPoint point;
+            bool lineOpen = false;
+            uint32 lineStyle = 0;
+            Point<float> lineFrom;
+            Point<float> lineTo;
             
-            if (frameEditor->getPoint (n, point))
+            bool dotDrawn = false;
+            uint32 dotStyle = 0;
+            Point<float> lastDot;
+            
+            for (auto n = run.getStart(); n < run.getEnd(); ++n)
             {
-                // Draw lines
-                if (frameEditor->getIldaDrawLines())
+                const Frame::IPoint& point = points.getReference (n);
+                bool blanked = point.status & Frame::BlankedPoint;
+                uint32 style = blanked ? 0 : Colour (point.red, point.green, point.blue).getARGB();
+                Point<float> at (Frame::getCompX (point, view), Frame::getCompY (point, view));
+                
+                bool drawLine = drawLines && n != skip && (showBlanked || ! blanked);
+                if (lineOpen && ((! drawLine) || style != lineStyle))
                 {
-                    Frame::IPoint nextPoint;
-                    bool b;
-                    
-                    if (n < (frameEditor->getPointCount() - 1))
-                        b = frameEditor->getPoint (n+1, nextPoint);
-                    else
-                        b = frameEditor->getPoint (0, nextPoint);
-
-                    if (b && ((n != dotFrom) || (! drawDot)))
-                    {
-                        if (point.status & Frame::BlankedPoint)
-                        {
-                            if (frameEditor->getIldaShowBlanked())
-                            {
-                                g.setColour (Colours::darkgrey);
-                                g.drawLine (Frame::getCompX (point, view),
-                                            Frame::getCompY (point, view),
-                                            Frame::getCompX (nextPoint, view),
-                                            Frame::getCompY (nextPoint, view),
-                                            activeInvScale);
-                            }
-                        }
-                        else
-                        {
-                            g.setColour (Colour (point.red, point.green, point.blue));
-                            g.drawLine (Frame::getCompX (point, view),
-                                        Frame::getCompY (point, view),
-                                        Frame::getCompX (nextPoint, view),
-                                        Frame::getCompY (nextPoint, view),
-                                        halfDotSize);
-                        }
-                    }
+                    lines[lineStyle].addLineSegment (Line<float> (lineFrom, lineTo),
+                                                     lineStyle ? halfDotSize : invScale);
+                    lineOpen = false;
                 }
-
-                // Draw the dots
-                if (point.status & Frame::BlankedPoint)
+                
+                if (drawLine)
                 {
-                    if (frameEditor->getIldaShowBlanked())
+                    const Frame::IPoint& nextPoint = points.getReference ((n + 1) % points.size());
+                    if (! lineOpen)
                     {
-                        g.setColour (Colours::darkgrey);
-                        g.drawEllipse(Frame::getCompX (point, view) - halfDotSize,
-                                      Frame::getCompY (point, view) - halfDotSize,
-                                      dotSize, dotSize, activeInvScale);
+                        lineOpen = true;
+                        lineStyle = style;
+                        lineFrom = at;
                     }
-
-                    // Mark selected even if ShowBlanked is off, since can be edited
-                    if (frameEditor->getIldaSelection().contains (n) &&
-                        frameEditor->getActiveLayer() == FrameEditor::ilda &&
-                        (! frameEditor->isTransforming()))
+                    
+                    lineTo.setXY (Frame::getCompX (nextPoint, view), Frame::getCompY (nextPoint, view));
+                    if (lineFrom.getDistanceFrom (lineTo) >= pixel)
                     {
-                        g.setColour (Colours::lightblue);
-                        g.drawEllipse(Frame::getCompX (point, view) - halfSelectSize,
-                                      Frame::getCompY (point, view) - halfSelectSize,
-                                      selectSize, selectSize, activeInvScale);
+                        lines[lineStyle].addLineSegment (Line<float> (lineFrom, lineTo),
+                                                         lineStyle ? halfDotSize : invScale);
+                        lineOpen = false;
                     }
                 }
-                else
+                
+                if ((showBlanked || ! blanked) &&
+                    ! (dotDrawn && style == dotStyle && lastDot.getDistanceFrom (at) < pixel))
                 {
-                    g.setColour (Colour (point.red, point.green, point.blue));
-                    g.fillEllipse(Frame::getCompX (point, view) - halfDotSize,
-                                  Frame::getCompY (point, view) - halfDotSize,
-                                  dotSize, dotSize);
-                    
-                    if (frameEditor->getIldaSelection().contains (n) &&
-                        frameEditor->getActiveLayer() == FrameEditor::ilda &&
-                        (! frameEditor->isTransforming()))
-                    {
-                        g.setColour (Colours::whitesmoke);
-                        g.drawEllipse(Frame::getCompX (point, view) - halfSelectSize,
-                                      Frame::getCompY (point, view) - halfSelectSize,
-                                      selectSize, selectSize, activeInvScale);
-                    }
+                    dots[style].addEllipse (at.x - halfDotSize, at.y - halfDotSize, dotSize, dotSize);
+                    dotDrawn = true;
+                    dotStyle = style;
+                    lastDot = at;
                 }
             }
             
-            if (frameEditor->getActiveLayer() == FrameEditor::ilda && drawMark)
+            if (lineOpen)
+                lines[lineStyle].addLineSegment (Line<float> (lineFrom, lineTo),
+                                                 lineStyle ? halfDotSize : invScale);
+        }
+        
+        g.setColour (Colours::darkgrey);
+        g.fillPath (lines[0]);
+        g.strokePath (dots[0], PathStrokeType (invScale));
+        
+        for (auto& l : lines)
+        {
+            if (l.first)
             {
-                if (n == markIndex)
-                {
-                    g.setColour (Colours::white);
-                    g.drawEllipse (Frame::getCompX (point, view) - selectSize,
-                                   Frame::getCompY (point, view) - selectSize,
-                                   2 * selectSize, 2 * selectSize, 2 * activeInvScale);
-                }
+                g.setColour (Colour (l.first));
+                g.fillPath (l.second);
             }
         }
         
-        if (frameEditor->getActiveLayer() == FrameEditor::ilda && drawDot)
+        for (auto& d : dots)
         {
-            Colour c = frameEditor->getPointToolColor();
+            if (d.first)
+            {
+                g.setColour (Colour (d.first));
+                g.fillPath (d.second);
+            }
+        }
+    };
+}
 
-            // draw lines
-            if (dotFrom != -1)
+RetainedLayer::Painter WorkingArea::makeSketchPainter()
+{
+    Array<IPath> paths (frameEditor->getIPaths());
+    float invScale = activeInvScale;
+    int skip = sketchSkipPath;
+    
+    return [paths, invScale, skip] (Graphics& g)
+    {
+        float dotSize = 3.0f * invScale;
+        float halfDotSize = dotSize / 2.0f;
+        float selectSize = 6.0f * invScale;
+        float dashes[] = { selectSize, selectSize };
+        Rectangle<float> clip = g.getClipBounds().toFloat();
+        
+        std::map<uint32, Path> strokes;
+        std::map<uint32, Path> anchors;
+        
+        for (auto n = 0; n < paths.size(); ++n)
+        {
+            if (n == skip)
+                continue;
+            
+            const IPath& path = paths.getReference (n);
+            if (! path.getPath().getBounds().expanded (selectSize).intersects (clip))
+                continue;
+            
+            Colour c = path.getColor();
+            
+            if (c == Colours::black)
             {
-                Frame::IPoint point;
-                frameEditor->getPoint ((uint16)dotFrom, point);
+                c = Colours::darkgrey;
                 
-                if (point.status & Frame::BlankedPoint)
-                {
-                    g.setColour (Colours::darkgrey);
-                    g.drawLine (Frame::getCompX (point, view),
-                                Frame::getCompY (point, view),
-                                (float)dotAt.getX(),
-                                (float)dotAt.getY(),
-                                activeInvScale);
-                }
-                else
-                {
-                    g.setColour (Colour (point.red, point.green, point.blue));
-                    g.drawLine (Frame::getCompX (point, view),
-                                Frame::getCompY (point, view),
-                                (float)dotAt.getX(),
-                                (float)dotAt.getY(),
-                                activeInvScale);
-                }
+                Path dp;
+                PathStrokeType(1).createDashedStroke(dp, path.getPath(), dashes, numElementsInArray(dashes));
+                strokes[c.getARGB()].addPath (dp);
             }
+            else
+                strokes[c.getARGB()].addPath (path.getPath());
+            
+            Path& a = anchors[c.getARGB()];
+            for (auto i = 0; i < path.getAnchorCount(); ++i)
+                a.addRectangle (path.getAnchor (i).getX() - halfDotSize,
+                                path.getAnchor (i).getY() - halfDotSize,
+                                dotSize, dotSize);
+        }
+        
+        for (auto& s : strokes)
+        {
+            g.setColour (Colour (s.first));
+            g.strokePath (s.second, PathStrokeType (invScale));
+            g.fillPath (anchors[s.first]);
+        }
+    };
+}
+
+RetainedLayer::Painter WorkingArea::makeRefPainter()
+{
+    std::shared_ptr<RefImage> ref = frameEditor->getRefImage();
+    AffineTransform transform = frameEditor->getImageTransform();
+
+    return [ref, transform] (Graphics& g)
+    {
+        if (ref == nullptr)
+            return;
+        
+        // Device pixels per image pixel, zoom and display scale included
+        float pixelScale = std::sqrt (std::abs (transform.getDeterminant())) *
+                           g.getInternalContext().getPhysicalPixelScaleFactor();
+        Image level = ref->getLevel (ref->getLevelFor (pixelScale));
+        const Image* full = ref->getImage();
+        if (! level.isValid() || full == nullptr)
+            return;
+        
+        Graphics::ScopedSaveState state (g);
+        g.setImageResamplingQuality (Graphics::mediumResamplingQuality);
+        g.drawImageTransformed (level,
+                                AffineTransform::scale ((float)full->getWidth() / level.getWidth(),
+                                                        (float)full->getHeight() / level.getHeight())
+                                .followedBy (transform));
+    };
+}
 
-            if (dotTo != -1)
+//==============================================================================
+void WorkingArea::paintIldaOverlay (Graphics& g)
+{
+    FrameEditor::View view = frameEditor->getActiveView();
+    float selectSize = 6.0f * activeInvScale;
+    float halfSelectSize = selectSize / 2.0f;
+    
+    // Mark selected even if ShowBlanked is off, since can be edited
+    if (frameEditor->getActiveLayer() == FrameEditor::ilda &&
+        (! frameEditor->isTransforming()))
+    {
+        const SparseSet<uint16>& selection = frameEditor->getIldaSelection();
+        for (auto r = 0; r < selection.getNumRanges(); ++r)
+        {
+            Range<uint16> range = selection.getRange (r);
+            for (uint16 n = range.getStart(); n < range.getEnd(); ++n)
             {
                 Frame::IPoint point;
-                frameEditor->getPoint ((uint16)dotTo, point);
+                if (! frameEditor->getPoint (n, point))
+                    break;
                 
-                if (c == Colours::black)
-                {
-                    g.setColour (Colours::darkgrey);
-                    g.drawLine ((float)dotAt.getX(),
-                                (float)dotAt.getY(),
-                                Frame::getCompX (point, view),
-                                Frame::getCompY (point, view),
-                                activeInvScale);
-                }
+                if (point.status & Frame::BlankedPoint)
+                    g.setColour (Colours::lightblue);
                 else
-                {
-                    g.setColour (c);
-                    g.drawLine ((float)dotAt.getX(),
-                                (float)dotAt.getY(),
-                                Frame::getCompX (point, view),
-                                Frame::getCompY (point, view),
-                                activeInvScale);
-                }
+                    g.setColour (Colours::whitesmoke);
+                
+                g.drawEllipse(Frame::getCompX (point, view) - halfSelectSize,
+                              Frame::getCompY (point, view) - halfSelectSize,
+                              selectSize, selectSize, activeInvScale);
             }
+        }
+    }
+    
+    if (frameEditor->getActiveLayer() == FrameEditor::ilda && drawMark)
+    {
+        Frame::IPoint point;
+        if (frameEditor->getPoint (markIndex, point))
+        {
+            g.setColour (Colours::white);
+            g.drawEllipse (Frame::getCompX (point, view) - selectSize,
+                           Frame::getCompY (point, view) - selectSize,
+                           2 * selectSize, 2 * selectSize, 2 * activeInvScale);
+        }
+    }
+    
+    if (frameEditor->getActiveLayer() == FrameEditor::ilda && drawDot)
+    {
+        Colour c = frameEditor->getPointToolColor();
 
-            // Draw Dot
-            if (c == Colours::black)
+        // draw lines
+        if (dotFrom != -1)
+        {
+            Frame::IPoint point;
+            frameEditor->getPoint ((uint16)dotFrom, point);
+            
+            if (point.status & Frame::BlankedPoint)
             {
                 g.setColour (Colours::darkgrey);
-                g.drawEllipse((float)dotAt.getX() - halfSelectSize,
-                              (float)dotAt.getY() - halfSelectSize,
-                              selectSize, selectSize, 2 * activeInvScale);
+                g.drawLine (Frame::getCompX (point, view),
+                            Frame::getCompY (point, view),
+                            (float)dotAt.getX(),
+                            (float)dotAt.getY(),
+                            activeInvScale);
             }
             else
             {
-                g.setColour (frameEditor->getPointToolColor());
-                g.fillEllipse((float)dotAt.getX() - halfSelectSize,
-                              (float)dotAt.getY() - halfSelectSize,
-                              selectSize, selectSize);
+                g.setColour (Colour (point.red, point.green, point.blue));
+                g.drawLine (Frame::getCompX (point, view),
+                            Frame::getCompY (point, view),
+                            (float)dotAt.getX(),
+                            (float)dotAt.getY(),
+                            activeInvScale);
             }
         }
-    }
-    
-    // Sketch Layer
-    if (frameEditor->getSketchVisible())
-    {
-        for (auto n = 0; n < frameEditor->getIPathCount(); ++n)
-        {
-            IPath path;
-            
-            if (drawSDot && (sDotIndex == n))
-                path = sDotPath;
-            else
-                path = frameEditor->getIPath (n);
-            
-            bool selected = frameEditor->getIPathSelection().contains ((uint16)n) &&
-                            frameEditor->getActiveLayer() == FrameEditor::sketch;
-            int markedAnchor = -1;
-            int control = frameEditor->getIPathSelection().getControl();
 
-            if (selected)
-                markedAnchor = frameEditor->getIPathSelection().getAnchor();
-
-            bool doubleline = (selected || (drawSMark && (sMarkIndex == n)));
-            
-            Colour c = path.getColor();
-            Path p = path.getPath();
+        if (dotTo != -1)
+        {
+            Frame::IPoint point;
+            frameEditor->getPoint ((uint16)dotTo, point);
             
             if (c == Colours::black)
             {
-                float dashes[] = { selectSize, selectSize };
-                c = Colours::darkgrey;
-                
-                Path dp;
-                PathStrokeType(1).createDashedStroke(dp, p, dashes, numElementsInArray(dashes));
-                p = dp;
+                g.setColour (Colours::darkgrey);
+                g.drawLine ((float)dotAt.getX(),
+                            (float)dotAt.getY(),
+                            Frame::getCompX (point, view),
+                            Frame::getCompY (point, view),
+                            activeInvScale);
             }
-            
-            g.setColour (c);
-            g.strokePath (p, PathStrokeType (doubleline ? 2 * activeInvScale : activeInvScale));
-            
-            for (auto i = 0; i < path.getAnchorCount(); ++i)
+            else
             {
-                Anchor a = path.getAnchor (i);
-                
-                if (drawSMark)
-                {
-                    if (n == sMarkIndex && i == sMarkAnchorIndex)
-                    {
-                        g.drawRect (a.getX() - selectSize, a.getY() - selectSize,
-                                    2 * selectSize, 2 * selectSize, 2 * activeInvScale);
-                     
-                        if (sMarkControlIndex == 1)
-                        {
-                            int x, y;
-                            a.getEntryPosition (x, y);
-                            g.drawEllipse (x - halfSelectSize, y - halfSelectSize, selectSize, selectSize, activeInvScale);
-                        }
-                        else if (sMarkControlIndex == 2)
-                        {
-                            int x, y;
-                            a.getExitPosition (x, y);
-                            g.drawEllipse (x - halfSelectSize, y - halfSelectSize, selectSize, selectSize, activeInvScale);
-                        }
-                    }
-                }
-                
-                if ((i == markedAnchor) || (selected && (markedAnchor == -1)))
+                g.setColour (c);
+                g.drawLine ((float)dotAt.getX(),
+                            (float)dotAt.getY(),
+                            Frame::getCompX (point, view),
+                            Frame::getCompY (point, view),
+                            activeInvScale);
+            }
+        }
+
+        // Draw Dot
+        if (c == Colours::black)
+        {
+            g.setColour (Colours::darkgrey);
+            g.drawEllipse((float)dotAt.getX() - halfSelectSize,
+                          (float)dotAt.getY() - halfSelectSize,
+                          selectSize, selectSize, 2 * activeInvScale);
+        }
+        else
+        {
+            g.setColour (frameEditor->getPointToolColor());
+            g.fillEllipse((float)dotAt.getX() - halfSelectSize,
+                          (float)dotAt.getY() - halfSelectSize,
+                          selectSize, selectSize);
+        }
+    }
+}
+
+void WorkingArea::paintIPath (Graphics& g, int n, const IPath& path)
+{
+    float dotSize = 3.0f * activeInvScale;
+    float halfDotSize = dotSize / 2.0f;
+    float selectSize = 6.0f * activeInvScale;
+    float halfSelectSize = selectSize / 2.0f;
+    
+    bool selected = frameEditor->getIPathSelection().contains ((uint16)n) &&
+                    frameEditor->getActiveLayer() == FrameEditor::sketch;
+    int markedAnchor = -1;
+    int control = frameEditor->getIPathSelection().getControl();
+
+    if (selected)
+        markedAnchor = frameEditor->getIPathSelection().getAnchor();
+
+    bool doubleline = (selected || (drawSMark && (sMarkIndex == n)));
+    
+    Colour c = path.getColor();
+    Path p = path.getPath();
+    
+    if (c == Colours::black)
+    {
+        float dashes[] = { selectSize, selectSize };
+        c = Colours::darkgrey;
+        
+        Path dp;
+        PathStrokeType(1).createDashedStroke(dp, p, dashes, numElementsInArray(dashes));
+        p = dp;
+    }
+    
+    g.setColour (c);
+    g.strokePath (p, PathStrokeType (doubleline ? 2 * activeInvScale : activeInvScale));
+    
+    for (auto i = 0; i < path.getAnchorCount(); ++i)
+    {
+        Anchor a = path.getAnchor (i);
+        
+        if (drawSMark)
+        {
+            if (n == sMarkIndex && i == sMarkAnchorIndex)
+            {
+                g.drawRect (a.getX() - selectSize, a.getY() - selectSize,
+                            2 * selectSize, 2 * selectSize, 2 * activeInvScale);
+             
+                if (sMarkControlIndex == 1)
                 {
-                    g.drawRect (a.getX() - halfSelectSize, a.getY() - halfSelectSize,
-                                selectSize, selectSize, activeInvScale);
+                    int x, y;
+                    a.getEntryPosition (x, y);
+                    g.drawEllipse (x - halfSelectSize, y - halfSelectSize, selectSize, selectSize, activeInvScale);
                 }
-                
-                if (i == markedAnchor)
+                else if (sMarkControlIndex == 2)
                 {
-                    g.setColour (Colours::grey);
-                    if (a.getExitXDelta() != 0 || a.getExitYDelta() != 0)
-                    {
-                        int x, y;
-                        a.getExitPosition (x, y);
-                        g.drawLine((float)x, (float)y, (float)a.getX(), (float)a.getY(), activeInvScale);
-                        g.fillEllipse ((float)x - halfDotSize, (float)y - halfDotSize, dotSize, dotSize);
-                        if (control == 2)
-                            g.drawEllipse ((float)x - halfSelectSize, (float)y - halfSelectSize, selectSize, selectSize, activeInvScale);
-                    }
-                    if (a.getEntryXDelta() != 0 || a.getEntryYDelta() != 0)
-                    {
-                        int x, y;
-                        a.getEntryPosition (x, y);
-                        g.drawLine((float)x, (float)y, (float)a.getX(), (float)a.getY(), activeInvScale);
-                        g.fillEllipse ((float)x - halfDotSize, (float)y - halfDotSize, dotSize, dotSize);
-                        if (control == 1)
-                            g.drawEllipse ((float)x - halfSelectSize, (float)y - halfSelectSize, selectSize, selectSize, activeInvScale);
-                    }
-                    g.setColour (c);
+                    int x, y;
+                    a.getExitPosition (x, y);
+                    g.drawEllipse (x - halfSelectSize, y - halfSelectSize, selectSize, selectSize, activeInvScale);
                 }
-                
-                g.fillRect (a.getX() - halfDotSize, a.getY() - halfDotSize,
-                            dotSize, dotSize);
             }
         }
         
+        if ((i == markedAnchor) || (selected && (markedAnchor == -1)))
+        {
+            g.drawRect (a.getX() - halfSelectSize, a.getY() - halfSelectSize,
+                        selectSize, selectSize, activeInvScale);
+        }
+        
+        if (i == markedAnchor)
+        {
+            g.setColour (Colours::grey);
+            if (a.getExitXDelta() != 0 || a.getExitYDelta() != 0)
+            {
+                int x, y;
+                a.getExitPosition (x, y);
+                g.drawLine((float)x, (float)y, (float)a.getX(), (float)a.getY(), activeInvScale);
+                g.fillEllipse ((float)x - halfDotSize, (float)y - halfDotSize, dotSize, dotSize);
+                if (control == 2)
+                    g.drawEllipse ((float)x - halfSelectSize, (float)y - halfSelectSize, selectSize, selectSize, activeInvScale);
+            }
+            if (a.getEntryXDelta() != 0 || a.getEntryYDelta() != 0)
+            {
+                int x, y;
+                a.getEntryPosition (x, y);
+                g.drawLine((float)x, (float)y, (float)a.getX(), (float)a.getY(), activeInvScale);
+                g.fillEllipse ((float)x - halfDotSize, (float)y - halfDotSize, dotSize, dotSize);
+                if (control == 1)
+                    g.drawEllipse ((float)x - halfSelectSize, (float)y - halfSelectSize, selectSize, selectSize, activeInvScale);
+            }
+            g.setColour (c);
+        }
+        
+        g.fillRect (a.getX() - halfDotSize, a.getY() - halfDotSize,
+                    dotSize, dotSize);
+    }
+}
+
+//==============================================================================
+void WorkingArea::paint (juce::Graphics& g)
+{
+    // Black background
+    g.fillAll (Colours::transparentBlack);
+    
+    // Background Image
+    if (frameEditor->getRefVisible() && (frameEditor->getActiveView() == Frame::front))
+    {
+        if (frameEditor->getImage() != nullptr)
+        {
+            // Opacity is left to the blit so the slider doesn't redraw it
+            refLayer.paint (g, [this] { return makeRefPainter(); },
+                            frameEditor->getImageOpacity());
+        }
+        else
+            refLayer.clear();
+    }
+    else
+        refLayer.clear();
+
+    float dotSize = 3.0f * activeInvScale;
+    float halfDotSize = dotSize / 2.0f;
+
+    // ILDA points, the line the point tool is splitting is left out
+    if (frameEditor->getIldaVisible())
+    {
+        int skip = drawDot ? dotFrom : -1;
+        if (skip != ildaSkipSegment)
+        {
+            ildaSkipSegment = skip;
+            ildaLayer.invalidate();
+        }
+        
+        ildaLayer.paint (g, [this] { return makeIldaPainter(); });
+        paintIldaOverlay (g);
+    }
+    else
+        ildaLayer.clear();
+    
+    // Sketch Layer, paths with markers on them go on top
+    if (frameEditor->getSketchVisible())
+    {
+        int skip = drawSDot ? sDotIndex : -1;
+        if (skip != sketchSkipPath)
+        {
+            sketchSkipPath = skip;
+            sketchLayer.invalidate();
+        }
+        
+        sketchLayer.paint (g, [this] { return makeSketchPainter(); });
+        
+        const IPathSelection& selection = frameEditor->getIPathSelection();
+        bool sketchActive = frameEditor->getActiveLayer() == FrameEditor::sketch;
+        
+        for (auto n = 0; n < frameEditor->getIPathCount(); ++n)
+        {
+            if (drawSDot && (sDotIndex == n))
+                paintIPath (g, n, sDotPath);
+            else if ((sketchActive && selection.contains ((uint16)n)) ||
+                     (drawSMark && (sMarkIndex == n)))
+                paintIPath (g, n, frameEditor->getIPaths().getReference (n));
+        }
+        
         if (drawSDot && (sDotIndex == -1))
         {
             g.setColour (frameEditor->getSketchToolColor());
@@ -1415,7 +1588,18 @@ void WorkingArea::paint (juce::Graphics& g)
                         dotSize, dotSize);
         }
     }
+    else
+        sketchLayer.clear();
 
+    // Freehand stroke, drawn the way paintIPath would
+    if (stroke != nullptr)
+    {
+        Colour c = frameEditor->getSketchToolColor();
+        g.setColour (c == Colours::black ? Colours::darkgrey : c);
+        g.strokePath (strokeSettled, PathStrokeType (activeInvScale));
+        g.strokePath (strokeOpen, PathStrokeType (activeInvScale));
+    }
+    
     // Rectangle
     if (drawRect)
     {
@@ -1467,6 +1651,7 @@ void WorkingArea::updateCursor()
                 break;
                 
             case FrameEditor::sketchPenTool:
+            case FrameEditor::sketchFreehandTool:
             case FrameEditor::sketchEllipseTool:
             case FrameEditor::sketchLineTool:
             case FrameEditor::sketchRectTool:
@@ -1488,76 +1673,74 @@ void WorkingArea::updateCursor()
         setMouseCursor (MouseCursor::NormalCursor);
 }
 
-void WorkingArea::actionListenerCallback (const String& message)
+void WorkingArea::editorChanged (const EditorChanges& changes)
 {
-    if (message == EditorActions::backgroundImageChanged)
-        repaint();
-    else if (message == EditorActions::sketchVisibilityChanged)
-        repaint();
-    else if (message == EditorActions::ildaVisibilityChanged)
-        repaint();
-    else if (message == EditorActions::refVisibilityChanged)
-        repaint();
-    else if (message == EditorActions::refOpacityChanged)
-        repaint();
-    else if (message == EditorActions::backgroundImageAdjusted)
-        repaint();
-    else if (message == EditorActions::frameIndexChanged)
-        repaint();
-    else if (message == EditorActions::ildaShowBlankChanged)
-        repaint();
-    else if (message == EditorActions::ildaDrawLinesChanged)
-        repaint();
-    else if (message == EditorActions::refDrawGridChanged)
-        repaint();
-    else if (message == EditorActions::layerChanged)
-    {
-        killMarkers();
-        updateCursor();
-        repaint();
-    }
-    else if (message == EditorActions::viewChanged)
-    {
-        killMarkers();
-        repaint();
-    }
-    else if (message == EditorActions::ildaSelectionChanged)
-    {
-        killMarkers();
-        repaint();
-    }
-    else if (message == EditorActions::iPathSelectionChanged)
-    {
-        killMarkers();
-        repaint();
-    }
-    else if (message == EditorActions::ildaPointsChanged)
-        repaint();
-    else if (message == EditorActions::ildaPointToolColorChanged)
-        repaint();
-    else if (message == EditorActions::sketchToolColorChanged)
-        repaint();
-    else if (message == EditorActions::ildaToolChanged)
+    // A drag can post a pile of these between two paints, work out what
+    // they add up to and do each bit once
+    if (changes.has (EditorActions::frameIndexChanged |
+                     EditorActions::framesChanged |
+                     EditorActions::viewChanged |
+                     EditorActions::ildaPointsChanged |
+                     EditorActions::ildaShowBlankChanged |
+                     EditorActions::ildaDrawLinesChanged |
+                     EditorActions::transformEnded))
+        invalidateIlda();
+    
+    if (changes.has (EditorActions::frameIndexChanged |
+                     EditorActions::framesChanged |
+                     EditorActions::iPathsChanged |
+                     EditorActions::transformEnded))
     {
-        killMarkers();
-        updateCursor();
+        sketchLayer.invalidate();
+        sketchIndexDirty = true;
     }
-    else if (message == EditorActions::sketchToolChanged)
-    {
+    
+    if (changes.has (EditorActions::frameIndexChanged |
+                     EditorActions::framesChanged |
+                     EditorActions::backgroundImageChanged |
+                     EditorActions::backgroundImageAdjusted))
+        refLayer.invalidate();
+    
+    if (changes.has (EditorActions::framesChanged |
+                     EditorActions::iPathsChanged |
+                     EditorActions::layerChanged |
+                     EditorActions::viewChanged |
+                     EditorActions::ildaSelectionChanged |
+                     EditorActions::iPathSelectionChanged |
+                     EditorActions::ildaToolChanged |
+                     EditorActions::sketchToolChanged))
         killMarkers();
+    
+    if (changes.has (EditorActions::layerChanged |
+                     EditorActions::ildaToolChanged |
+                     EditorActions::sketchToolChanged))
         updateCursor();
-    }
-    else if (message == EditorActions::framesChanged)
-    {
-        killMarkers();
-        repaint();
-    }
-    else if (message == EditorActions::iPathsChanged)
-    {
-        killMarkers();
+    
+    // Only the tools changing leaves the picture alone
+    if (changes.has (EditorActions::backgroundImageChanged |
+                     EditorActions::backgroundImageAdjusted |
+                     EditorActions::refVisibilityChanged |
+                     EditorActions::refOpacityChanged |
+                     EditorActions::refDrawGridChanged |
+                     EditorActions::sketchVisibilityChanged |
+                     EditorActions::ildaVisibilityChanged |
+                     EditorActions::frameIndexChanged |
+                     EditorActions::framesChanged |
+                     EditorActions::layerChanged |
+                     EditorActions::viewChanged |
+                     EditorActions::ildaShowBlankChanged |
+                     EditorActions::ildaDrawLinesChanged |
+                     EditorActions::ildaSelectionChanged |
+                     EditorActions::iPathSelectionChanged |
+                     EditorActions::ildaPointsChanged |
+                     EditorActions::iPathsChanged |
+                     EditorActions::ildaPointToolColorChanged |
+                     EditorActions::sketchToolColorChanged |
+                     EditorActions::transformStarted |
+                     EditorActions::transformEnded))
         repaint();
-    }
-    else if (message == EditorActions::deleteRequest)
+    
+    if (changes.has (EditorActions::deleteRequest))
     {
         if (drawDot)
         {
@@ -1573,8 +1756,4 @@ void WorkingArea::actionListenerCallback (const String& message)
             frameEditor->setIldaSelection (selection);
         }
     }
-    else if (message == EditorActions::transformStarted)
-        repaint();
-    else if (message == EditorActions::transformEnded)
-        repaint();
 }
@@ -20,6 +20,10 @@
 #pragma once
 
 #include "FrameEditor.h"
+#include "CurveFit.h"
+#include "RetainedLayer.h"
+#include "SegmentIndex.h"
+#include "SketchIndex.h"
 #include <JuceHeader.h>
 
 //==============================================================================
@@ -27,7 +31,7 @@
 */
 //==============================================================================
 class WorkingArea : public Component,
-                    public ActionListener
+                    public EditorBus::Listener
 {
 public:
     WorkingArea (FrameEditor* frame);
@@ -43,7 +47,7 @@ public:
     void resized() override;
 
     //==============================================================================
-    void actionListenerCallback (const String& message) override;
+    void editorChanged (const EditorChanges& changes) override;
 
     //==============================================================================
     float getActiveScale() { return activeScale; }
@@ -65,6 +69,7 @@ private:
     void findAllSameVisibility (uint16 index, SparseSet<uint16>& set);
     void rightClickIldaSelect (const MouseEvent& event);
     void findNearestAnchor (const Point<int>& pos, int& x, int& y);
+    const SketchIndex& getSketchIndex();
     void mouseDownIldaSelect (const MouseEvent& event);
     void mouseDownIldaMove (const MouseEvent& event);
     void mouseDownIldaPoint (const MouseEvent& event);
@@ -73,6 +78,8 @@ private:
     void mouseDownSketchEllipse (const MouseEvent& event);
     void mouseDownSketchRect (const MouseEvent& event);
     void mouseDownSketchPen (const MouseEvent& event);
+    void mouseDownSketchFreehand (const MouseEvent& event);
+    void mouseDragSketchFreehand (const MouseEvent& event);
     void mouseUpIlda (const MouseEvent& event);
     void mouseUpSketch (const MouseEvent& event);
     void mouseMoveIldaSelect (const MouseEvent& event);
@@ -81,6 +88,13 @@ private:
     void mouseMoveSketchSelect (const MouseEvent& event);
     void mouseMoveSketchMove (const MouseEvent& event);
     void mouseMoveSketchPen (const MouseEvent& event);
+    
+    void invalidateIlda();
+    RetainedLayer::Painter makeIldaPainter();
+    RetainedLayer::Painter makeSketchPainter();
+    RetainedLayer::Painter makeRefPainter();
+    void paintIldaOverlay (Graphics& g);
+    void paintIPath (Graphics& g, int n, const IPath& path);
 
     FrameEditor* frameEditor;
     float activeScale;
@@ -119,6 +133,28 @@ private:
     int sDotFrom;
     IPath sDotPath;
     Rectangle<int> lastSDotRect;
+    
+    // Freehand stroke being drawn, the anchors it has settled so far are
+    // in strokeSettled and the rest is strokeOpen
+    std::unique_ptr<StrokeFit> stroke;
+    Path strokeSettled;
+    Path strokeOpen;
+    int strokeAnchors;
+    
+    // Points and paths only get drawn again when they change, markers and
+    // selection are painted over them. The reference image only when it's
+    // moved or the zoom changes.
+    RetainedLayer refLayer;
+    RetainedLayer ildaLayer;
+    RetainedLayer sketchLayer;
+    std::shared_ptr<const SegmentIndex> ildaIndex;
+    int ildaSkipSegment;
+    int sketchSkipPath;
+    
+    // Hover and snap queries, brought up to date on the first one after
+    // the paths change
+    SketchIndex sketchIndex;
+    bool sketchIndexDirty;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WorkingArea)
 };